@@ -384,6 +384,9 @@ void OBSApp::InitUserConfigDefaults()
 
 	config_set_default_bool(userConfig, "BasicWindow", "MultiviewDrawAreas", true);
 
+	config_set_default_int(userConfig, "BasicWindow", "MultiviewSceneRateDivisor", 1);
+	config_set_default_int(userConfig, "BasicWindow", "DisplayMaxFPS", 0);
+
 	config_set_default_bool(userConfig, "BasicWindow", "MediaControlsCountdownTimer", true);
 
 	config_set_default_bool(App()->GetUserConfig(), "BasicWindow", "MixerShowInactive", false);
@@ -20,6 +20,9 @@ Multiview::~Multiview()
 	}
 
 	obs_enter_graphics();
+	for (gs_texrender_t *thumbnail : thumbnails) {
+		gs_texrender_destroy(thumbnail);
+	}
 	gs_vertexbuffer_destroy(actionSafeMargin);
 	gs_vertexbuffer_destroy(graphicsSafeMargin);
 	gs_vertexbuffer_destroy(fourByThreeSafeMargin);
@@ -65,11 +68,12 @@ static OBSSource CreateLabel(const char *name, size_t h)
 	return txtSource.Get();
 }
 
-void Multiview::Update(MultiviewLayout multiviewLayout, bool drawLabel, bool drawSafeArea)
+void Multiview::Update(MultiviewLayout multiviewLayout, bool drawLabel, bool drawSafeArea, int sceneRateDivisor)
 {
 	this->multiviewLayout = multiviewLayout;
 	this->drawLabel = drawLabel;
 	this->drawSafeArea = drawSafeArea;
+	this->sceneRateDivisor = sceneRateDivisor > 1 ? sceneRateDivisor : 1;
 
 	struct obs_video_info ovi;
 	obs_get_video_info(&ovi);
@@ -215,6 +219,76 @@ static inline uint32_t labelOffset(MultiviewLayout multiviewLayout, obs_source_t
 	return (cx / 2) - w;
 }
 
+bool Multiview::UpdateThumbnail(size_t i, obs_source_t *source, uint32_t cx, uint32_t cy)
+{
+	if (thumbnails.size() <= i) {
+		thumbnails.resize(i + 1, nullptr);
+		thumbnailSources.resize(i + 1);
+	}
+
+	gs_texrender_t *&thumbnail = thumbnails[i];
+	const enum gs_color_space space = gs_get_color_space();
+	const enum gs_color_format format = gs_get_format_from_space(space);
+
+	if (thumbnail && gs_texrender_get_format(thumbnail) != format) {
+		gs_texrender_destroy(thumbnail);
+		thumbnail = nullptr;
+	}
+
+	// A destroyed scene's address can be reused by a new one, so the weak
+	// reference has to be alive as well as point at the same source.
+	obs_weak_source_t *lastSource = thumbnailSources[i];
+	bool sameSource = lastSource && !obs_weak_source_expired(lastSource) &&
+			  obs_weak_source_references_source(lastSource, source);
+
+	if (thumbnail && sameSource) {
+		gs_texture_t *tex = gs_texrender_get_texture(thumbnail);
+		bool sameSize = tex && gs_texture_get_width(tex) == cx && gs_texture_get_height(tex) == cy;
+
+		if (sameSize && (frameCount + i) % sceneRateDivisor != 0) {
+			return true;
+		}
+	}
+
+	if (!thumbnail) {
+		thumbnail = gs_texrender_create(format, GS_ZS_NONE);
+	}
+
+	gs_texrender_reset(thumbnail);
+	if (!gs_texrender_begin_with_color_space(thumbnail, cx, cy, space)) {
+		thumbnailSources[i] = nullptr;
+		return false;
+	}
+
+	struct vec4 clearColor;
+	vec4_from_rgba(&clearColor, backgroundColor);
+	gs_clear(GS_CLEAR_COLOR, &clearColor, 0.0f, 0);
+	gs_ortho(0.0f, fw, 0.0f, fh, -100.0f, 100.0f);
+
+	obs_source_video_render(source);
+
+	gs_texrender_end(thumbnail);
+
+	thumbnailSources[i] = OBSGetWeakRef(source);
+	return true;
+}
+
+void Multiview::DrawThumbnail(size_t i)
+{
+	gs_texture_t *tex = gs_texrender_get_texture(thumbnails[i]);
+	gs_effect_t *effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+
+	// Rendered onto the opaque background already
+	gs_blend_state_push();
+	gs_enable_blending(false);
+
+	while (gs_effect_loop(effect, "Draw")) {
+		obs_source_draw(tex, 0, 0, (uint32_t)siCX, (uint32_t)siCY, false);
+	}
+
+	gs_blend_state_pop();
+}
+
 void Multiview::Render(uint32_t cx, uint32_t cy)
 {
 	OBSBasic *main = (OBSBasic *)obs_frontend_get_main_window();
@@ -228,6 +302,8 @@ void Multiview::Render(uint32_t cx, uint32_t cy)
 
 	GetScaleAndCenterPos(targetCX, targetCY, cx, cy, x, y, scale);
 
+	frameCount++;
+
 	OBSSource previewSrc = main->GetCurrentSceneSource();
 	OBSSource programSrc = main->GetProgramSource();
 	bool studioMode = main->IsPreviewProgramMode();
@@ -423,13 +499,20 @@ void Multiview::Render(uint32_t cx, uint32_t cy)
 		/* ----------- */
 
 		// Render the source
-		gs_matrix_push();
-		gs_matrix_translate3f(siX, siY, 0.0f);
-		gs_matrix_scale3f(siScaleX, siScaleY, 1.0f);
-		setRegion(siX, siY, siCX, siCY);
-		obs_source_video_render(src);
-		endRegion();
-		gs_matrix_pop();
+		if (src && sceneRateDivisor > 1 && UpdateThumbnail(i, src, uint32_t(siCX * scale), uint32_t(siCY * scale))) {
+			gs_matrix_push();
+			gs_matrix_translate3f(siX, siY, 0.0f);
+			DrawThumbnail(i);
+			gs_matrix_pop();
+		} else {
+			gs_matrix_push();
+			gs_matrix_translate3f(siX, siY, 0.0f);
+			gs_matrix_scale3f(siScaleX, siScaleY, 1.0f);
+			setRegion(siX, siY, siCX, siCY);
+			obs_source_video_render(src);
+			endRegion();
+			gs_matrix_pop();
+		}
 
 		/* ----------- */
 
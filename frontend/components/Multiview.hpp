@@ -21,7 +21,7 @@ class Multiview {
 public:
 	Multiview();
 	~Multiview();
-	void Update(MultiviewLayout multiviewLayout, bool drawLabel, bool drawSafeArea);
+	void Update(MultiviewLayout multiviewLayout, bool drawLabel, bool drawSafeArea, int sceneRateDivisor);
 	void Render(uint32_t cx, uint32_t cy);
 	OBSSource GetSourceByPosition(int x, int y);
 
@@ -39,6 +39,17 @@ private:
 	std::vector<OBSWeakSource> multiviewScenes;
 	std::vector<OBSSource> multiviewLabels;
 
+	// Scene thumbnails, graphics thread only. With a rate divisor above 1,
+	// each one is re-rendered every sceneRateDivisor frames (staggered
+	// across scenes) and drawn from the cached texture in between.
+	int sceneRateDivisor = 1;
+	uint64_t frameCount = 0;
+	std::vector<gs_texrender_t *> thumbnails;
+	std::vector<OBSWeakSource> thumbnailSources;
+
+	bool UpdateThumbnail(size_t i, obs_source_t *source, uint32_t cx, uint32_t cy);
+	void DrawThumbnail(size_t i);
+
 	// Multiview position helpers
 	float thickness = 6;
 	float offset, thicknessx2 = thickness * 2, pvwprgCX, pvwprgCY, sourceX, sourceY, labelX, labelY, scenesCX,
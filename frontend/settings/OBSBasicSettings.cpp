@@ -373,6 +373,7 @@ OBSBasicSettings::OBSBasicSettings(QWidget *parent)
 	HookWidget(ui->systemTrayAlways,     CHECK_CHANGED,  GENERAL_CHANGED);
 	HookWidget(ui->saveProjectors,       CHECK_CHANGED,  GENERAL_CHANGED);
 	HookWidget(ui->closeProjectors,      CHECK_CHANGED,  GENERAL_CHANGED);
+	HookWidget(ui->displayMaxFPS,        COMBO_CHANGED,  GENERAL_CHANGED);
 	HookWidget(ui->snappingEnabled,      CHECK_CHANGED,  GENERAL_CHANGED);
 	HookWidget(ui->screenSnapping,       CHECK_CHANGED,  GENERAL_CHANGED);
 	HookWidget(ui->centerSnapping,       CHECK_CHANGED,  GENERAL_CHANGED);
@@ -391,6 +392,7 @@ OBSBasicSettings::OBSBasicSettings(QWidget *parent)
 	HookWidget(ui->multiviewDrawNames,   CHECK_CHANGED,  GENERAL_CHANGED);
 	HookWidget(ui->multiviewDrawAreas,   CHECK_CHANGED,  GENERAL_CHANGED);
 	HookWidget(ui->multiviewLayout,      COMBO_CHANGED,  GENERAL_CHANGED);
+	HookWidget(ui->multiviewSceneRate,   COMBO_CHANGED,  GENERAL_CHANGED);
 	HookWidget(ui->theme, 		     COMBO_CHANGED,  APPEAR_CHANGED);
 	HookWidget(ui->themeVariant,	     COMBO_CHANGED,  APPEAR_CHANGED);
 	HookWidget(ui->appearanceFontScale,  SLIDER_CHANGED, APPEAR_CHANGED);
@@ -1371,6 +1373,16 @@ void OBSBasicSettings::LoadGeneralSettings()
 	bool projectorAlwaysOnTop = config_get_bool(App()->GetUserConfig(), "BasicWindow", "ProjectorAlwaysOnTop");
 	ui->projectorAlwaysOnTop->setChecked(projectorAlwaysOnTop);
 
+	ui->displayMaxFPS->clear();
+	ui->displayMaxFPS->addItem(QTStr("Basic.Settings.General.DisplayMaxFPS.Unlimited"), 0);
+	ui->displayMaxFPS->addItem("60", 60);
+	ui->displayMaxFPS->addItem("30", 30);
+	ui->displayMaxFPS->addItem("15", 15);
+
+	int displayMaxFPS = (int)config_get_int(App()->GetUserConfig(), "BasicWindow", "DisplayMaxFPS");
+	int displayMaxFPSIdx = ui->displayMaxFPS->findData(displayMaxFPS);
+	ui->displayMaxFPS->setCurrentIndex(displayMaxFPSIdx == -1 ? 0 : displayMaxFPSIdx);
+
 	bool overflowHide = config_get_bool(App()->GetUserConfig(), "BasicWindow", "OverflowHidden");
 	ui->overflowHide->setChecked(overflowHide);
 
@@ -1428,6 +1440,14 @@ void OBSBasicSettings::LoadGeneralSettings()
 	ui->multiviewLayout->setCurrentIndex(ui->multiviewLayout->findData(
 		QVariant::fromValue(config_get_int(App()->GetUserConfig(), "BasicWindow", "MultiviewLayout"))));
 
+	ui->multiviewSceneRate->addItem(QTStr("Basic.Settings.General.MultiviewSceneRate.Full"), 1);
+	ui->multiviewSceneRate->addItem(QTStr("Basic.Settings.General.MultiviewSceneRate.Half"), 2);
+	ui->multiviewSceneRate->addItem(QTStr("Basic.Settings.General.MultiviewSceneRate.Quarter"), 4);
+
+	int sceneRateIndex = ui->multiviewSceneRate->findData(QVariant::fromValue(
+		config_get_int(App()->GetUserConfig(), "BasicWindow", "MultiviewSceneRateDivisor")));
+	ui->multiviewSceneRate->setCurrentIndex(sceneRateIndex >= 0 ? sceneRateIndex : 0);
+
 	prevLangIndex = ui->language->currentIndex();
 
 	if (obs_video_active()) {
@@ -3150,6 +3170,12 @@ void OBSBasicSettings::SaveGeneralSettings()
 #endif
 	}
 
+	if (WidgetChanged(ui->displayMaxFPS)) {
+		config_set_int(App()->GetUserConfig(), "BasicWindow", "DisplayMaxFPS",
+			       ui->displayMaxFPS->currentData().toInt());
+		main->UpdateDisplayMaxFPS();
+	}
+
 	if (WidgetChanged(ui->recordWhenStreaming)) {
 		config_set_bool(App()->GetUserConfig(), "BasicWindow", "RecordWhenStreaming",
 				ui->recordWhenStreaming->isChecked());
@@ -3234,6 +3260,12 @@ void OBSBasicSettings::SaveGeneralSettings()
 		multiviewChanged = true;
 	}
 
+	if (WidgetChanged(ui->multiviewSceneRate)) {
+		config_set_int(App()->GetUserConfig(), "BasicWindow", "MultiviewSceneRateDivisor",
+			       ui->multiviewSceneRate->currentData().toInt());
+		multiviewChanged = true;
+	}
+
 	if (multiviewChanged) {
 		OBSProjector::UpdateMultiviewProjectors();
 	}
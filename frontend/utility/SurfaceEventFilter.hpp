@@ -31,6 +31,9 @@ protected:
 				break;
 			}
 			break;
+		case QEvent::Expose:
+			display->UpdateOcclusion();
+			break;
 		default:
 			break;
 		}
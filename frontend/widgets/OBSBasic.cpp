@@ -1146,6 +1146,10 @@ void OBSBasic::OBSInit()
 
 	loaded = true;
 
+	/* Compile the shaders the loaded scene collection has not drawn with
+	 * yet in the background, rather than on first use */
+	obs_warm_up_effects();
+
 	previewEnabled = config_get_bool(App()->GetUserConfig(), "BasicWindow", "PreviewEnabled");
 
 	if (!previewEnabled && !IsPreviewProgramMode()) {
@@ -1159,6 +1163,9 @@ void OBSBasic::OBSInit()
 	auto addDisplay = [this](OBSQTDisplay *window) {
 		obs_display_add_draw_callback(window->GetDisplay(), OBSBasic::RenderMain, this);
 
+		double maxFPS = (double)config_get_int(App()->GetUserConfig(), "BasicWindow", "DisplayMaxFPS");
+		obs_display_set_max_fps(window->GetDisplay(), maxFPS);
+
 		struct obs_video_info ovi;
 		if (obs_get_video_info(&ovi)) {
 			ResizePreview(ovi.base_width, ovi.base_height);
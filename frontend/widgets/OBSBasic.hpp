@@ -831,6 +831,7 @@ private:
 
 	void UpdateProjectorHideCursor();
 	void UpdateProjectorAlwaysOnTop(bool top);
+	void UpdateDisplayMaxFPS();
 	void ResetProjectors();
 
 	void UpdatePreviewSafeAreas();
@@ -570,6 +570,17 @@ void OBSBasic::UpdateProjectorAlwaysOnTop(bool top)
 	}
 }
 
+void OBSBasic::UpdateDisplayMaxFPS()
+{
+	double maxFPS = (double)config_get_int(App()->GetUserConfig(), "BasicWindow", "DisplayMaxFPS");
+
+	obs_display_set_max_fps(ui->preview->GetDisplay(), maxFPS);
+
+	for (size_t i = 0; i < projectors.size(); i++) {
+		projectors[i]->SetMaxFPS();
+	}
+}
+
 void OBSBasic::ResetProjectors()
 {
 	OBSDataArrayAutoRelease savedProjectorList = SaveProjectors();
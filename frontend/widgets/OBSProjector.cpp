@@ -75,6 +75,7 @@ OBSProjector::OBSProjector(QWidget *widget, obs_source_t *source_, int monitor,
 		bool isMultiview = type == ProjectorType::Multiview;
 		obs_display_add_draw_callback(GetDisplay(), isMultiview ? OBSRenderMultiview : OBSRender, this);
 		obs_display_set_background_color(GetDisplay(), 0x000000);
+		SetMaxFPS();
 	};
 
 	connect(this, &OBSQTDisplay::DisplayCreated, this, addDrawCallback);
@@ -145,6 +146,12 @@ void OBSProjector::SetHideCursor()
 	}
 }
 
+void OBSProjector::SetMaxFPS()
+{
+	double maxFPS = (double)config_get_int(App()->GetUserConfig(), "BasicWindow", "DisplayMaxFPS");
+	obs_display_set_max_fps(GetDisplay(), maxFPS);
+}
+
 void OBSProjector::OBSRenderMultiview(void *data, uint32_t cx, uint32_t cy)
 {
 	OBSProjector *window = (OBSProjector *)data;
@@ -332,7 +339,9 @@ void OBSProjector::UpdateMultiview()
 
 	transitionOnDoubleClick = config_get_bool(App()->GetUserConfig(), "BasicWindow", "TransitionOnDoubleClick");
 
-	multiview->Update(multiviewLayout, drawLabel, drawSafeArea);
+	int sceneRateDivisor = (int)config_get_int(App()->GetUserConfig(), "BasicWindow", "MultiviewSceneRateDivisor");
+
+	multiview->Update(multiviewLayout, drawLabel, drawSafeArea, sceneRateDivisor);
 }
 
 void OBSProjector::UpdateProjectorTitle(QString name)
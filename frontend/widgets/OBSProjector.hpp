@@ -61,6 +61,7 @@ public:
 	int GetMonitor();
 	static void UpdateMultiviewProjectors();
 	void SetHideCursor();
+	void SetMaxFPS();
 
 	bool IsAlwaysOnTop() const;
 	bool IsAlwaysOnTopOverridden() const;
@@ -220,3 +220,10 @@ void OBSQTDisplay::OnDisplayChange()
 		obs_display_update_color_space(display);
 	}
 }
+
+void OBSQTDisplay::UpdateOcclusion()
+{
+	if (display) {
+		obs_display_set_occluded(display, !windowHandle()->isExposed());
+	}
+}
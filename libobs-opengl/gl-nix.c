@@ -17,6 +17,7 @@
 
 #include "gl-nix.h"
 #include "gl-x11-egl.h"
+#include "gl-surfaceless-egl.h"
 
 #ifdef ENABLE_WAYLAND
 #include "gl-wayland-egl.h"
@@ -40,6 +41,11 @@ static void init_winsys(void)
 	}
 #endif
 
+	if (platform == OBS_NIX_PLATFORM_SURFACELESS) {
+		gl_vtable = gl_surfaceless_egl_get_winsys_vtable();
+		blog(LOG_INFO, "Using surfaceless EGL");
+	}
+
 	assert(gl_vtable != NULL);
 }
 
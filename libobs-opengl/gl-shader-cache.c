@@ -0,0 +1,349 @@
+/******************************************************************************
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include <obs-config.h>
+#include <util/platform.h>
+#include <util/dstr.h>
+#include "gl-subsystem.h"
+
+/*
+ * On-disk program binary cache.
+ *
+ * Effects are still parsed and translated to GLSL on startup, that part is
+ * cheap and its output (params, samplers, attributes) is needed anyway.  The
+ * expensive part is the driver compiling and linking the GLSL, so linked
+ * programs are stored with glGetProgramBinary, keyed by a hash of the GLSL of
+ * both shaders.
+ *
+ * Shaders that compiled successfully before are recorded as well, their
+ * compilation is deferred until a program using them is not in the cache,
+ * which on a warm start is never.
+ *
+ * The whole cache is dropped when the driver or libobs changes.
+ */
+
+#define CACHE_VERSION 1
+#define PROGRAM_MAGIC 0x4F425350 /* "OBSP" */
+
+struct program_header {
+	uint32_t magic;
+	uint32_t format;
+	uint32_t size;
+};
+
+struct gl_shader_cache {
+	struct dstr path;
+	bool shaders_changed;
+	DARRAY(uint64_t) shaders;
+
+	uint32_t program_hits;
+	uint32_t program_misses;
+	uint32_t program_failures;
+	uint32_t compiles_skipped;
+};
+
+uint64_t gl_shader_cache_hash(uint64_t hash, const void *data, size_t size)
+{
+	const uint8_t *bytes = data;
+
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 0x100000001B3ULL;
+	}
+
+	return hash;
+}
+
+static void get_identity(struct dstr *identity)
+{
+	dstr_printf(identity, "%d\n%d\n%s\n%s\n%s\n", CACHE_VERSION, LIBOBS_API_VER,
+		    (const char *)glGetString(GL_VENDOR), (const char *)glGetString(GL_RENDERER),
+		    (const char *)glGetString(GL_VERSION));
+}
+
+static void cache_file_path(struct gl_shader_cache *cache, struct dstr *path, const char *file)
+{
+	dstr_copy_dstr(path, &cache->path);
+	dstr_cat(path, file);
+}
+
+static void purge_cache(struct gl_shader_cache *cache)
+{
+	struct dstr pattern = {0};
+	os_glob_t *glob;
+
+	cache_file_path(cache, &pattern, "*");
+
+	if (os_glob(pattern.array, 0, &glob) == 0) {
+		for (size_t i = 0; i < glob->gl_pathc; i++) {
+			if (!glob->gl_pathv[i].directory)
+				os_unlink(glob->gl_pathv[i].path);
+		}
+
+		os_globfree(glob);
+	}
+
+	dstr_free(&pattern);
+}
+
+static void load_shader_list(struct gl_shader_cache *cache)
+{
+	struct dstr path = {0};
+	cache_file_path(cache, &path, "shaders");
+
+	FILE *file = os_fopen(path.array, "rb");
+	if (file) {
+		uint64_t hash;
+		while (fread(&hash, sizeof(hash), 1, file) == 1)
+			da_push_back(cache->shaders, &hash);
+		fclose(file);
+	}
+
+	dstr_free(&path);
+}
+
+static void save_shader_list(struct gl_shader_cache *cache)
+{
+	struct dstr path = {0};
+	cache_file_path(cache, &path, "shaders");
+
+	FILE *file = os_fopen(path.array, "wb");
+	if (file) {
+		fwrite(cache->shaders.array, sizeof(uint64_t), cache->shaders.num, file);
+		fclose(file);
+	}
+
+	dstr_free(&path);
+}
+
+static bool program_binaries_supported(void)
+{
+	GLint formats = 0;
+
+	if (!GLAD_GL_VERSION_4_1 && !GLAD_GL_ARB_get_program_binary)
+		return false;
+
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+	return gl_success("glGetIntegerv") && formats > 0;
+}
+
+void device_set_cache_path(gs_device_t *device, const char *path)
+{
+	struct gl_shader_cache *cache;
+	struct dstr identity = {0};
+	struct dstr identity_path = {0};
+
+	gl_shader_cache_free(device);
+
+	if (!path || !*path)
+		return;
+
+	if (!program_binaries_supported()) {
+		blog(LOG_INFO, "Shader cache disabled, program binaries are not supported");
+		return;
+	}
+
+	cache = bzalloc(sizeof(struct gl_shader_cache));
+	dstr_copy(&cache->path, path);
+	if (dstr_end(&cache->path) != '/')
+		dstr_cat_ch(&cache->path, '/');
+
+	if (os_mkdirs(cache->path.array) == MKDIR_ERROR) {
+		blog(LOG_WARNING, "Shader cache disabled, failed to create '%s'", cache->path.array);
+		dstr_free(&cache->path);
+		bfree(cache);
+		return;
+	}
+
+	get_identity(&identity);
+	cache_file_path(cache, &identity_path, "identity");
+
+	char *stored = os_quick_read_utf8_file(identity_path.array);
+	if (stored && strcmp(stored, identity.array) == 0) {
+		load_shader_list(cache);
+	} else {
+		if (stored)
+			blog(LOG_INFO, "Driver or libobs changed, clearing shader cache");
+		purge_cache(cache);
+		os_quick_write_utf8_file(identity_path.array, identity.array, identity.len, false);
+	}
+
+	bfree(stored);
+	dstr_free(&identity_path);
+	dstr_free(&identity);
+
+	device->shader_cache = cache;
+}
+
+void gl_shader_cache_free(gs_device_t *device)
+{
+	struct gl_shader_cache *cache = device->shader_cache;
+	if (!cache)
+		return;
+
+	if (cache->shaders_changed)
+		save_shader_list(cache);
+
+	blog(LOG_INFO,
+	     "Shader cache: %" PRIu32 " program hits, %" PRIu32 " misses, %" PRIu32 " failed loads, %" PRIu32
+	     " shader compiles skipped",
+	     cache->program_hits, cache->program_misses, cache->program_failures, cache->compiles_skipped);
+
+	da_free(cache->shaders);
+	dstr_free(&cache->path);
+	bfree(cache);
+
+	device->shader_cache = NULL;
+}
+
+bool gl_shader_cache_has_shader(gs_device_t *device, uint64_t hash)
+{
+	struct gl_shader_cache *cache = device->shader_cache;
+	if (!cache)
+		return false;
+
+	for (size_t i = 0; i < cache->shaders.num; i++) {
+		if (cache->shaders.array[i] == hash) {
+			cache->compiles_skipped++;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void gl_shader_cache_add_shader(gs_device_t *device, uint64_t hash)
+{
+	struct gl_shader_cache *cache = device->shader_cache;
+	if (!cache)
+		return;
+
+	da_push_back(cache->shaders, &hash);
+	cache->shaders_changed = true;
+}
+
+static void program_file_path(struct gl_shader_cache *cache, struct dstr *path, uint64_t hash)
+{
+	dstr_copy_dstr(path, &cache->path);
+	dstr_catf(path, "%016" PRIx64 ".bin", hash);
+}
+
+bool gl_shader_cache_load_program(gs_device_t *device, GLuint program, uint64_t hash)
+{
+	struct gl_shader_cache *cache = device->shader_cache;
+	struct program_header header;
+	struct dstr path = {0};
+	uint8_t *data = NULL;
+	GLint linked = GL_FALSE;
+
+	if (!cache)
+		return false;
+
+	program_file_path(cache, &path, hash);
+
+	FILE *file = os_fopen(path.array, "rb");
+	if (!file) {
+		cache->program_misses++;
+		dstr_free(&path);
+		return false;
+	}
+
+	if (fread(&header, sizeof(header), 1, file) == 1 && header.magic == PROGRAM_MAGIC && header.size) {
+		data = bmalloc(header.size);
+		if (fread(data, 1, header.size, file) != header.size) {
+			bfree(data);
+			data = NULL;
+		}
+	}
+
+	fclose(file);
+
+	if (data) {
+		glProgramBinary(program, (GLenum)header.format, data, (GLsizei)header.size);
+		if (gl_success("glProgramBinary")) {
+			glGetProgramiv(program, GL_LINK_STATUS, &linked);
+			gl_success("glGetProgramiv");
+		}
+
+		bfree(data);
+	}
+
+	/* Drivers may reject binaries of other driver builds with the same
+	 * version string, the program is linked from source instead */
+	if (linked == GL_FALSE) {
+		cache->program_failures++;
+		os_unlink(path.array);
+	} else {
+		cache->program_hits++;
+	}
+
+	dstr_free(&path);
+	return linked != GL_FALSE;
+}
+
+void gl_shader_cache_prepare_program(gs_device_t *device, GLuint program)
+{
+	if (!device->shader_cache)
+		return;
+
+	glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	gl_success("glProgramParameteri");
+}
+
+void gl_shader_cache_save_program(gs_device_t *device, GLuint program, uint64_t hash)
+{
+	struct gl_shader_cache *cache = device->shader_cache;
+	struct program_header header = {.magic = PROGRAM_MAGIC};
+	struct dstr path = {0};
+	struct dstr temp_path = {0};
+	GLint size = 0;
+	GLenum format = 0;
+
+	if (!cache)
+		return;
+
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+	if (!gl_success("glGetProgramiv") || size <= 0)
+		return;
+
+	uint8_t *data = bmalloc(size);
+	glGetProgramBinary(program, size, &size, &format, data);
+	if (!gl_success("glGetProgramBinary") || size <= 0)
+		goto exit;
+
+	header.format = (uint32_t)format;
+	header.size = (uint32_t)size;
+
+	program_file_path(cache, &path, hash);
+	dstr_copy_dstr(&temp_path, &path);
+	dstr_cat(&temp_path, ".tmp");
+
+	/* Written to a temporary file first so a crash never leaves a
+	 * truncated binary behind */
+	FILE *file = os_fopen(temp_path.array, "wb");
+	if (!file)
+		goto exit;
+
+	bool success = fwrite(&header, sizeof(header), 1, file) == 1 && fwrite(data, 1, size, file) == (size_t)size;
+	fclose(file);
+
+	if (!success || os_rename(temp_path.array, path.array) != 0)
+		os_unlink(temp_path.array);
+
+exit:
+	dstr_free(&temp_path);
+	dstr_free(&path);
+	bfree(data);
+}
@@ -73,6 +73,7 @@ static bool gl_add_param(struct gs_shader *shader, struct shader_var *var, GLint
 		param.texture_id = (*texture_id)++;
 	} else {
 		param.changed = true;
+		param.in_block = gl_param_in_block(var);
 	}
 
 	da_move(param.def_value, var->default_val);
@@ -82,6 +83,63 @@ static bool gl_add_param(struct gs_shader *shader, struct shader_var *var, GLint
 	return true;
 }
 
+/* std140 size and alignment of the types that go into the uniform block */
+static size_t get_block_param_size(enum gs_shader_param_type type, size_t *align)
+{
+	switch (type) {
+	case GS_SHADER_PARAM_BOOL:
+	case GS_SHADER_PARAM_INT:
+	case GS_SHADER_PARAM_FLOAT:
+		*align = 4;
+		return 4;
+	case GS_SHADER_PARAM_INT2:
+	case GS_SHADER_PARAM_VEC2:
+		*align = 8;
+		return 8;
+	case GS_SHADER_PARAM_INT3:
+	case GS_SHADER_PARAM_VEC3:
+		*align = 16;
+		return 12;
+	case GS_SHADER_PARAM_INT4:
+	case GS_SHADER_PARAM_VEC4:
+		*align = 16;
+		return 16;
+	case GS_SHADER_PARAM_MATRIX4X4:
+		*align = 16;
+		return 64;
+	default:
+		*align = 4;
+		return 0;
+	}
+}
+
+/* Members are declared in param order by gl_write_param_block */
+static bool gl_init_param_block(struct gs_shader *shader)
+{
+	size_t offset = 0;
+
+	for (size_t i = 0; i < shader->params.num; i++) {
+		struct gs_shader_param *param = shader->params.array + i;
+		size_t align;
+
+		if (!param->in_block)
+			continue;
+
+		param->block_size = get_block_param_size(param->type, &align);
+		param->block_offset = (offset + align - 1) & ~(align - 1);
+		offset = param->block_offset + param->block_size;
+	}
+
+	if (!offset)
+		return true;
+
+	offset = (offset + 15) & ~(size_t)15;
+	da_resize(shader->block_data, offset);
+	memset(shader->block_data.array, 0, offset);
+
+	return gl_create_buffer(GL_UNIFORM_BUFFER, &shader->block_buffer, (GLsizeiptr)offset, NULL, GL_DYNAMIC_DRAW);
+}
+
 static inline bool gl_add_params(struct gs_shader *shader, struct gl_shader_parser *glsp)
 {
 	size_t i;
@@ -94,7 +152,7 @@ static inline bool gl_add_params(struct gs_shader *shader, struct gl_shader_pars
 	shader->viewproj = gs_shader_get_param_by_name(shader, "ViewProj");
 	shader->world = gs_shader_get_param_by_name(shader, "World");
 
-	return true;
+	return gl_init_param_block(shader);
 }
 
 static inline void gl_add_sampler(struct gs_shader *shader, struct shader_sampler *sampler)
@@ -174,8 +232,7 @@ static inline bool gl_process_attribs(struct gs_shader *shader, struct gl_shader
 	return true;
 }
 
-static bool gl_shader_init(struct gs_shader *shader, struct gl_shader_parser *glsp, const char *file,
-			   char **error_string)
+static bool gl_shader_compile(struct gs_shader *shader, const char *glsl, const char *file, char **error_string)
 {
 	GLenum type = convert_shader_type(shader->type);
 	int compiled = 0;
@@ -185,7 +242,7 @@ static bool gl_shader_init(struct gs_shader *shader, struct gl_shader_parser *gl
 	if (!gl_success("glCreateShader") || !shader->obj)
 		return false;
 
-	glShaderSource(shader->obj, 1, (const GLchar **)&glsp->gl_string.array, 0);
+	glShaderSource(shader->obj, 1, (const GLchar **)&glsl, 0);
 	if (!gl_success("glShaderSource"))
 		return false;
 
@@ -197,7 +254,7 @@ static bool gl_shader_init(struct gs_shader *shader, struct gl_shader_parser *gl
 	blog(LOG_DEBUG, "+++++++++++++++++++++++++++++++++++");
 	blog(LOG_DEBUG, "  GL shader string for: %s", file);
 	blog(LOG_DEBUG, "-----------------------------------");
-	blog(LOG_DEBUG, "%s", glsp->gl_string.array);
+	blog(LOG_DEBUG, "%s", glsl);
 	blog(LOG_DEBUG, "+++++++++++++++++++++++++++++++++++");
 #endif
 
@@ -223,6 +280,44 @@ static bool gl_shader_init(struct gs_shader *shader, struct gl_shader_parser *gl
 	}
 
 	gl_get_shader_info(shader->obj, file, error_string);
+	return success;
+}
+
+/* Compiles a shader whose compilation was deferred because it was known to
+ * compile, only needed if a program using it is not in the program cache */
+static bool gl_shader_compile_pending(struct gs_shader *shader)
+{
+	if (shader->obj)
+		return true;
+
+	bool success = gl_shader_compile(shader, shader->glsl, shader->file, NULL);
+	if (!success) {
+		glDeleteShader(shader->obj);
+		gl_success("glDeleteShader");
+		shader->obj = 0;
+	}
+
+	return success;
+}
+
+static bool gl_shader_init(struct gs_shader *shader, struct gl_shader_parser *glsp, const char *file,
+			   char **error_string)
+{
+	const char *glsl = glsp->gl_string.array;
+	gs_device_t *device = shader->device;
+	bool success = true;
+
+	shader->hash = gl_shader_cache_hash(GL_SHADER_CACHE_HASH_INIT, &shader->type, sizeof(shader->type));
+	shader->hash = gl_shader_cache_hash(shader->hash, glsl, glsp->gl_string.len);
+
+	if (gl_shader_cache_has_shader(device, shader->hash)) {
+		shader->glsl = bstrdup(glsl);
+		shader->file = bstrdup(file);
+	} else {
+		success = gl_shader_compile(shader, glsl, file, error_string);
+		if (success)
+			gl_shader_cache_add_shader(device, shader->hash);
+	}
 
 	if (success)
 		success = gl_add_params(shader, glsp);
@@ -317,6 +412,15 @@ void gs_shader_destroy(gs_shader_t *shader)
 	for (i = 0; i < shader->params.num; i++)
 		shader_param_free(shader->params.array + i);
 
+	if (shader->block_buffer) {
+		for (i = 0; i < GL_PARAM_BINDINGS; i++) {
+			if (shader->device->cur_param_buffers[i] == shader->block_buffer)
+				shader->device->cur_param_buffers[i] = 0;
+		}
+
+		gl_delete_buffers(1, &shader->block_buffer);
+	}
+
 	if (shader->obj) {
 		glDeleteShader(shader->obj);
 		gl_success("glDeleteShader");
@@ -325,6 +429,9 @@ void gs_shader_destroy(gs_shader_t *shader)
 	da_free(shader->samplers);
 	da_free(shader->params);
 	da_free(shader->attribs);
+	da_free(shader->block_data);
+	bfree(shader->glsl);
+	bfree(shader->file);
 	bfree(shader);
 }
 
@@ -502,12 +609,66 @@ static void program_set_param_data(struct gs_program *program, struct program_pa
 	}
 }
 
+/* Returns true if the value differs from what was last uploaded */
+static bool pack_block_param(struct gs_shader *shader, struct gs_shader_param *param)
+{
+	uint8_t *dst = shader->block_data.array + param->block_offset;
+
+	if (param->cur_value.num != param->block_size) {
+		blog(LOG_ERROR,
+		     "Parameter '%s' set to invalid size %u, "
+		     "expected %u",
+		     param->name, (unsigned int)param->cur_value.num, (unsigned int)param->block_size);
+		return false;
+	}
+
+	if (memcmp(dst, param->cur_value.array, param->block_size) == 0)
+		return false;
+
+	memcpy(dst, param->cur_value.array, param->block_size);
+	return true;
+}
+
+static void program_update_block(struct gs_program *program, struct gs_shader *shader, GLuint binding)
+{
+	struct gs_device *device = program->device;
+	bool changed = !shader->block_uploaded;
+
+	for (size_t i = 0; i < shader->params.num; i++) {
+		struct gs_shader_param *param = shader->params.array + i;
+		if (param->in_block && pack_block_param(shader, param))
+			changed = true;
+	}
+
+	if (changed) {
+		/* Respecifying the whole store lets the driver hand out fresh
+		 * memory instead of waiting on draws still using the old data */
+		if (gl_bind_buffer(GL_UNIFORM_BUFFER, shader->block_buffer)) {
+			glBufferData(GL_UNIFORM_BUFFER, (GLsizeiptr)shader->block_data.num, shader->block_data.array,
+				     GL_DYNAMIC_DRAW);
+			shader->block_uploaded = gl_success("glBufferData");
+			gl_bind_buffer(GL_UNIFORM_BUFFER, 0);
+		}
+	}
+
+	if (device->cur_param_buffers[binding] != shader->block_buffer) {
+		glBindBufferBase(GL_UNIFORM_BUFFER, binding, shader->block_buffer);
+		if (gl_success("glBindBufferBase"))
+			device->cur_param_buffers[binding] = shader->block_buffer;
+	}
+}
+
 void program_update_params(struct gs_program *program)
 {
 	for (size_t i = 0; i < program->params.num; i++) {
 		struct program_param *pp = program->params.array + i;
 		program_set_param_data(program, pp);
 	}
+
+	if (program->vertex_block)
+		program_update_block(program, program->vertex_shader, GL_VERTEX_PARAM_BINDING);
+	if (program->pixel_block)
+		program_update_block(program, program->pixel_shader, GL_PIXEL_PARAM_BINDING);
 }
 
 static void print_link_errors(GLuint program)
@@ -564,6 +725,9 @@ static bool assign_program_param(struct gs_program *program, struct gs_shader_pa
 {
 	struct program_param info;
 
+	if (param->in_block)
+		return true;
+
 	info.obj = glGetUniformLocation(program->obj, param->name);
 	if (!gl_success("glGetUniformLocation"))
 		return false;
@@ -588,48 +752,108 @@ static inline bool assign_program_shader_params(struct gs_program *program, stru
 	return true;
 }
 
+static bool assign_program_block(struct gs_program *program, struct gs_shader *shader, const char *name,
+				 GLuint binding, bool *active)
+{
+	*active = false;
+
+	if (!shader->block_buffer)
+		return true;
+
+	GLuint index = glGetUniformBlockIndex(program->obj, name);
+	if (!gl_success("glGetUniformBlockIndex"))
+		return false;
+
+	/* The compiler may have optimized the whole block out */
+	if (index == GL_INVALID_INDEX)
+		return true;
+
+	glUniformBlockBinding(program->obj, index, binding);
+	if (!gl_success("glUniformBlockBinding"))
+		return false;
+
+	*active = true;
+	return true;
+}
+
 static inline bool assign_program_params(struct gs_program *program)
 {
 	if (!assign_program_shader_params(program, program->vertex_shader))
 		return false;
 	if (!assign_program_shader_params(program, program->pixel_shader))
 		return false;
+	if (!assign_program_block(program, program->vertex_shader, GL_VERTEX_PARAM_BLOCK, GL_VERTEX_PARAM_BINDING,
+				  &program->vertex_block))
+		return false;
+	if (!assign_program_block(program, program->pixel_shader, GL_PIXEL_PARAM_BLOCK, GL_PIXEL_PARAM_BINDING,
+				  &program->pixel_block))
+		return false;
 
 	return true;
 }
 
-struct gs_program *gs_program_create(struct gs_device *device)
+static bool program_link(struct gs_program *program)
 {
-	struct gs_program *program = bzalloc(sizeof(*program));
 	int linked = false;
 
-	program->device = device;
-	program->vertex_shader = device->cur_vertex_shader;
-	program->pixel_shader = device->cur_pixel_shader;
+	if (!gl_shader_compile_pending(program->vertex_shader))
+		return false;
+	if (!gl_shader_compile_pending(program->pixel_shader))
+		return false;
 
-	program->obj = glCreateProgram();
-	if (!gl_success("glCreateProgram"))
-		goto error_detach_neither;
+	gl_shader_cache_prepare_program(program->device, program->obj);
 
 	glAttachShader(program->obj, program->vertex_shader->obj);
 	if (!gl_success("glAttachShader (vertex)"))
-		goto error_detach_neither;
+		return false;
 
 	glAttachShader(program->obj, program->pixel_shader->obj);
 	if (!gl_success("glAttachShader (pixel)"))
-		goto error_detach_vertex;
+		goto detach_vertex;
 
 	glLinkProgram(program->obj);
 	if (!gl_success("glLinkProgram"))
-		goto error;
+		goto detach_pixel;
 
 	glGetProgramiv(program->obj, GL_LINK_STATUS, &linked);
 	if (!gl_success("glGetProgramiv"))
-		goto error;
+		goto detach_pixel;
 
-	if (linked == GL_FALSE) {
+	if (linked == GL_FALSE)
 		print_link_errors(program->obj);
+
+detach_pixel:
+	glDetachShader(program->obj, program->pixel_shader->obj);
+	gl_success("glDetachShader (pixel)");
+
+detach_vertex:
+	glDetachShader(program->obj, program->vertex_shader->obj);
+	gl_success("glDetachShader (vertex)");
+
+	return linked != GL_FALSE;
+}
+
+struct gs_program *gs_program_create(struct gs_device *device)
+{
+	struct gs_program *program = bzalloc(sizeof(*program));
+	uint64_t hash;
+
+	program->device = device;
+	program->vertex_shader = device->cur_vertex_shader;
+	program->pixel_shader = device->cur_pixel_shader;
+
+	hash = gl_shader_cache_hash(GL_SHADER_CACHE_HASH_INIT, &program->vertex_shader->hash, sizeof(uint64_t));
+	hash = gl_shader_cache_hash(hash, &program->pixel_shader->hash, sizeof(uint64_t));
+
+	program->obj = glCreateProgram();
+	if (!gl_success("glCreateProgram"))
 		goto error;
+
+	if (!gl_shader_cache_load_program(device, program->obj, hash)) {
+		if (!program_link(program))
+			goto error;
+
+		gl_shader_cache_save_program(device, program->obj, hash);
 	}
 
 	if (!assign_program_attribs(program))
@@ -637,12 +861,6 @@ struct gs_program *gs_program_create(struct gs_device *device)
 	if (!assign_program_params(program))
 		goto error;
 
-	glDetachShader(program->obj, program->vertex_shader->obj);
-	gl_success("glDetachShader (vertex)");
-
-	glDetachShader(program->obj, program->pixel_shader->obj);
-	gl_success("glDetachShader (pixel)");
-
 	program->next = device->first_program;
 	program->prev_next = &device->first_program;
 	device->first_program = program;
@@ -652,14 +870,6 @@ struct gs_program *gs_program_create(struct gs_device *device)
 	return program;
 
 error:
-	glDetachShader(program->obj, program->pixel_shader->obj);
-	gl_success("glDetachShader (pixel)");
-
-error_detach_vertex:
-	glDetachShader(program->obj, program->vertex_shader->obj);
-	gl_success("glDetachShader (vertex)");
-
-error_detach_neither:
 	gs_program_destroy(program);
 	return NULL;
 }
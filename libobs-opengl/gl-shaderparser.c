@@ -117,16 +117,50 @@ static void gl_write_var(struct gl_shader_parser *glsp, struct shader_var *var)
 	dstr_cat(&glsp->gl_string, var->name);
 }
 
+static void gl_write_param_block(struct gl_shader_parser *glsp)
+{
+	bool empty = true;
+	size_t i;
+
+	for (i = 0; i < glsp->parser.params.num; i++) {
+		struct shader_var *var = glsp->parser.params.array + i;
+		if (!gl_param_in_block(var))
+			continue;
+
+		if (empty) {
+			dstr_cat(&glsp->gl_string, "layout(std140) uniform ");
+			dstr_cat(&glsp->gl_string,
+				 glsp->type == GS_SHADER_VERTEX ? GL_VERTEX_PARAM_BLOCK : GL_PIXEL_PARAM_BLOCK);
+			dstr_cat(&glsp->gl_string, " {\n");
+			empty = false;
+		}
+
+		dstr_cat(&glsp->gl_string, "\t");
+		gl_write_type(glsp, var->type);
+		dstr_cat(&glsp->gl_string, " ");
+		dstr_cat(&glsp->gl_string, var->name);
+		dstr_cat(&glsp->gl_string, ";\n");
+	}
+
+	if (!empty)
+		dstr_cat(&glsp->gl_string, "} " GL_PARAM_BLOCK_INSTANCE ";\n\n");
+}
+
 static inline void gl_write_params(struct gl_shader_parser *glsp)
 {
 	size_t i;
 	for (i = 0; i < glsp->parser.params.num; i++) {
 		struct shader_var *var = glsp->parser.params.array + i;
+		if (gl_param_in_block(var))
+			continue;
+
 		gl_write_var(glsp, var);
 		dstr_cat(&glsp->gl_string, ";\n");
 	}
 
 	dstr_cat(&glsp->gl_string, "\n");
+
+	gl_write_param_block(glsp);
 }
 
 static void gl_write_storage_var(struct gl_shader_parser *glsp, struct shader_var *var, bool input, const char *prefix);
@@ -448,6 +482,48 @@ static bool gl_write_texture_code(struct gl_shader_parser *glsp, struct cf_token
 	return true;
 }
 
+static inline const struct cf_token *prev_token(const struct cf_token *token)
+{
+	do {
+		token--;
+	} while (token->type == CFTOKEN_SPACETAB || token->type == CFTOKEN_NEWLINE);
+
+	return token;
+}
+
+static inline bool is_local_name(struct gl_shader_parser *glsp, const struct strref *name)
+{
+	for (size_t i = 0; i < glsp->local_names.num; i++) {
+		if (strref_cmp_strref(&glsp->local_names.array[i], name) == 0)
+			return true;
+	}
+
+	return false;
+}
+
+/* Block uniforms are members of the block instance, unless the name refers to
+ * a struct member, a function parameter or a local variable declared in the
+ * function being written */
+static bool gl_write_block_param(struct gl_shader_parser *glsp, struct cf_token *token)
+{
+	const struct cf_token *prev = prev_token(token);
+
+	if (prev->type == CFTOKEN_OTHER && strref_cmp(&prev->str, ".") == 0)
+		return false;
+	if (is_local_name(glsp, &token->str))
+		return false;
+
+	if (prev->type == CFTOKEN_NAME && strref_cmp(&prev->str, "return") != 0 &&
+	    strref_cmp(&prev->str, "else") != 0 && strref_cmp(&prev->str, "case") != 0) {
+		da_push_back(glsp->local_names, &token->str);
+		return false;
+	}
+
+	dstr_cat(&glsp->gl_string, GL_PARAM_BLOCK_INSTANCE ".");
+	dstr_cat_strref(&glsp->gl_string, &token->str);
+	return true;
+}
+
 static bool gl_write_intrinsic(struct gl_shader_parser *glsp, struct cf_token **p_token)
 {
 	struct cf_token *token = *p_token;
@@ -480,6 +556,8 @@ static bool gl_write_intrinsic(struct gl_shader_parser *glsp, struct cf_token **
 		struct shader_var *var = sp_getparam(glsp, token);
 		if (var && astrcmp_n(var->type, "texture", 7) == 0)
 			written = gl_write_texture_code(glsp, &token, var);
+		else if (var && gl_param_in_block(var))
+			written = gl_write_block_param(glsp, token);
 		else
 			written = false;
 	}
@@ -537,12 +615,18 @@ static void gl_write_function(struct gl_shader_parser *glsp, struct shader_func
 
 	dstr_cat(&glsp->gl_string, "(");
 
+	da_resize(glsp->local_names, 0);
+
 	for (i = 0; i < func->params.num; i++) {
 		struct shader_var *param = func->params.array + i;
+		struct strref name;
 
 		if (i > 0)
 			dstr_cat(&glsp->gl_string, ", ");
 		gl_write_var(glsp, param);
+
+		strref_set(&name, param->name, strlen(param->name));
+		da_push_back(glsp->local_names, &name);
 	}
 
 	dstr_cat(&glsp->gl_string, ")\n");
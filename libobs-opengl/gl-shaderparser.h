@@ -26,6 +26,30 @@
 #include <util/dstr.h>
 #include <graphics/shader-parser.h>
 
+/* Whether the param goes into the uniform block of the shader, see
+ * GL_PARAM_BLOCK_INSTANCE */
+static inline bool gl_param_in_block(const struct shader_var *var)
+{
+	if (var->var_type != SHADER_VAR_UNIFORM || var->array_count)
+		return false;
+
+	switch (get_shader_param_type(var->type)) {
+	case GS_SHADER_PARAM_BOOL:
+	case GS_SHADER_PARAM_FLOAT:
+	case GS_SHADER_PARAM_INT:
+	case GS_SHADER_PARAM_VEC2:
+	case GS_SHADER_PARAM_VEC3:
+	case GS_SHADER_PARAM_VEC4:
+	case GS_SHADER_PARAM_INT2:
+	case GS_SHADER_PARAM_INT3:
+	case GS_SHADER_PARAM_INT4:
+	case GS_SHADER_PARAM_MATRIX4X4:
+		return true;
+	default:
+		return false;
+	}
+}
+
 struct gl_parser_attrib {
 	struct dstr name;
 	const char *mapping;
@@ -52,6 +76,9 @@ struct gl_shader_parser {
 
 	DARRAY(uint32_t) texture_samplers;
 	DARRAY(struct gl_parser_attrib) attribs;
+
+	/* names hiding block uniforms in the function being written */
+	DARRAY(struct strref) local_names;
 };
 
 static inline void gl_shader_parser_init(struct gl_shader_parser *glsp, enum gs_shader_type type)
@@ -70,6 +97,7 @@ static inline void gl_shader_parser_init(struct gl_shader_parser *glsp, enum gs_
 	dstr_init(&glsp->gl_string);
 	da_init(glsp->texture_samplers);
 	da_init(glsp->attribs);
+	da_init(glsp->local_names);
 	glsp->sincos_counter = 1;
 }
 
@@ -80,6 +108,7 @@ static inline void gl_shader_parser_free(struct gl_shader_parser *glsp)
 		gl_parser_attrib_free(glsp->attribs.array + i);
 
 	da_free(glsp->attribs);
+	da_free(glsp->local_names);
 	da_free(glsp->texture_samplers);
 	dstr_free(&glsp->gl_string);
 	shader_parser_free(&glsp->parser);
@@ -27,6 +27,18 @@
 
 #include "gl-helpers.h"
 
+/*
+ * Uniforms other than textures and arrays are packed into one std140 uniform
+ * block per shader, so they can be uploaded with a single buffer update
+ * instead of a glUniform call each.  Bindings are per shader stage.
+ */
+#define GL_PARAM_BLOCK_INSTANCE "_obs_params"
+#define GL_VERTEX_PARAM_BLOCK "_obs_vertex_params"
+#define GL_PIXEL_PARAM_BLOCK "_obs_pixel_params"
+#define GL_VERTEX_PARAM_BINDING 0
+#define GL_PIXEL_PARAM_BINDING 1
+#define GL_PARAM_BINDINGS 2
+
 struct gl_platform;
 struct gl_windowinfo;
 
@@ -457,6 +469,11 @@ struct gs_shader_param {
 	DARRAY(uint8_t) cur_value;
 	DARRAY(uint8_t) def_value;
 	bool changed;
+
+	/* location in the shader's uniform block */
+	bool in_block;
+	size_t block_offset;
+	size_t block_size;
 };
 
 enum attrib_type { ATTRIB_POSITION, ATTRIB_NORMAL, ATTRIB_TANGENT, ATTRIB_COLOR, ATTRIB_TEXCOORD, ATTRIB_TARGET };
@@ -478,6 +495,17 @@ struct gs_shader {
 	DARRAY(struct shader_attrib) attribs;
 	DARRAY(struct gs_shader_param) params;
 	DARRAY(gs_samplerstate_t *) samplers;
+
+	/* std140 uniform block holding all non-texture params */
+	GLuint block_buffer;
+	DARRAY(uint8_t) block_data;
+	bool block_uploaded;
+
+	/* hash of the translated GLSL, and the GLSL itself while compilation
+	 * is deferred (see gl-shader-cache.c) */
+	uint64_t hash;
+	char *glsl;
+	char *file;
 };
 
 struct program_param {
@@ -493,11 +521,25 @@ struct gs_program {
 
 	DARRAY(struct program_param) params;
 	DARRAY(GLint) attribs;
+	bool vertex_block;
+	bool pixel_block;
 
 	struct gs_program **prev_next;
 	struct gs_program *next;
 };
 
+#define GL_SHADER_CACHE_HASH_INIT 0xCBF29CE484222325ULL
+
+struct gl_shader_cache;
+
+extern uint64_t gl_shader_cache_hash(uint64_t hash, const void *data, size_t size);
+extern void gl_shader_cache_free(gs_device_t *device);
+extern bool gl_shader_cache_has_shader(gs_device_t *device, uint64_t hash);
+extern void gl_shader_cache_add_shader(gs_device_t *device, uint64_t hash);
+extern bool gl_shader_cache_load_program(gs_device_t *device, GLuint program, uint64_t hash);
+extern void gl_shader_cache_prepare_program(gs_device_t *device, GLuint program);
+extern void gl_shader_cache_save_program(gs_device_t *device, GLuint program, uint64_t hash);
+
 extern struct gs_program *gs_program_create(struct gs_device *device);
 extern void gs_program_destroy(struct gs_program *program);
 extern void program_update_params(struct gs_program *shader);
@@ -551,6 +593,8 @@ struct gs_texture {
 	struct fbo_info *fbo;
 };
 
+#define GL_UNPACK_RING_SIZE 4
+
 struct gs_texture_2d {
 	struct gs_texture base;
 
@@ -558,6 +602,13 @@ struct gs_texture_2d {
 	uint32_t height;
 	bool gen_mipmaps;
 	GLuint unpack_buffer;
+
+	/* persistently mapped upload ring inside unpack_buffer */
+	uint8_t *unpack_ptr;
+	GLsizeiptr unpack_slot_size;
+	GLsync unpack_fences[GL_UNPACK_RING_SIZE];
+	bool unpack_held[GL_UNPACK_RING_SIZE];
+	uint32_t unpack_slot;
 };
 
 struct gs_texture_3d {
@@ -642,9 +693,11 @@ struct gs_device {
 	gs_shader_t *cur_pixel_shader;
 	gs_swapchain_t *cur_swap;
 	struct gs_program *cur_program;
+	GLuint cur_param_buffers[GL_PARAM_BINDINGS];
 	enum gs_color_space cur_color_space;
 
 	struct gs_program *first_program;
+	struct gl_shader_cache *shader_cache;
 
 	enum gs_cull_mode cur_cull_mode;
 	struct gs_rect cur_viewport;
@@ -0,0 +1,456 @@
+/******************************************************************************
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+/*
+ * Headless EGL context without any window system.
+ *
+ * Adapter 0 uses the Mesa surfaceless platform, which picks a render node if
+ * there is one and falls back to llvmpipe otherwise.  Other adapters map to
+ * EGL devices in the order gl_egl_enum_adapters reports them.  All rendering
+ * goes to framebuffer objects, there are no swap chains.
+ */
+
+#include "gl-surfaceless-egl.h"
+
+#include <util/platform.h>
+
+#include "gl-egl-common.h"
+
+#include <glad/glad_egl.h>
+
+#ifndef EGL_PLATFORM_DEVICE_EXT
+#define EGL_PLATFORM_DEVICE_EXT 0x313F
+#endif
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+#ifndef EGL_NO_CONFIG_KHR
+#define EGL_NO_CONFIG_KHR ((EGLConfig)0)
+#endif
+
+static const EGLint config_attribs[] = {EGL_SURFACE_TYPE,
+					EGL_PBUFFER_BIT,
+					EGL_RENDERABLE_TYPE,
+					EGL_OPENGL_BIT,
+					EGL_RED_SIZE,
+					8,
+					EGL_GREEN_SIZE,
+					8,
+					EGL_BLUE_SIZE,
+					8,
+					EGL_NONE};
+
+static const EGLint ctx_attribs[] = {
+#ifdef _DEBUG
+	EGL_CONTEXT_OPENGL_DEBUG,
+	EGL_TRUE,
+#endif
+	EGL_CONTEXT_OPENGL_PROFILE_MASK,
+	EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+	EGL_CONTEXT_MAJOR_VERSION,
+	3,
+	EGL_CONTEXT_MINOR_VERSION,
+	3,
+	EGL_NONE};
+
+struct gl_windowinfo {
+	int unused;
+};
+
+struct gl_platform {
+	EGLDisplay display;
+	EGLConfig config;
+	EGLContext context;
+
+	int drm_fd;
+};
+
+static bool extension_supported(const char *extensions, const char *search)
+{
+	if (!extensions)
+		return false;
+
+	const char *result = strstr(extensions, search);
+	unsigned long len = strlen(search);
+	return result != NULL && (result == extensions || *(result - 1) == ' ') &&
+	       (result[len] == ' ' || result[len] == '\0');
+}
+
+static EGLDisplay get_device_display(uint32_t adapter)
+{
+	EGLDeviceEXT devices[32];
+	EGLint num_devices = 0;
+
+	if (!eglQueryDevicesEXT || !eglQueryDevicesEXT(32, devices, &num_devices))
+		return EGL_NO_DISPLAY;
+	if (adapter > (uint32_t)num_devices) {
+		blog(LOG_WARNING, "EGL device %" PRIu32 " not found, %d available", adapter, num_devices);
+		return EGL_NO_DISPLAY;
+	}
+
+	const EGLAttrib plat_attribs[] = {EGL_NONE};
+	return eglGetPlatformDisplay(EGL_PLATFORM_DEVICE_EXT, devices[adapter - 1], plat_attribs);
+}
+
+static EGLDisplay get_display(uint32_t adapter)
+{
+	const char *client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+	const EGLAttrib plat_attribs[] = {EGL_NONE};
+
+	if (adapter > 0) {
+		if (extension_supported(client_extensions, "EGL_EXT_platform_device")) {
+			EGLDisplay display = get_device_display(adapter);
+			if (display != EGL_NO_DISPLAY)
+				return display;
+		}
+
+		blog(LOG_WARNING, "Unable to use EGL device %" PRIu32 ", using the default device", adapter);
+	}
+
+	if (!extension_supported(client_extensions, "EGL_MESA_platform_surfaceless")) {
+		blog(LOG_ERROR, "EGL_MESA_platform_surfaceless is not supported");
+		return EGL_NO_DISPLAY;
+	}
+
+	return eglGetPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, plat_attribs);
+}
+
+static bool egl_context_create(struct gl_platform *plat, const char *extensions)
+{
+	EGLint num_config = 0;
+
+	if (eglBindAPI(EGL_OPENGL_API) == EGL_FALSE) {
+		blog(LOG_ERROR, "eglBindAPI failed");
+		return false;
+	}
+
+	/* no surface is ever created, the config only has to match the
+	 * context when EGL_KHR_no_config_context is not there */
+	if (extension_supported(extensions, "EGL_KHR_no_config_context")) {
+		plat->config = EGL_NO_CONFIG_KHR;
+	} else if (eglChooseConfig(plat->display, config_attribs, &plat->config, 1, &num_config) != EGL_TRUE ||
+		   num_config == 0) {
+		blog(LOG_ERROR, "eglChooseConfig failed: %s", gl_egl_error_to_string(eglGetError()));
+		return false;
+	}
+
+	plat->context = eglCreateContext(plat->display, plat->config, EGL_NO_CONTEXT, ctx_attribs);
+	if (plat->context == EGL_NO_CONTEXT) {
+		blog(LOG_ERROR, "eglCreateContext failed: %s", gl_egl_error_to_string(eglGetError()));
+		return false;
+	}
+
+	if (!eglMakeCurrent(plat->display, EGL_NO_SURFACE, EGL_NO_SURFACE, plat->context)) {
+		blog(LOG_ERROR, "eglMakeCurrent failed: %s", gl_egl_error_to_string(eglGetError()));
+		eglDestroyContext(plat->display, plat->context);
+		return false;
+	}
+
+	return true;
+}
+
+static void egl_context_destroy(struct gl_platform *plat)
+{
+	eglMakeCurrent(plat->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	eglDestroyContext(plat->display, plat->context);
+}
+
+static struct gl_windowinfo *gl_surfaceless_egl_windowinfo_create(const struct gs_init_data *info)
+{
+	UNUSED_PARAMETER(info);
+
+	blog(LOG_ERROR, "Swap chains are not available with a surfaceless EGL context");
+	return NULL;
+}
+
+static void gl_surfaceless_egl_windowinfo_destroy(struct gl_windowinfo *info)
+{
+	bfree(info);
+}
+
+static struct gl_platform *gl_surfaceless_egl_platform_create(gs_device_t *device, uint32_t adapter)
+{
+	struct gl_platform *plat = bzalloc(sizeof(struct gl_platform));
+	const uint64_t start_ns = os_gettime_ns();
+	EGLint major;
+	EGLint minor;
+
+	device->plat = plat;
+
+	if (!gladLoadEGL()) {
+		blog(LOG_ERROR, "Unable to load EGL entry functions.");
+		goto fail_display_init;
+	}
+
+	plat->display = get_display(adapter);
+	if (plat->display == EGL_NO_DISPLAY) {
+		blog(LOG_ERROR, "eglGetPlatformDisplay failed");
+		goto fail_display_init;
+	}
+
+	if (eglInitialize(plat->display, &major, &minor) == EGL_FALSE) {
+		blog(LOG_ERROR, "eglInitialize failed");
+		goto fail_display_init;
+	}
+
+	blog(LOG_INFO, "Initialized surfaceless EGL %d.%d", major, minor);
+
+	if (major == 1 && minor < 5) {
+		blog(LOG_ERROR, "EGL 1.5 or higher is required.");
+		goto fail_context_create;
+	}
+
+	const char *extensions = eglQueryString(plat->display, EGL_EXTENSIONS);
+	blog(LOG_DEBUG, "Supported EGL Extensions: %s", extensions);
+
+	if (!extension_supported(extensions, "EGL_KHR_surfaceless_context")) {
+		blog(LOG_ERROR, "EGL_KHR_surfaceless_context is not supported");
+		goto fail_context_create;
+	}
+
+	if (!egl_context_create(plat, extensions))
+		goto fail_context_create;
+
+	if (!gladLoadGL()) {
+		blog(LOG_ERROR, "Failed to load OpenGL entry functions.");
+		goto fail_load_gl;
+	}
+
+	/* llvmpipe has no render node, dmabuf import is unavailable then */
+	plat->drm_fd = get_drm_render_node_fd(plat->display);
+	if (plat->drm_fd < 0)
+		blog(LOG_INFO, "No DRM render node, running without dmabuf support");
+
+	blog(LOG_INFO, "Surfaceless EGL context created in %.1f ms", (double)(os_gettime_ns() - start_ns) / 1000000.0);
+	return plat;
+
+fail_load_gl:
+	egl_context_destroy(plat);
+fail_context_create:
+	eglTerminate(plat->display);
+fail_display_init:
+	bfree(plat);
+	return NULL;
+}
+
+static void gl_surfaceless_egl_platform_destroy(struct gl_platform *plat)
+{
+	if (plat) {
+		egl_context_destroy(plat);
+		eglTerminate(plat->display);
+		if (plat->drm_fd >= 0)
+			close_drm_render_node_fd(plat->drm_fd);
+		bfree(plat);
+	}
+}
+
+static bool gl_surfaceless_egl_platform_init_swapchain(struct gs_swap_chain *swap)
+{
+	UNUSED_PARAMETER(swap);
+	return false;
+}
+
+static void gl_surfaceless_egl_platform_cleanup_swapchain(struct gs_swap_chain *swap)
+{
+	UNUSED_PARAMETER(swap);
+}
+
+static void gl_surfaceless_egl_device_enter_context(gs_device_t *device)
+{
+	struct gl_platform *plat = device->plat;
+
+	if (!eglMakeCurrent(plat->display, EGL_NO_SURFACE, EGL_NO_SURFACE, plat->context))
+		blog(LOG_ERROR, "eglMakeCurrent failed: %s", gl_egl_error_to_string(eglGetError()));
+}
+
+static void gl_surfaceless_egl_device_leave_context(gs_device_t *device)
+{
+	struct gl_platform *plat = device->plat;
+
+	eglMakeCurrent(plat->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+}
+
+static void *gl_surfaceless_egl_device_get_device_obj(gs_device_t *device)
+{
+	return device->plat->context;
+}
+
+static void gl_surfaceless_egl_getclientsize(const struct gs_swap_chain *swap, uint32_t *width, uint32_t *height)
+{
+	*width = swap->info.cx;
+	*height = swap->info.cy;
+}
+
+static void gl_surfaceless_egl_clear_context(gs_device_t *device)
+{
+	struct gl_platform *plat = device->plat;
+
+	eglMakeCurrent(plat->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+}
+
+static void gl_surfaceless_egl_update(gs_device_t *device)
+{
+	UNUSED_PARAMETER(device);
+}
+
+static void gl_surfaceless_egl_device_load_swapchain(gs_device_t *device, gs_swapchain_t *swap)
+{
+	device->cur_swap = swap;
+}
+
+static void gl_surfaceless_egl_device_present(gs_device_t *device)
+{
+	UNUSED_PARAMETER(device);
+}
+
+static struct gs_texture *
+gl_surfaceless_egl_device_texture_create_from_dmabuf(gs_device_t *device, unsigned int width, unsigned int height,
+						     uint32_t drm_format, enum gs_color_format color_format,
+						     uint32_t n_planes, const int *fds, const uint32_t *strides,
+						     const uint32_t *offsets, const uint64_t *modifiers)
+{
+	struct gl_platform *plat = device->plat;
+
+	return gl_egl_create_dmabuf_image(plat->display, width, height, drm_format, color_format, n_planes, fds,
+					  strides, offsets, modifiers);
+}
+
+static bool gl_surfaceless_egl_device_query_dmabuf_capabilities(gs_device_t *device,
+								enum gs_dmabuf_flags *dmabuf_flags,
+								uint32_t **drm_formats, size_t *n_formats)
+{
+	struct gl_platform *plat = device->plat;
+
+	return gl_egl_query_dmabuf_capabilities(plat->display, dmabuf_flags, drm_formats, n_formats);
+}
+
+static bool gl_surfaceless_egl_device_query_dmabuf_modifiers_for_format(gs_device_t *device, uint32_t drm_format,
+									uint64_t **modifiers, size_t *n_modifiers)
+{
+	struct gl_platform *plat = device->plat;
+
+	return gl_egl_query_dmabuf_modifiers_for_format(plat->display, drm_format, modifiers, n_modifiers);
+}
+
+static struct gs_texture *gl_surfaceless_egl_device_texture_create_from_pixmap(gs_device_t *device, uint32_t width,
+									       uint32_t height,
+									       enum gs_color_format color_format,
+									       uint32_t target, void *pixmap)
+{
+	UNUSED_PARAMETER(device);
+	UNUSED_PARAMETER(width);
+	UNUSED_PARAMETER(height);
+	UNUSED_PARAMETER(color_format);
+	UNUSED_PARAMETER(target);
+	UNUSED_PARAMETER(pixmap);
+
+	return NULL;
+}
+
+static bool gl_surfaceless_egl_enum_adapters(gs_device_t *device,
+					     bool (*callback)(void *param, const char *name, uint32_t id), void *param)
+{
+	return gl_egl_enum_adapters(device->plat->display, callback, param);
+}
+
+static bool gl_surfaceless_egl_device_query_sync_capabilities(gs_device_t *device)
+{
+	struct gl_platform *plat = device->plat;
+
+	return gl_egl_query_sync_capabilities(plat->drm_fd);
+}
+
+static gs_sync_t *gl_surfaceless_egl_device_sync_create(gs_device_t *device)
+{
+	struct gl_platform *plat = device->plat;
+
+	return gl_egl_create_sync(plat->display);
+}
+
+static gs_sync_t *gl_surfaceless_egl_device_sync_create_from_syncobj_timeline_point(gs_device_t *device,
+										    int syncobj_fd,
+										    uint64_t timeline_point)
+{
+	struct gl_platform *plat = device->plat;
+
+	return gl_egl_create_sync_from_syncobj_timeline_point(plat->display, plat->drm_fd, syncobj_fd, timeline_point);
+}
+
+static void gl_surfaceless_egl_device_sync_destroy(gs_device_t *device, gs_sync_t *sync)
+{
+	struct gl_platform *plat = device->plat;
+
+	gl_egl_device_sync_destroy(plat->display, sync);
+}
+
+static bool gl_surfaceless_egl_device_sync_export_syncobj_timeline_point(gs_device_t *device, gs_sync_t *sync,
+									 int syncobj_fd, uint64_t timeline_point)
+{
+	struct gl_platform *plat = device->plat;
+
+	return gl_egl_sync_export_syncobj_timeline_point(plat->display, sync, plat->drm_fd, syncobj_fd, timeline_point);
+}
+
+static bool gl_surfaceless_egl_device_sync_signal_syncobj_timeline_point(gs_device_t *device, int syncobj_fd,
+									 uint64_t timeline_point)
+{
+	struct gl_platform *plat = device->plat;
+
+	return gl_egl_sync_signal_syncobj_timeline_point(plat->drm_fd, syncobj_fd, timeline_point);
+}
+
+static bool gl_surfaceless_egl_device_sync_wait(gs_device_t *device, gs_sync_t *sync)
+{
+	struct gl_platform *plat = device->plat;
+
+	return gl_egl_sync_wait(plat->display, sync);
+}
+
+static const struct gl_winsys_vtable egl_surfaceless_winsys_vtable = {
+	.windowinfo_create = gl_surfaceless_egl_windowinfo_create,
+	.windowinfo_destroy = gl_surfaceless_egl_windowinfo_destroy,
+	.platform_create = gl_surfaceless_egl_platform_create,
+	.platform_destroy = gl_surfaceless_egl_platform_destroy,
+	.platform_init_swapchain = gl_surfaceless_egl_platform_init_swapchain,
+	.platform_cleanup_swapchain = gl_surfaceless_egl_platform_cleanup_swapchain,
+	.device_enter_context = gl_surfaceless_egl_device_enter_context,
+	.device_leave_context = gl_surfaceless_egl_device_leave_context,
+	.device_get_device_obj = gl_surfaceless_egl_device_get_device_obj,
+	.getclientsize = gl_surfaceless_egl_getclientsize,
+	.clear_context = gl_surfaceless_egl_clear_context,
+	.update = gl_surfaceless_egl_update,
+	.device_load_swapchain = gl_surfaceless_egl_device_load_swapchain,
+	.device_present = gl_surfaceless_egl_device_present,
+	.device_texture_create_from_dmabuf = gl_surfaceless_egl_device_texture_create_from_dmabuf,
+	.device_query_dmabuf_capabilities = gl_surfaceless_egl_device_query_dmabuf_capabilities,
+	.device_query_dmabuf_modifiers_for_format = gl_surfaceless_egl_device_query_dmabuf_modifiers_for_format,
+	.device_texture_create_from_pixmap = gl_surfaceless_egl_device_texture_create_from_pixmap,
+	.device_enum_adapters = gl_surfaceless_egl_enum_adapters,
+	.device_query_sync_capabilities = gl_surfaceless_egl_device_query_sync_capabilities,
+	.device_sync_create = gl_surfaceless_egl_device_sync_create,
+	.device_sync_create_from_syncobj_timeline_point =
+		gl_surfaceless_egl_device_sync_create_from_syncobj_timeline_point,
+	.device_sync_destroy = gl_surfaceless_egl_device_sync_destroy,
+	.device_sync_export_syncobj_timeline_point = gl_surfaceless_egl_device_sync_export_syncobj_timeline_point,
+	.device_sync_signal_syncobj_timeline_point = gl_surfaceless_egl_device_sync_signal_syncobj_timeline_point,
+	.device_sync_wait = gl_surfaceless_egl_device_sync_wait,
+};
+
+const struct gl_winsys_vtable *gl_surfaceless_egl_get_winsys_vtable(void)
+{
+	return &egl_surfaceless_winsys_vtable;
+}
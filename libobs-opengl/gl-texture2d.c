@@ -42,6 +42,42 @@ static bool upload_texture_2d(struct gs_texture_2d *tex, const uint8_t **data)
 	return success;
 }
 
+/*
+ * Dynamic textures are updated through a ring of slots in one persistently
+ * mapped pixel unpack buffer when buffer storage is available.  Mapping only
+ * waits on the fence of the slot being reused, which the GPU finished with
+ * frames ago, and unmapping only issues the buffer to texture copy.  Slots
+ * can also be handed out with gs_texture_map_slot so that they are filled on
+ * another thread.  Without persistent mapping the buffer is mapped with
+ * invalidation on every upload instead.
+ */
+static bool create_unpack_storage(struct gs_texture_2d *tex, GLsizeiptr size)
+{
+	const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+	tex->unpack_slot_size = size;
+
+	if (GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage) {
+		glBufferStorage(GL_PIXEL_UNPACK_BUFFER, size * GL_UNPACK_RING_SIZE, NULL, flags);
+		if (gl_success("glBufferStorage")) {
+			tex->unpack_ptr =
+				glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size * GL_UNPACK_RING_SIZE, flags);
+			if (gl_success("glMapBufferRange") && tex->unpack_ptr) {
+				tex->unpack_slot = GL_UNPACK_RING_SIZE - 1;
+				return true;
+			}
+
+			/* the storage is immutable now, keep the buffer and
+			 * map its first slot for every upload instead */
+			tex->unpack_ptr = NULL;
+			return true;
+		}
+	}
+
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, size, 0, GL_DYNAMIC_DRAW);
+	return gl_success("glBufferData");
+}
+
 static bool create_pixel_unpack_buffer(struct gs_texture_2d *tex)
 {
 	GLsizeiptr size;
@@ -63,8 +99,7 @@ static bool create_pixel_unpack_buffer(struct gs_texture_2d *tex)
 		size /= 8;
 	}
 
-	glBufferData(GL_PIXEL_UNPACK_BUFFER, size, 0, GL_DYNAMIC_DRAW);
-	if (!gl_success("glBufferData"))
+	if (!create_unpack_storage(tex, size))
 		success = false;
 
 	if (!gl_bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0))
@@ -73,6 +108,17 @@ static bool create_pixel_unpack_buffer(struct gs_texture_2d *tex)
 	return success;
 }
 
+static void destroy_unpack_fences(struct gs_texture_2d *tex)
+{
+	for (size_t i = 0; i < GL_UNPACK_RING_SIZE; i++) {
+		if (tex->unpack_fences[i]) {
+			glDeleteSync(tex->unpack_fences[i]);
+			gl_success("glDeleteSync");
+			tex->unpack_fences[i] = NULL;
+		}
+	}
+}
+
 gs_texture_t *device_texture_create(gs_device_t *device, uint32_t width, uint32_t height,
 				    enum gs_color_format color_format, uint32_t levels, const uint8_t **data,
 				    uint32_t flags)
@@ -139,6 +185,7 @@ void gs_texture_destroy(gs_texture_t *tex)
 	if (!tex->is_dummy && tex->is_dynamic) {
 		if (tex->type == GS_TEXTURE_2D) {
 			struct gs_texture_2d *tex2d = (struct gs_texture_2d *)tex;
+			destroy_unpack_fences(tex2d);
 			if (tex2d->unpack_buffer)
 				gl_delete_buffers(1, &tex2d->unpack_buffer);
 		} else if (tex->type == GS_TEXTURE_3D) {
@@ -180,6 +227,73 @@ enum gs_color_format gs_texture_get_color_format(const gs_texture_t *tex)
 	return tex->format;
 }
 
+static inline uint32_t unpack_linesize(const struct gs_texture_2d *tex2d)
+{
+	uint32_t linesize = tex2d->width * gs_get_format_bpp(tex2d->base.format) / 8;
+	return (linesize + 3) & 0xFFFFFFFC;
+}
+
+/* Picks the next ring slot that is not handed out, waiting for the GPU to
+ * finish the last upload from it */
+static bool acquire_unpack_slot(struct gs_texture_2d *tex2d, uint32_t *slot)
+{
+	for (uint32_t i = 1; i <= GL_UNPACK_RING_SIZE; i++) {
+		uint32_t idx = (tex2d->unpack_slot + i) % GL_UNPACK_RING_SIZE;
+		GLsync fence = tex2d->unpack_fences[idx];
+
+		if (tex2d->unpack_held[idx])
+			continue;
+
+		if (fence) {
+			glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+			gl_success("glClientWaitSync");
+			glDeleteSync(fence);
+			gl_success("glDeleteSync");
+			tex2d->unpack_fences[idx] = NULL;
+		}
+
+		tex2d->unpack_slot = idx;
+		*slot = idx;
+		return true;
+	}
+
+	return false;
+}
+
+/* Copies the unpack buffer at the given offset into the texture, the buffer
+ * has to be bound */
+static bool copy_unpack_buffer(struct gs_texture_2d *tex2d, GLintptr offset)
+{
+	struct gs_texture *tex = &tex2d->base;
+
+	if (!gl_bind_texture(GL_TEXTURE_2D, tex->texture))
+		return false;
+
+	/* storage was allocated on creation, only the contents change */
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, tex2d->width, tex2d->height, tex->gl_format, tex->gl_type,
+			(const void *)offset);
+	return gl_success("glTexSubImage2D");
+}
+
+static bool upload_unpack_slot(struct gs_texture_2d *tex2d, uint32_t slot)
+{
+	bool success = false;
+
+	if (!gl_bind_buffer(GL_PIXEL_UNPACK_BUFFER, tex2d->unpack_buffer))
+		goto done;
+	if (!copy_unpack_buffer(tex2d, (GLintptr)slot * tex2d->unpack_slot_size))
+		goto done;
+
+	tex2d->unpack_fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	gl_success("glFenceSync");
+	success = true;
+
+done:
+	gl_bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	gl_bind_texture(GL_TEXTURE_2D, 0);
+	return success;
+}
+
 bool gs_texture_map(gs_texture_t *tex, uint8_t **ptr, uint32_t *linesize)
 {
 	struct gs_texture_2d *tex2d = (struct gs_texture_2d *)tex;
@@ -192,17 +306,28 @@ bool gs_texture_map(gs_texture_t *tex, uint8_t **ptr, uint32_t *linesize)
 		goto fail;
 	}
 
-	if (!gl_bind_buffer(GL_PIXEL_UNPACK_BUFFER, tex2d->unpack_buffer))
-		goto fail;
+	if (tex2d->unpack_ptr) {
+		uint32_t slot;
 
-	*ptr = glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
-	if (!gl_success("glMapBuffer"))
-		goto fail;
+		if (!acquire_unpack_slot(tex2d, &slot))
+			goto fail;
 
-	gl_bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		*ptr = tex2d->unpack_ptr + slot * tex2d->unpack_slot_size;
+	} else {
+		if (!gl_bind_buffer(GL_PIXEL_UNPACK_BUFFER, tex2d->unpack_buffer))
+			goto fail;
+
+		/* invalidate the previous contents so mapping does not wait
+		 * for the last upload to finish */
+		*ptr = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, tex2d->unpack_slot_size,
+					GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+		if (!gl_success("glMapBufferRange") || !*ptr)
+			goto fail;
+
+		gl_bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	}
 
-	*linesize = tex2d->width * gs_get_format_bpp(tex->format) / 8;
-	*linesize = (*linesize + 3) & 0xFFFFFFFC;
+	*linesize = unpack_linesize(tex2d);
 	return true;
 
 fail:
@@ -216,6 +341,12 @@ void gs_texture_unmap(gs_texture_t *tex)
 	if (!is_texture_2d(tex, "gs_texture_unmap"))
 		goto failed;
 
+	if (tex2d->unpack_ptr) {
+		if (!upload_unpack_slot(tex2d, tex2d->unpack_slot))
+			goto failed;
+		return;
+	}
+
 	if (!gl_bind_buffer(GL_PIXEL_UNPACK_BUFFER, tex2d->unpack_buffer))
 		goto failed;
 
@@ -223,12 +354,7 @@ void gs_texture_unmap(gs_texture_t *tex)
 	if (!gl_success("glUnmapBuffer"))
 		goto failed;
 
-	if (!gl_bind_texture(GL_TEXTURE_2D, tex2d->base.texture))
-		goto failed;
-
-	glTexImage2D(GL_TEXTURE_2D, 0, tex->gl_internal_format, tex2d->width, tex2d->height, 0, tex->gl_format,
-		     tex->gl_type, 0);
-	if (!gl_success("glTexImage2D"))
+	if (!copy_unpack_buffer(tex2d, 0))
 		goto failed;
 
 	gl_bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
@@ -241,6 +367,47 @@ failed:
 	blog(LOG_ERROR, "gs_texture_unmap (GL) failed");
 }
 
+bool gs_texture_map_slot(gs_texture_t *tex, uint32_t *slot, uint8_t **ptr, uint32_t *linesize)
+{
+	struct gs_texture_2d *tex2d = (struct gs_texture_2d *)tex;
+
+	if (tex->type != GS_TEXTURE_2D || !tex->is_dynamic || !tex2d->unpack_ptr)
+		return false;
+	if (!acquire_unpack_slot(tex2d, slot))
+		return false;
+
+	/* the mapping is persistent and coherent, the pointer stays valid
+	 * on any thread until the slot is given back */
+	tex2d->unpack_held[*slot] = true;
+	*ptr = tex2d->unpack_ptr + *slot * tex2d->unpack_slot_size;
+	*linesize = unpack_linesize(tex2d);
+	return true;
+}
+
+void gs_texture_unmap_slot(gs_texture_t *tex, uint32_t slot)
+{
+	struct gs_texture_2d *tex2d = (struct gs_texture_2d *)tex;
+
+	if (!is_texture_2d(tex, "gs_texture_unmap_slot") || slot >= GL_UNPACK_RING_SIZE || !tex2d->unpack_held[slot])
+		return;
+
+	tex2d->unpack_held[slot] = false;
+	tex2d->unpack_slot = slot;
+
+	if (!upload_unpack_slot(tex2d, slot))
+		blog(LOG_ERROR, "gs_texture_unmap_slot (GL) failed");
+}
+
+void gs_texture_release_slot(gs_texture_t *tex, uint32_t slot)
+{
+	struct gs_texture_2d *tex2d = (struct gs_texture_2d *)tex;
+
+	if (!is_texture_2d(tex, "gs_texture_release_slot") || slot >= GL_UNPACK_RING_SIZE)
+		return;
+
+	tex2d->unpack_held[slot] = false;
+}
+
 bool gs_texture_is_rect(const gs_texture_t *tex)
 {
 	if (tex->type == GS_TEXTURE_3D)
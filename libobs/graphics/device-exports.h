@@ -129,6 +129,7 @@ EXPORT void device_projection_pop(gs_device_t *device);
 EXPORT void device_debug_marker_begin(gs_device_t *device, const char *markername, const float color[4]);
 EXPORT void device_debug_marker_end(gs_device_t *device);
 EXPORT bool device_is_monitor_hdr(gs_device_t *device, void *monitor);
+EXPORT void device_set_cache_path(gs_device_t *device, const char *path);
 EXPORT bool device_shared_texture_available(void);
 EXPORT bool device_nv12_available(gs_device_t *device);
 EXPORT bool device_p010_available(gs_device_t *device);
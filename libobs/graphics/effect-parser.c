@@ -1793,7 +1793,7 @@ static void ep_compile_param(struct effect_parser *ep, size_t idx)
 }
 
 static bool ep_compile_pass_shaderparams(struct effect_parser *ep, pass_shaderparam_array_t *pass_params,
-					 dstr_array_t *used_params, gs_shader_t *shader)
+					 dstr_array_t *used_params)
 {
 	size_t i;
 	da_resize(*pass_params, used_params->num);
@@ -1802,15 +1802,16 @@ static bool ep_compile_pass_shaderparams(struct effect_parser *ep, pass_shaderpa
 		struct dstr *param_name = used_params->array + i;
 		struct pass_shaderparam *param = pass_params->array + i;
 
+		/* the shader param is looked up once the shader is compiled */
 		param->eparam = gs_effect_get_param_by_name(ep->effect, param_name->array);
-		param->sparam = gs_shader_get_param_by_name(shader, param_name->array);
+		param->sparam = NULL;
 
 #if defined(_DEBUG) && defined(_DEBUG_SHADERS)
 		debug_param(param->eparam, 0, i, "\t\t\t\t");
 #endif
 
-		if (!param->sparam) {
-			blog(LOG_ERROR, "Effect shader parameter not found");
+		if (!param->eparam) {
+			blog(LOG_ERROR, "Effect parameter not found");
 			return false;
 		}
 	}
@@ -1818,54 +1819,25 @@ static bool ep_compile_pass_shaderparams(struct effect_parser *ep, pass_shaderpa
 	return true;
 }
 
-static inline bool ep_compile_pass_shader(struct effect_parser *ep, struct gs_effect_technique *tech,
-					  struct gs_effect_pass *pass, struct ep_pass *pass_in, size_t pass_idx,
-					  enum gs_shader_type type)
+static inline bool ep_compile_pass_shader(struct effect_parser *ep, struct gs_effect_pass *pass,
+					  struct ep_pass *pass_in, enum gs_shader_type type)
 {
 	struct dstr shader_str;
-	struct dstr location;
 	dstr_array_t used_params;
 	pass_shaderparam_array_t *pass_params = NULL;
-	gs_shader_t *shader = NULL;
 	bool success = true;
-	char *errors = NULL;
 
 	dstr_init(&shader_str);
 	da_init(used_params);
-	dstr_init(&location);
-
-	dstr_copy(&location, ep->cfp.lex.file);
-	if (type == GS_SHADER_VERTEX)
-		dstr_cat(&location, " (Vertex ");
-	else if (type == GS_SHADER_PIXEL)
-		dstr_cat(&location, " (Pixel ");
-	/*else if (type == SHADER_GEOMETRY)
-		dstr_cat(&location, " (Geometry ");*/
-
-	assert(pass_idx <= UINT_MAX);
-	dstr_catf(&location, "shader, technique %s, pass %u)", tech->name, (unsigned)pass_idx);
 
 	if (type == GS_SHADER_VERTEX) {
 		ep_makeshaderstring(ep, &shader_str, &pass_in->vertex_program, &used_params);
-
-		pass->vertshader = gs_vertexshader_create(shader_str.array, location.array, &errors);
-
-		shader = pass->vertshader;
 		pass_params = &pass->vertshader_params;
 	} else if (type == GS_SHADER_PIXEL) {
 		ep_makeshaderstring(ep, &shader_str, &pass_in->fragment_program, &used_params);
-
-		pass->pixelshader = gs_pixelshader_create(shader_str.array, location.array, &errors);
-
-		shader = pass->pixelshader;
 		pass_params = &pass->pixelshader_params;
 	}
 
-	if (errors && strlen(errors)) {
-		cf_adderror(&ep->cfp, "Error creating shader: $1", LEX_ERROR, errors, NULL, NULL);
-	}
-	bfree(errors);
-
 #if defined(_DEBUG) && defined(_DEBUG_SHADERS)
 	blog(LOG_DEBUG, "\t\t\t%s Shader:", type == GS_SHADER_VERTEX ? "Vertex" : "Fragment");
 	blog(LOG_DEBUG, "\t\t\tCode:");
@@ -1873,15 +1845,21 @@ static inline bool ep_compile_pass_shader(struct effect_parser *ep, struct gs_ef
 	blog(LOG_DEBUG, "\t\t\tParameters:");
 #endif
 
-	if (shader)
-		success = ep_compile_pass_shaderparams(ep, pass_params, &used_params, shader);
+	if (pass_params && !dstr_is_empty(&shader_str))
+		success = ep_compile_pass_shaderparams(ep, pass_params, &used_params);
 	else
 		success = false;
 
-	dstr_free(&location);
+	/* ownership of the string moves to the pass */
+	if (success && type == GS_SHADER_VERTEX)
+		pass->vertshader_src = shader_str.array;
+	else if (success && type == GS_SHADER_PIXEL)
+		pass->pixelshader_src = shader_str.array;
+	else
+		dstr_free(&shader_str);
+
 	dstr_array_free(used_params.array, used_params.num);
 	da_free(used_params);
-	dstr_free(&shader_str);
 
 	return success;
 }
@@ -1903,14 +1881,26 @@ static bool ep_compile_pass(struct effect_parser *ep, struct gs_effect_technique
 	blog(LOG_DEBUG, "\t\t[%4lld] Pass '%s':", idx, pass->name);
 #endif
 
-	if (!ep_compile_pass_shader(ep, tech, pass, pass_in, idx, GS_SHADER_VERTEX)) {
+	if (!ep_compile_pass_shader(ep, pass, pass_in, GS_SHADER_VERTEX)) {
 		success = false;
 		blog(LOG_ERROR, "Pass (%zu) <%s> missing vertex shader!", idx, pass->name ? pass->name : "");
 	}
-	if (!ep_compile_pass_shader(ep, tech, pass, pass_in, idx, GS_SHADER_PIXEL)) {
+	if (!ep_compile_pass_shader(ep, pass, pass_in, GS_SHADER_PIXEL)) {
 		success = false;
 		blog(LOG_ERROR, "Pass (%zu) <%s> missing pixel shader!", idx, pass->name ? pass->name : "");
 	}
+
+	/* Shaders are normally compiled on first use of the pass, unless the
+	 * caller wants compile errors reported right away */
+	if (success && ep->compile_shaders) {
+		char *errors = NULL;
+
+		success = effect_pass_compile(tech, pass, &errors);
+		if (errors && *errors)
+			cf_adderror(&ep->cfp, "Error creating shader: $1", LEX_ERROR, errors, NULL, NULL);
+		bfree(errors);
+	}
+
 	return success;
 }
 
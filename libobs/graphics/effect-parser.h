@@ -264,6 +264,9 @@ struct effect_parser {
 	cf_token_array_t tokens;
 	struct gs_effect_pass *cur_pass;
 
+	/* compile shaders while parsing instead of on first use */
+	bool compile_shaders;
+
 	struct cf_parser cfp;
 };
 
@@ -278,6 +281,7 @@ static inline void ep_init(struct effect_parser *ep)
 	da_init(ep->tokens);
 
 	ep->cur_pass = NULL;
+	ep->compile_shaders = false;
 	cf_parser_init(&ep->cfp);
 }
 
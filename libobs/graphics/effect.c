@@ -192,6 +192,143 @@ void gs_effect_update_params(gs_effect_t *effect)
 		upload_parameters(effect, true);
 }
 
+static gs_shader_t *compile_pass_shader(struct gs_effect_technique *tech, struct gs_effect_pass *pass,
+				       enum gs_shader_type type, char **errors)
+{
+	const char *file = tech->effect->effect_path ? tech->effect->effect_path : "(string)";
+	size_t idx = pass - tech->passes.array;
+	pass_shaderparam_array_t *params;
+	gs_shader_t *shader;
+	struct dstr location = {0};
+
+	dstr_printf(&location, "%s (%s shader, technique %s, pass %u)", file,
+		    type == GS_SHADER_VERTEX ? "Vertex" : "Pixel", tech->name, (unsigned)idx);
+
+	if (type == GS_SHADER_VERTEX) {
+		shader = gs_vertexshader_create(pass->vertshader_src, location.array, errors);
+		params = &pass->vertshader_params;
+	} else {
+		shader = gs_pixelshader_create(pass->pixelshader_src, location.array, errors);
+		params = &pass->pixelshader_params;
+	}
+
+	dstr_free(&location);
+
+	if (!shader)
+		return NULL;
+
+	for (size_t i = 0; i < params->num; i++) {
+		struct pass_shaderparam *param = params->array + i;
+
+		param->sparam = gs_shader_get_param_by_name(shader, param->eparam->name);
+		if (!param->sparam) {
+			blog(LOG_ERROR, "Effect shader parameter not found");
+			gs_shader_destroy(shader);
+			return NULL;
+		}
+	}
+
+	return shader;
+}
+
+/* Effects only generate shader source when parsed, the shaders of each pass
+ * are created the first time the pass is used so effects that are loaded but
+ * never drawn with cost neither compile time nor GPU memory. */
+bool effect_pass_compile(struct gs_effect_technique *tech, struct gs_effect_pass *pass, char **errors)
+{
+	char *vs_errors = NULL;
+	char *ps_errors = NULL;
+
+	if (!effect_pass_pending(pass))
+		return !pass->compile_failed;
+
+	pass->vertshader = compile_pass_shader(tech, pass, GS_SHADER_VERTEX, &vs_errors);
+	if (pass->vertshader)
+		pass->pixelshader = compile_pass_shader(tech, pass, GS_SHADER_PIXEL, &ps_errors);
+
+	if (!pass->vertshader || !pass->pixelshader) {
+		gs_shader_destroy(pass->vertshader);
+		pass->vertshader = NULL;
+		pass->compile_failed = true;
+	}
+
+	if (errors) {
+		struct dstr str = {0};
+		if (vs_errors && *vs_errors)
+			dstr_cat(&str, vs_errors);
+		if (ps_errors && *ps_errors)
+			dstr_cat(&str, ps_errors);
+		*errors = str.array;
+	} else if (pass->compile_failed) {
+		blog(LOG_ERROR, "Failed to compile technique '%s' pass %u of effect '%s':\n%s%s", tech->name,
+		     (unsigned)(pass - tech->passes.array), tech->effect->effect_path ? tech->effect->effect_path : "",
+		     vs_errors ? vs_errors : "", ps_errors ? ps_errors : "");
+	}
+
+	bfree(vs_errors);
+	bfree(ps_errors);
+
+	bfree(pass->vertshader_src);
+	bfree(pass->pixelshader_src);
+	pass->vertshader_src = NULL;
+	pass->pixelshader_src = NULL;
+
+	return !pass->compile_failed;
+}
+
+bool effect_compile_passes(gs_effect_t *effect, char **error_string)
+{
+	for (size_t i = 0; i < effect->techniques.num; i++) {
+		struct gs_effect_technique *tech = effect->techniques.array + i;
+
+		for (size_t j = 0; j < tech->passes.num; j++) {
+			struct gs_effect_pass *pass = tech->passes.array + j;
+			char *errors = NULL;
+			bool success;
+
+			success = effect_pass_compile(tech, pass, error_string ? &errors : NULL);
+			if (!success && error_string)
+				*error_string = errors;
+			else
+				bfree(errors);
+			if (!success)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+bool gs_effect_compile_next(void)
+{
+	graphics_t *graphics = gs_get_context();
+	bool compiled = false;
+
+	if (!graphics)
+		return false;
+
+	pthread_mutex_lock(&graphics->effect_mutex);
+
+	for (gs_effect_t *effect = graphics->first_effect; effect && !compiled; effect = effect->next) {
+		for (size_t i = 0; i < effect->techniques.num && !compiled; i++) {
+			struct gs_effect_technique *tech = effect->techniques.array + i;
+
+			for (size_t j = 0; j < tech->passes.num; j++) {
+				struct gs_effect_pass *pass = tech->passes.array + j;
+
+				if (effect_pass_pending(pass)) {
+					effect_pass_compile(tech, pass, NULL);
+					compiled = true;
+					break;
+				}
+			}
+		}
+	}
+
+	pthread_mutex_unlock(&graphics->effect_mutex);
+	return compiled;
+}
+
 bool gs_technique_begin_pass(gs_technique_t *tech, size_t idx)
 {
 	struct gs_effect_pass *passes;
@@ -203,6 +340,9 @@ bool gs_technique_begin_pass(gs_technique_t *tech, size_t idx)
 	passes = tech->passes.array;
 	cur_pass = passes + idx;
 
+	if (!effect_pass_compile(tech, cur_pass, NULL))
+		return false;
+
 	tech->effect->cur_pass = cur_pass;
 	gs_load_vertexshader(cur_pass->vertshader);
 	gs_load_pixelshader(cur_pass->pixelshader);
@@ -218,10 +358,8 @@ bool gs_technique_begin_pass_by_name(gs_technique_t *tech, const char *name)
 
 	for (size_t i = 0; i < tech->passes.num; i++) {
 		struct gs_effect_pass *pass = tech->passes.array + i;
-		if (strcmp(pass->name, name) == 0) {
-			gs_technique_begin_pass(tech, i);
-			return true;
-		}
+		if (strcmp(pass->name, name) == 0)
+			return gs_technique_begin_pass(tech, i);
 	}
 
 	return false;
@@ -99,6 +99,11 @@ struct gs_effect_pass {
 	gs_shader_t *pixelshader;
 	pass_shaderparam_array_t vertshader_params;
 	pass_shaderparam_array_t pixelshader_params;
+
+	/* generated shader source, kept until the pass is first used */
+	char *vertshader_src;
+	char *pixelshader_src;
+	bool compile_failed;
 };
 
 static inline void effect_pass_init(struct gs_effect_pass *pass)
@@ -111,6 +116,8 @@ static inline void effect_pass_free(struct gs_effect_pass *pass)
 	bfree(pass->name);
 	da_free(pass->vertshader_params);
 	da_free(pass->pixelshader_params);
+	bfree(pass->vertshader_src);
+	bfree(pass->pixelshader_src);
 
 	gs_shader_destroy(pass->vertshader);
 	gs_shader_destroy(pass->pixelshader);
@@ -163,6 +170,14 @@ struct gs_effect {
 	bool looping;
 };
 
+static inline bool effect_pass_pending(const struct gs_effect_pass *pass)
+{
+	return pass->vertshader_src && !pass->compile_failed;
+}
+
+extern bool effect_pass_compile(struct gs_effect_technique *tech, struct gs_effect_pass *pass, char **errors);
+extern bool effect_compile_passes(gs_effect_t *effect, char **error_string);
+
 static inline void effect_init(gs_effect_t *effect)
 {
 	memset(effect, 0, sizeof(struct gs_effect));
@@ -139,6 +139,9 @@ struct gs_exports {
 	enum gs_color_format (*gs_texture_get_color_format)(const gs_texture_t *tex);
 	bool (*gs_texture_map)(gs_texture_t *tex, uint8_t **ptr, uint32_t *linesize);
 	void (*gs_texture_unmap)(gs_texture_t *tex);
+	bool (*gs_texture_map_slot)(gs_texture_t *tex, uint32_t *slot, uint8_t **ptr, uint32_t *linesize);
+	void (*gs_texture_unmap_slot)(gs_texture_t *tex, uint32_t slot);
+	void (*gs_texture_release_slot)(gs_texture_t *tex, uint32_t slot);
 	bool (*gs_texture_is_rect)(const gs_texture_t *tex);
 	void *(*gs_texture_get_obj)(const gs_texture_t *tex);
 
@@ -212,6 +215,7 @@ struct gs_exports {
 					   uint32_t width, uint32_t height, uint32_t flags);
 
 	bool (*device_is_monitor_hdr)(gs_device_t *device, void *monitor);
+	void (*device_set_cache_path)(gs_device_t *device, const char *path);
 
 	void (*device_debug_marker_begin)(gs_device_t *device, const char *markername, const float color[4]);
 	void (*device_debug_marker_end)(gs_device_t *device);
@@ -297,6 +301,23 @@ struct blend_state {
 	enum gs_blend_op_type op;
 };
 
+struct pooled_texture {
+	gs_texture_t *tex;
+	uint32_t cx, cy;
+	enum gs_color_format format;
+	uint32_t flags;
+	uint64_t released_ns;
+};
+
+struct texture_pool {
+	DARRAY(struct pooled_texture) free;
+	DARRAY(struct pooled_texture) used;
+	uint64_t free_bytes;
+	uint64_t used_bytes;
+	uint64_t hits;
+	uint64_t misses;
+};
+
 struct graphics_subsystem {
 	void *module;
 	gs_device_t *device;
@@ -331,5 +352,7 @@ struct graphics_subsystem {
 	struct blend_state cur_blend_state;
 	DARRAY(struct blend_state) blend_state_stack;
 
+	struct texture_pool texture_pool;
+
 	bool linear_srgb;
 };
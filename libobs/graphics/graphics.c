@@ -230,6 +230,7 @@ error:
 }
 
 extern void gs_effect_actually_destroy(gs_effect_t *effect);
+extern void texture_pool_free(graphics_t *graphics);
 
 void gs_destroy(graphics_t *graphics)
 {
@@ -251,6 +252,8 @@ void gs_destroy(graphics_t *graphics)
 			effect = next;
 		}
 
+		texture_pool_free(graphics);
+
 		graphics->exports.gs_vertexbuffer_destroy(graphics->subregion_buffer);
 		graphics->exports.gs_vertexbuffer_destroy(graphics->flipped_sprite_buffer);
 		graphics->exports.gs_vertexbuffer_destroy(graphics->sprite_buffer);
@@ -835,35 +838,8 @@ static inline struct gs_effect *find_cached_effect(const char *filename)
 	return effect;
 }
 
-gs_effect_t *gs_effect_create_from_file(const char *file, char **error_string)
-{
-	char *file_string;
-	gs_effect_t *effect = NULL;
-
-	if (!gs_valid_p("gs_effect_create_from_file", file))
-		return NULL;
-
-	effect = find_cached_effect(file);
-	if (effect)
-		return effect;
-
-	file_string = os_quick_read_utf8_file(file);
-	if (!file_string) {
-		blog(LOG_ERROR, "Could not load effect file '%s'", file);
-		return NULL;
-	}
-
-	effect = gs_effect_create(file_string, file, error_string);
-	bfree(file_string);
-
-	return effect;
-}
-
-gs_effect_t *gs_effect_create(const char *effect_string, const char *filename, char **error_string)
+static gs_effect_t *effect_create(const char *effect_string, const char *filename, char **error_string, bool lazy)
 {
-	if (!gs_valid_p("gs_effect_create", effect_string))
-		return NULL;
-
 	struct gs_effect *effect = bzalloc(sizeof(struct gs_effect));
 	struct effect_parser parser;
 	bool success;
@@ -872,6 +848,7 @@ gs_effect_t *gs_effect_create(const char *effect_string, const char *filename, c
 	effect->effect_path = bstrdup(filename);
 
 	ep_init(&parser);
+	parser.compile_shaders = !lazy;
 	success = ep_parse(&parser, effect, effect_string, filename);
 	if (!success) {
 		if (error_string)
@@ -896,6 +873,55 @@ gs_effect_t *gs_effect_create(const char *effect_string, const char *filename, c
 	return effect;
 }
 
+static gs_effect_t *effect_create_from_file(const char *file, char **error_string, bool lazy)
+{
+	char *file_string;
+	gs_effect_t *effect = NULL;
+
+	effect = find_cached_effect(file);
+	if (effect) {
+		/* the cached effect may have been created lazily */
+		if (!lazy && !effect_compile_passes(effect, error_string))
+			return NULL;
+		return effect;
+	}
+
+	file_string = os_quick_read_utf8_file(file);
+	if (!file_string) {
+		blog(LOG_ERROR, "Could not load effect file '%s'", file);
+		return NULL;
+	}
+
+	effect = effect_create(file_string, file, error_string, lazy);
+	bfree(file_string);
+
+	return effect;
+}
+
+gs_effect_t *gs_effect_create_from_file(const char *file, char **error_string)
+{
+	if (!gs_valid_p("gs_effect_create_from_file", file))
+		return NULL;
+
+	return effect_create_from_file(file, error_string, false);
+}
+
+gs_effect_t *gs_effect_create_from_file_lazy(const char *file, char **error_string)
+{
+	if (!gs_valid_p("gs_effect_create_from_file_lazy", file))
+		return NULL;
+
+	return effect_create_from_file(file, error_string, true);
+}
+
+gs_effect_t *gs_effect_create(const char *effect_string, const char *filename, char **error_string)
+{
+	if (!gs_valid_p("gs_effect_create", effect_string))
+		return NULL;
+
+	return effect_create(effect_string, filename, error_string, false);
+}
+
 gs_shader_t *gs_vertexshader_create_from_file(const char *file, char **error_string)
 {
 	if (!gs_valid_p("gs_vertexshader_create_from_file", file))
@@ -1300,6 +1326,24 @@ void gs_reset_blend_state(void)
 	}
 }
 
+bool gs_get_blend_function(enum gs_blend_type *src_c, enum gs_blend_type *dest_c, enum gs_blend_type *src_a,
+			   enum gs_blend_type *dest_a, enum gs_blend_op_type *op)
+{
+	graphics_t *graphics = thread_graphics;
+	const struct blend_state *state;
+
+	if (!gs_valid("gs_get_blend_function"))
+		return false;
+
+	state = &graphics->cur_blend_state;
+	*src_c = state->src_c;
+	*dest_c = state->dest_c;
+	*src_a = state->src_a;
+	*dest_a = state->dest_a;
+	*op = state->op;
+	return state->enabled;
+}
+
 /* ------------------------------------------------------------------------- */
 
 const char *gs_preprocessor_name(void)
@@ -2477,6 +2521,41 @@ void gs_texture_unmap(gs_texture_t *tex)
 	graphics->exports.gs_texture_unmap(tex);
 }
 
+bool gs_texture_map_slot(gs_texture_t *tex, uint32_t *slot, uint8_t **ptr, uint32_t *linesize)
+{
+	graphics_t *graphics = thread_graphics;
+
+	if (!gs_valid_p3("gs_texture_map_slot", tex, ptr, linesize) || !slot)
+		return false;
+
+	if (graphics->exports.gs_texture_map_slot)
+		return graphics->exports.gs_texture_map_slot(tex, slot, ptr, linesize);
+	else
+		return false;
+}
+
+void gs_texture_unmap_slot(gs_texture_t *tex, uint32_t slot)
+{
+	graphics_t *graphics = thread_graphics;
+
+	if (!gs_valid_p("gs_texture_unmap_slot", tex))
+		return;
+
+	if (graphics->exports.gs_texture_unmap_slot)
+		graphics->exports.gs_texture_unmap_slot(tex, slot);
+}
+
+void gs_texture_release_slot(gs_texture_t *tex, uint32_t slot)
+{
+	graphics_t *graphics = thread_graphics;
+
+	if (!gs_valid_p("gs_texture_release_slot", tex))
+		return;
+
+	if (graphics->exports.gs_texture_release_slot)
+		graphics->exports.gs_texture_release_slot(tex, slot);
+}
+
 bool gs_texture_is_rect(const gs_texture_t *tex)
 {
 	graphics_t *graphics = thread_graphics;
@@ -2872,6 +2951,16 @@ bool gs_is_monitor_hdr(void *monitor)
 	return thread_graphics->exports.device_is_monitor_hdr(thread_graphics->device, monitor);
 }
 
+void gs_set_cache_path(const char *path)
+{
+	if (!gs_valid("gs_set_cache_path"))
+		return;
+	if (!thread_graphics->exports.device_set_cache_path)
+		return;
+
+	thread_graphics->exports.device_set_cache_path(thread_graphics->device, path);
+}
+
 void gs_debug_marker_begin(const float color[4], const char *markername)
 {
 	if (!gs_valid("gs_debug_marker_begin"))
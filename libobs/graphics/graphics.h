@@ -415,6 +415,10 @@ EXPORT bool gs_effect_loop(gs_effect_t *effect, const char *name);
 /** used internally */
 EXPORT void gs_effect_update_params(gs_effect_t *effect);
 
+/** Compiles one effect pass whose shaders have not been used yet.  Returns
+ * false once there is nothing left to compile. */
+EXPORT bool gs_effect_compile_next(void);
+
 EXPORT gs_eparam_t *gs_effect_get_viewproj_matrix(const gs_effect_t *effect);
 EXPORT gs_eparam_t *gs_effect_get_world_matrix(const gs_effect_t *effect);
 
@@ -445,6 +449,23 @@ EXPORT void gs_effect_set_color(gs_eparam_t *param, uint32_t argb);
  * texture render helper functions
  * --------------------------------------------------- */
 
+struct gs_texture_pool_stats {
+	size_t used_count;
+	size_t free_count;
+	uint64_t used_bytes;
+	uint64_t free_bytes;
+	uint64_t hits;
+	uint64_t misses;
+};
+
+/** Gets a texture from the pool, or creates one if none matches */
+EXPORT gs_texture_t *gs_texture_pool_acquire(uint32_t cx, uint32_t cy, enum gs_color_format format, uint32_t flags);
+/** Returns a texture to the pool, textures not from the pool are destroyed */
+EXPORT void gs_texture_pool_release(gs_texture_t *tex);
+/** Destroys pooled textures that have not been reused for max_age_ns */
+EXPORT void gs_texture_pool_trim(uint64_t max_age_ns);
+EXPORT void gs_texture_pool_get_stats(struct gs_texture_pool_stats *stats);
+
 EXPORT gs_texrender_t *gs_texrender_create(enum gs_color_format format, enum gs_zstencil_format zsformat);
 EXPORT void gs_texrender_destroy(gs_texrender_t *texrender);
 EXPORT bool gs_texrender_begin(gs_texrender_t *texrender, uint32_t cx, uint32_t cy);
@@ -552,6 +573,9 @@ EXPORT input_t *gs_get_input(void);
 EXPORT gs_effect_t *gs_get_effect(void);
 
 EXPORT gs_effect_t *gs_effect_create_from_file(const char *file, char **error_string);
+/** Like gs_effect_create_from_file, but shaders are only compiled the first
+ * time a pass is used, so shader errors do not make this return NULL */
+EXPORT gs_effect_t *gs_effect_create_from_file_lazy(const char *file, char **error_string);
 EXPORT gs_effect_t *gs_effect_create(const char *effect_string, const char *filename, char **error_string);
 
 EXPORT gs_shader_t *gs_vertexshader_create_from_file(const char *file, char **error_string);
@@ -610,6 +634,8 @@ EXPORT void gs_perspective(float fovy, float aspect, float znear, float zfar);
 EXPORT void gs_blend_state_push(void);
 EXPORT void gs_blend_state_pop(void);
 EXPORT void gs_reset_blend_state(void);
+EXPORT bool gs_get_blend_function(enum gs_blend_type *src_c, enum gs_blend_type *dest_c, enum gs_blend_type *src_a,
+				  enum gs_blend_type *dest_a, enum gs_blend_op_type *op);
 
 /* -------------------------- */
 /* library-specific functions */
@@ -732,6 +758,17 @@ EXPORT uint32_t gs_texture_get_height(const gs_texture_t *tex);
 EXPORT enum gs_color_format gs_texture_get_color_format(const gs_texture_t *tex);
 EXPORT bool gs_texture_map(gs_texture_t *tex, uint8_t **ptr, uint32_t *linesize);
 EXPORT void gs_texture_unmap(gs_texture_t *tex);
+/**
+ * Hands out a slot of a dynamic texture's upload memory that stays mapped
+ * until it is passed to gs_texture_unmap_slot or gs_texture_release_slot, so
+ * it can be filled from any thread in the meantime.  Only available where
+ * uploads go through persistently mapped memory (GL with buffer storage).
+ */
+EXPORT bool gs_texture_map_slot(gs_texture_t *tex, uint32_t *slot, uint8_t **ptr, uint32_t *linesize);
+/** Copies a slot from gs_texture_map_slot into the texture */
+EXPORT void gs_texture_unmap_slot(gs_texture_t *tex, uint32_t slot);
+/** Returns a slot from gs_texture_map_slot without using it */
+EXPORT void gs_texture_release_slot(gs_texture_t *tex, uint32_t slot);
 /** special-case function (GL only) - specifies whether the texture is a
  * GL_TEXTURE_RECTANGLE type, which doesn't use normalized texture
  * coordinates, doesn't support mipmapping, and requires address clamping */
@@ -793,6 +830,9 @@ EXPORT bool gs_texture_create_p010(gs_texture_t **tex_y, gs_texture_t **tex_uv,
 
 EXPORT bool gs_is_monitor_hdr(void *monitor);
 
+/** Sets the directory the device may cache compiled shaders in (optional) */
+EXPORT void gs_set_cache_path(const char *path);
+
 #define GS_USE_DEBUG_MARKERS 0
 #if GS_USE_DEBUG_MARKERS
 static const float GS_DEBUG_COLOR_DEFAULT[] = {0.5f, 0.5f, 0.5f, 1.0f};
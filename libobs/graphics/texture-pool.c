@@ -0,0 +1,144 @@
+/******************************************************************************
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+/*
+ *   Recycles textures by size, format and flags.  Render targets are
+ * created and destroyed constantly (texrenders resizing, filters being
+ * toggled, async sources changing format), and each of those is a driver
+ * allocation.  Released textures are kept around for a while and handed out
+ * again to the next request with the same description.
+ */
+
+#include "../util/platform.h"
+#include "graphics-internal.h"
+
+static inline uint64_t texture_size(const struct pooled_texture *pt)
+{
+	return (uint64_t)pt->cx * pt->cy * gs_get_format_bpp(pt->format) / 8;
+}
+
+gs_texture_t *gs_texture_pool_acquire(uint32_t cx, uint32_t cy, enum gs_color_format format, uint32_t flags)
+{
+	graphics_t *graphics = gs_get_context();
+	struct texture_pool *pool;
+	struct pooled_texture pt = {NULL, cx, cy, format, flags, 0};
+
+	if (!graphics || !cx || !cy)
+		return NULL;
+
+	pool = &graphics->texture_pool;
+
+	/* most recently released textures are at the back */
+	for (size_t i = pool->free.num; i > 0; i--) {
+		struct pooled_texture *entry = pool->free.array + (i - 1);
+
+		if (entry->cx == cx && entry->cy == cy && entry->format == format && entry->flags == flags) {
+			pt.tex = entry->tex;
+			da_erase(pool->free, i - 1);
+			pool->free_bytes -= texture_size(&pt);
+			pool->hits++;
+			break;
+		}
+	}
+
+	if (!pt.tex) {
+		pt.tex = gs_texture_create(cx, cy, format, 1, NULL, flags);
+		if (!pt.tex)
+			return NULL;
+		pool->misses++;
+	}
+
+	da_push_back(pool->used, &pt);
+	pool->used_bytes += texture_size(&pt);
+	return pt.tex;
+}
+
+void gs_texture_pool_release(gs_texture_t *tex)
+{
+	graphics_t *graphics = gs_get_context();
+	struct texture_pool *pool;
+
+	if (!graphics || !tex)
+		return;
+
+	pool = &graphics->texture_pool;
+
+	for (size_t i = 0; i < pool->used.num; i++) {
+		struct pooled_texture pt = pool->used.array[i];
+
+		if (pt.tex == tex) {
+			da_erase(pool->used, i);
+			pool->used_bytes -= texture_size(&pt);
+
+			pt.released_ns = os_gettime_ns();
+			da_push_back(pool->free, &pt);
+			pool->free_bytes += texture_size(&pt);
+			return;
+		}
+	}
+
+	/* not from the pool */
+	gs_texture_destroy(tex);
+}
+
+void gs_texture_pool_trim(uint64_t max_age_ns)
+{
+	graphics_t *graphics = gs_get_context();
+	struct texture_pool *pool;
+	uint64_t now = os_gettime_ns();
+
+	if (!graphics)
+		return;
+
+	pool = &graphics->texture_pool;
+
+	for (size_t i = pool->free.num; i > 0; i--) {
+		struct pooled_texture *entry = pool->free.array + (i - 1);
+
+		if (now - entry->released_ns >= max_age_ns) {
+			pool->free_bytes -= texture_size(entry);
+			gs_texture_destroy(entry->tex);
+			da_erase(pool->free, i - 1);
+		}
+	}
+}
+
+void gs_texture_pool_get_stats(struct gs_texture_pool_stats *stats)
+{
+	graphics_t *graphics = gs_get_context();
+	struct texture_pool *pool;
+
+	if (!graphics || !stats)
+		return;
+
+	pool = &graphics->texture_pool;
+	stats->used_count = pool->used.num;
+	stats->used_bytes = pool->used_bytes;
+	stats->free_count = pool->free.num;
+	stats->free_bytes = pool->free_bytes;
+	stats->hits = pool->hits;
+	stats->misses = pool->misses;
+}
+
+void texture_pool_free(graphics_t *graphics)
+{
+	struct texture_pool *pool = &graphics->texture_pool;
+
+	for (size_t i = 0; i < pool->free.num; i++)
+		graphics->exports.gs_texture_destroy(pool->free.array[i].tex);
+
+	da_free(pool->free);
+	da_free(pool->used);
+}
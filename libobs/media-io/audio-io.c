@@ -77,6 +77,10 @@ struct audio_output {
 	void *input_param;
 	pthread_mutex_t input_mutex;
 	struct audio_mix mixes[MAX_AUDIO_MIXES];
+
+	pthread_mutex_t clock_mutex;
+	audio_clock_callback_t clock_cb;
+	void *clock_param;
 };
 
 /* ------------------------------------------------------------------------- */
@@ -202,6 +206,20 @@ static void input_and_output(struct audio_output *audio, uint64_t audio_time, ui
 		do_audio_output(audio, i, new_ts, AUDIO_OUTPUT_FRAMES);
 }
 
+static enum audio_clock_state audio_sleepto(struct audio_output *audio, uint64_t audio_time)
+{
+	enum audio_clock_state state = AUDIO_CLOCK_DUE;
+
+	pthread_mutex_lock(&audio->clock_mutex);
+	if (audio->clock_cb)
+		state = audio->clock_cb(audio->clock_param, audio_time);
+	else
+		os_sleepto_ns_fast(audio_time);
+	pthread_mutex_unlock(&audio->clock_mutex);
+
+	return state;
+}
+
 static void *audio_thread(void *param)
 {
 #ifdef _WIN32
@@ -221,10 +239,21 @@ static void *audio_thread(void *param)
 		profile_store_name(obs_get_profiler_name_store(), "audio_thread(%s)", audio->info.name);
 
 	while (os_event_try(audio->stop_event) == EAGAIN) {
-		samples += AUDIO_OUTPUT_FRAMES;
-		uint64_t audio_time = start_time + audio_frames_to_ns(rate, samples);
+		uint64_t audio_time = start_time + audio_frames_to_ns(rate, samples + AUDIO_OUTPUT_FRAMES);
 
-		os_sleepto_ns_fast(audio_time);
+		switch (audio_sleepto(audio, audio_time)) {
+		case AUDIO_CLOCK_DUE:
+			break;
+		case AUDIO_CLOCK_WAIT:
+			continue;
+		case AUDIO_CLOCK_RESET:
+			start_time = os_gettime_ns();
+			prev_time = start_time;
+			samples = 0;
+			continue;
+		}
+
+		samples += AUDIO_OUTPUT_FRAMES;
 
 		profile_start(audio_thread_name);
 
@@ -371,17 +400,21 @@ int audio_output_open(audio_t **audio, struct audio_output_info *info)
 
 	if (pthread_mutex_init_recursive(&out->input_mutex) != 0)
 		goto fail0;
-	if (os_event_init(&out->stop_event, OS_EVENT_TYPE_MANUAL) != 0)
+	if (pthread_mutex_init(&out->clock_mutex, NULL) != 0)
 		goto fail1;
-	if (pthread_create(&out->thread, NULL, audio_thread, out) != 0)
+	if (os_event_init(&out->stop_event, OS_EVENT_TYPE_MANUAL) != 0)
 		goto fail2;
+	if (pthread_create(&out->thread, NULL, audio_thread, out) != 0)
+		goto fail3;
 
 	out->initialized = true;
 	*audio = out;
 	return AUDIO_OUTPUT_SUCCESS;
 
-fail2:
+fail3:
 	os_event_destroy(out->stop_event);
+fail2:
+	pthread_mutex_destroy(&out->clock_mutex);
 fail1:
 	pthread_mutex_destroy(&out->input_mutex);
 fail0:
@@ -389,6 +422,17 @@ fail0:
 	return AUDIO_OUTPUT_FAIL;
 }
 
+void audio_output_set_clock(audio_t *audio, audio_clock_callback_t callback, void *param)
+{
+	if (!audio)
+		return;
+
+	pthread_mutex_lock(&audio->clock_mutex);
+	audio->clock_cb = callback;
+	audio->clock_param = param;
+	pthread_mutex_unlock(&audio->clock_mutex);
+}
+
 void audio_output_close(audio_t *audio)
 {
 	void *thread_ret;
@@ -400,6 +444,7 @@ void audio_output_close(audio_t *audio)
 		os_event_signal(audio->stop_event);
 		pthread_join(audio->thread, &thread_ret);
 		os_event_destroy(audio->stop_event);
+		pthread_mutex_destroy(&audio->clock_mutex);
 		pthread_mutex_destroy(&audio->input_mutex);
 	}
 
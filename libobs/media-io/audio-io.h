@@ -209,6 +209,22 @@ static inline uint64_t ns_to_audio_frames(size_t sample_rate, uint64_t frames)
 EXPORT int audio_output_open(audio_t **audio, struct audio_output_info *info);
 EXPORT void audio_output_close(audio_t *audio);
 
+enum audio_clock_state {
+	AUDIO_CLOCK_DUE,
+	AUDIO_CLOCK_WAIT,
+	AUDIO_CLOCK_RESET,
+};
+
+/**
+ * Replaces the system clock the audio thread is paced by.  The callback is
+ * asked whether the tick at audio_time is due, and may block for a short
+ * while before answering.  WAIT asks again later, RESET restarts the tick
+ * times from the current system time.
+ */
+typedef enum audio_clock_state (*audio_clock_callback_t)(void *param, uint64_t audio_time);
+
+EXPORT void audio_output_set_clock(audio_t *audio, audio_clock_callback_t callback, void *param);
+
 typedef void (*audio_output_callback_t)(void *param, size_t mix_idx, struct audio_data *data);
 
 EXPORT bool audio_output_connect(audio_t *video, size_t mix_idx, const struct audio_convert_info *conversion,
@@ -34,16 +34,26 @@ extern profiler_name_store_t *obs_get_profiler_name_store(void);
 #define MAX_CONVERT_BUFFERS 3
 #define MAX_CACHE_SIZE 16
 
+/* Image buffers passed to raw video callbacks.  A callback can take a
+ * reference with video_output_ref_frame to keep using the image after it
+ * returns.  Buffers that are still referenced are never written to again,
+ * video-io drops its own reference and continues with a new buffer instead. */
+struct video_frame_ref {
+	struct video_frame frame;
+	volatile long refs;
+};
+
 struct cached_frame_info {
 	struct video_data frame;
 	int skipped;
 	int count;
+	struct video_frame_ref *buffer;
 };
 
 struct video_input {
 	struct video_scale_info conversion;
 	video_scaler_t *scaler;
-	struct video_frame frame[MAX_CONVERT_BUFFERS];
+	struct video_frame_ref *frame[MAX_CONVERT_BUFFERS];
 	int cur_frame;
 
 	// allow outputting at fractions of main composition FPS,
@@ -56,14 +66,53 @@ struct video_input {
 	uint32_t frame_rate_divisor;
 	uint32_t frame_rate_divisor_counter;
 
+	/* a frame with a new image arrived since the last callback */
+	bool frame_changed;
+	bool frame_scaled;
+
+	/* frame[cur_frame] holds the current frame, other inputs with the
+	 * same conversion can use it instead of scaling it again */
+	bool scaled_this_frame;
+	const char *scale_profile_name;
+
 	void (*callback)(void *param, struct video_data *frame);
 	void *param;
 };
 
+static struct video_frame_ref *frame_ref_create(enum video_format format, uint32_t width, uint32_t height)
+{
+	struct video_frame_ref *ref = bzalloc(sizeof(struct video_frame_ref));
+	video_frame_init(&ref->frame, format, width, height);
+	ref->refs = 1;
+	return ref;
+}
+
+void video_frame_ref_release(struct video_frame_ref *ref)
+{
+	if (ref && os_atomic_dec_long(&ref->refs) == 0) {
+		video_frame_free(&ref->frame);
+		bfree(ref);
+	}
+}
+
+/* Returns false if the buffer had to be replaced */
+static bool frame_ref_make_writable(struct video_frame_ref **ref, enum video_format format, uint32_t width,
+				    uint32_t height)
+{
+	if (os_atomic_load_long(&(*ref)->refs) == 1)
+		return true;
+
+	video_frame_ref_release(*ref);
+	*ref = frame_ref_create(format, width, height);
+	return false;
+}
+
 static inline void video_input_free(struct video_input *input)
 {
-	for (size_t i = 0; i < MAX_CONVERT_BUFFERS; i++)
-		video_frame_free(&input->frame[i]);
+	for (size_t i = 0; i < MAX_CONVERT_BUFFERS; i++) {
+		video_frame_ref_release(input->frame[i]);
+		input->frame[i] = NULL;
+	}
 	video_scaler_destroy(input->scaler);
 }
 
@@ -75,6 +124,7 @@ struct video_output {
 	bool stop;
 
 	os_sem_t *update_semaphore;
+	os_event_t *frame_free_event;
 	uint64_t frame_time;
 	volatile long skipped_frames;
 	volatile long total_frames;
@@ -85,8 +135,14 @@ struct video_output {
 	size_t available_frames;
 	size_t first_added;
 	size_t last_added;
+	size_t last_output;
+	bool frame_locked;
 	struct cached_frame_info cache[MAX_CACHE_SIZE];
 
+	/* buffer of the frame being passed to an input callback, only
+	 * accessed from the video thread */
+	struct video_frame_ref *callback_ref;
+
 	struct video_output *parent;
 
 	volatile bool raw_active;
@@ -95,26 +151,83 @@ struct video_output {
 
 /* ------------------------------------------------------------------------- */
 
-static inline bool scale_video_output(struct video_input *input, struct video_data *data)
+static inline bool same_conversion(const struct video_scale_info *a, const struct video_scale_info *b)
+{
+	return a->format == b->format && a->width == b->width && a->height == b->height && a->range == b->range &&
+	       a->colorspace == b->colorspace;
+}
+
+static inline void set_frame_data(struct video_data *data, const struct video_frame *frame)
+{
+	for (size_t i = 0; i < MAX_AV_PLANES; i++) {
+		data->data[i] = frame->data[i];
+		data->linesize[i] = frame->linesize[i];
+	}
+}
+
+/* Inputs requesting the same conversion (e.g. two encoders at the same
+ * scaled resolution) share one scale per frame.  The first input of a group
+ * scales into its own buffers, the others reference that frame for the
+ * duration of their callback. */
+static struct video_frame_ref *find_scaled_frame(struct video_output *video, struct video_input *input)
+{
+	for (size_t i = 0; i < video->inputs.num; i++) {
+		struct video_input *other = video->inputs.array + i;
+
+		if (other == input)
+			break;
+		if (other->scaler && other->scaled_this_frame && same_conversion(&other->conversion, &input->conversion))
+			return other->frame[other->cur_frame];
+	}
+
+	return NULL;
+}
+
+static inline bool scale_video_output(struct video_output *video, struct video_input *input, struct video_data *data)
 {
 	bool success = true;
 
 	if (input->scaler) {
-		struct video_frame *frame;
+		struct video_frame_ref *frame;
+
+		/* the last converted frame still holds the same image */
+		if (data->duplicate && input->frame_scaled) {
+			frame = input->frame[input->cur_frame];
+			set_frame_data(data, &frame->frame);
+			video->callback_ref = frame;
+			input->scaled_this_frame = true;
+			return true;
+		}
+
+		frame = find_scaled_frame(video, input);
+		if (frame) {
+			set_frame_data(data, &frame->frame);
+			video->callback_ref = frame;
+
+			/* own buffers are stale now, don't reuse them for
+			 * duplicates */
+			input->frame_scaled = false;
+			return true;
+		}
 
 		if (++input->cur_frame == MAX_CONVERT_BUFFERS)
 			input->cur_frame = 0;
 
-		frame = &input->frame[input->cur_frame];
+		frame_ref_make_writable(&input->frame[input->cur_frame], input->conversion.format,
+					input->conversion.width, input->conversion.height);
+		frame = input->frame[input->cur_frame];
 
-		success = video_scaler_scale(input->scaler, frame->data, frame->linesize,
+		profile_start(input->scale_profile_name);
+		success = video_scaler_scale(input->scaler, frame->frame.data, frame->frame.linesize,
 					     (const uint8_t *const *)data->data, data->linesize);
+		profile_end(input->scale_profile_name);
+
+		input->frame_scaled = success;
+		input->scaled_this_frame = success;
 
 		if (success) {
-			for (size_t i = 0; i < MAX_AV_PLANES; i++) {
-				data->data[i] = frame->data[i];
-				data->linesize[i] = frame->linesize[i];
-			}
+			set_frame_data(data, &frame->frame);
+			video->callback_ref = frame;
 		} else {
 			blog(LOG_WARNING, "video-io: Could not scale frame!");
 		}
@@ -126,6 +239,8 @@ static inline bool scale_video_output(struct video_input *input, struct video_da
 static inline bool video_output_cur_frame(struct video_output *video)
 {
 	struct cached_frame_info *frame_info;
+	struct video_frame_ref *buffer;
+	bool duplicate;
 	bool complete;
 	bool skipped;
 
@@ -134,6 +249,8 @@ static inline bool video_output_cur_frame(struct video_output *video)
 	pthread_mutex_lock(&video->data_mutex);
 
 	frame_info = &video->cache[video->first_added];
+	duplicate = frame_info->frame.duplicate;
+	buffer = frame_info->buffer;
 
 	pthread_mutex_unlock(&video->data_mutex);
 
@@ -141,6 +258,9 @@ static inline bool video_output_cur_frame(struct video_output *video)
 
 	pthread_mutex_lock(&video->input_mutex);
 
+	for (size_t i = 0; i < video->inputs.num; i++)
+		video->inputs.array[i].scaled_this_frame = false;
+
 	for (size_t i = 0; i < video->inputs.num; i++) {
 		struct video_input *input = video->inputs.array + i;
 		struct video_data frame = frame_info->frame;
@@ -152,11 +272,19 @@ static inline bool video_output_cur_frame(struct video_output *video)
 		if (input->frame_rate_divisor_counter == input->frame_rate_divisor)
 			input->frame_rate_divisor_counter = 0;
 
+		if (!duplicate)
+			input->frame_changed = true;
+
 		if (skip)
 			continue;
 
-		if (scale_video_output(input, &frame))
+		frame.duplicate = !input->frame_changed;
+		input->frame_changed = false;
+
+		video->callback_ref = buffer;
+		if (scale_video_output(video, input, &frame))
 			input->callback(input->param, &frame);
+		video->callback_ref = NULL;
 	}
 
 	pthread_mutex_unlock(&video->input_mutex);
@@ -165,16 +293,22 @@ static inline bool video_output_cur_frame(struct video_output *video)
 
 	pthread_mutex_lock(&video->data_mutex);
 
+	/* repeats of a frame (lag or video_output_repeat_frame) are duplicates */
 	frame_info->frame.timestamp += video->frame_time;
+	frame_info->frame.duplicate = true;
 	complete = --frame_info->count == 0;
 	skipped = frame_info->skipped > 0;
 
 	if (complete) {
+		video->last_output = video->first_added;
+
 		if (++video->first_added == video->info.cache_size)
 			video->first_added = 0;
 
 		if (++video->available_frames == video->info.cache_size)
 			video->last_added = video->first_added;
+
+		os_event_signal(video->frame_free_event);
 	} else if (skipped) {
 		--frame_info->skipped;
 		os_atomic_inc_long(&video->skipped_frames);
@@ -227,10 +361,10 @@ static inline void init_cache(struct video_output *video)
 		video->info.cache_size = MAX_CACHE_SIZE;
 
 	for (size_t i = 0; i < video->info.cache_size; i++) {
-		struct video_frame *frame;
-		frame = (struct video_frame *)&video->cache[i];
+		struct cached_frame_info *cfi = &video->cache[i];
 
-		video_frame_init(frame, video->info.format, video->info.width, video->info.height);
+		cfi->buffer = frame_ref_create(video->info.format, video->info.width, video->info.height);
+		set_frame_data(&cfi->frame, &cfi->buffer->frame);
 	}
 
 	video->available_frames = video->info.cache_size;
@@ -256,14 +390,18 @@ int video_output_open(video_t **video, struct video_output_info *info)
 		goto fail1;
 	if (os_sem_init(&out->update_semaphore, 0) != 0)
 		goto fail2;
-	if (pthread_create(&out->thread, NULL, video_thread, out) != 0)
+	if (os_event_init(&out->frame_free_event, OS_EVENT_TYPE_AUTO) != 0)
 		goto fail3;
+	if (pthread_create(&out->thread, NULL, video_thread, out) != 0)
+		goto fail4;
 
 	init_cache(out);
 
 	*video = out;
 	return VIDEO_OUTPUT_SUCCESS;
 
+fail4:
+	os_event_destroy(out->frame_free_event);
 fail3:
 	os_sem_destroy(out->update_semaphore);
 fail2:
@@ -289,10 +427,11 @@ void video_output_close(video_t *video)
 	da_free(video->inputs);
 
 	for (size_t i = 0; i < video->info.cache_size; i++)
-		video_frame_free((struct video_frame *)&video->cache[i]);
+		video_frame_ref_release(video->cache[i].buffer);
 
 	pthread_mutex_unlock(&video->input_mutex);
 	os_sem_destroy(video->update_semaphore);
+	os_event_destroy(video->frame_free_event);
 	pthread_mutex_destroy(&video->data_mutex);
 	pthread_mutex_destroy(&video->input_mutex);
 
@@ -362,8 +501,12 @@ static inline bool video_input_init(struct video_input *input, struct video_outp
 		}
 
 		for (size_t i = 0; i < MAX_CONVERT_BUFFERS; i++)
-			video_frame_init(&input->frame[i], input->conversion.format, input->conversion.width,
-					 input->conversion.height);
+			input->frame[i] = frame_ref_create(input->conversion.format, input->conversion.width,
+							   input->conversion.height);
+
+		input->scale_profile_name = profile_store_name(obs_get_profiler_name_store(), "scale_video_output(%s %ux%u)",
+							       get_video_format_name(input->conversion.format),
+							       input->conversion.width, input->conversion.height);
 	}
 
 	return true;
@@ -415,6 +558,7 @@ bool video_output_connect2(video_t *video, const struct video_scale_info *conver
 		input.param = param;
 
 		input.frame_rate_divisor = frame_rate_divisor;
+		input.frame_changed = true;
 
 		if (conversion) {
 			input.conversion = *conversion;
@@ -530,12 +674,17 @@ bool video_output_lock_frame(video_t *video, struct video_frame *frame, int coun
 		}
 
 		cfi = &video->cache[video->last_added];
+		if (!frame_ref_make_writable(&cfi->buffer, video->info.format, video->info.width, video->info.height))
+			set_frame_data(&cfi->frame, &cfi->buffer->frame);
+
 		cfi->frame.timestamp = timestamp;
+		cfi->frame.duplicate = false;
 		cfi->count = count;
 		cfi->skipped = 0;
 
 		memcpy(frame, &cfi->frame, sizeof(*frame));
 
+		video->frame_locked = true;
 		locked = true;
 	}
 
@@ -544,6 +693,31 @@ bool video_output_lock_frame(video_t *video, struct video_frame *frame, int coun
 	return locked;
 }
 
+bool video_output_wait_for_free_frame(video_t *video, unsigned long milliseconds)
+{
+	bool available;
+
+	if (!video)
+		return true;
+
+	video = get_root(video);
+
+	pthread_mutex_lock(&video->data_mutex);
+	available = video->stop || video->available_frames != 0;
+	pthread_mutex_unlock(&video->data_mutex);
+
+	if (available)
+		return true;
+
+	os_event_timedwait(video->frame_free_event, milliseconds);
+
+	pthread_mutex_lock(&video->data_mutex);
+	available = video->stop || video->available_frames != 0;
+	pthread_mutex_unlock(&video->data_mutex);
+
+	return available;
+}
+
 void video_output_unlock_frame(video_t *video)
 {
 	if (!video)
@@ -559,6 +733,74 @@ void video_output_unlock_frame(video_t *video)
 	pthread_mutex_unlock(&video->data_mutex);
 }
 
+static inline void swap_frame_buffers(struct cached_frame_info *a, struct cached_frame_info *b)
+{
+	struct video_frame_ref *buffer = a->buffer;
+
+	a->buffer = b->buffer;
+	b->buffer = buffer;
+
+	set_frame_data(&a->frame, &a->buffer->frame);
+	set_frame_data(&b->frame, &b->buffer->frame);
+}
+
+/* Outputs the last locked frame again, for when the image did not change.
+ * No frame data is copied, inputs receive the frame flagged as duplicate. */
+bool video_output_repeat_frame(video_t *video, int count, uint64_t timestamp)
+{
+	struct cached_frame_info *cfi;
+	bool repeated = true;
+
+	if (!video)
+		return false;
+
+	video = get_root(video);
+
+	pthread_mutex_lock(&video->data_mutex);
+
+	if (!video->frame_locked) {
+		repeated = false;
+
+	} else if (video->available_frames != video->info.cache_size) {
+		/* the last frame is still queued, output it more often */
+		video->cache[video->last_added].count += count;
+
+	} else {
+		/* every frame was output, so the buffers of the last completed
+		 * one are free to be moved into the next slot */
+		cfi = &video->cache[video->last_added];
+		if (video->last_output != video->last_added)
+			swap_frame_buffers(cfi, &video->cache[video->last_output]);
+
+		cfi->frame.timestamp = timestamp;
+		cfi->frame.duplicate = true;
+		cfi->count = count;
+		cfi->skipped = 0;
+
+		video->available_frames--;
+		os_sem_post(video->update_semaphore);
+	}
+
+	pthread_mutex_unlock(&video->data_mutex);
+
+	return repeated;
+}
+
+struct video_frame_ref *video_output_ref_frame(video_t *video, const struct video_data *frame)
+{
+	struct video_frame_ref *ref;
+
+	if (!video || !frame)
+		return NULL;
+
+	ref = get_root(video)->callback_ref;
+	if (!ref || ref->frame.data[0] != frame->data[0])
+		return NULL;
+
+	os_atomic_inc_long(&ref->refs);
+	return ref;
+}
+
 uint64_t video_output_get_frame_time(const video_t *video)
 {
 	return video ? video->frame_time : 0;
@@ -576,6 +818,7 @@ void video_output_stop(video_t *video)
 	if (!video->stop) {
 		video->stop = true;
 		os_sem_post(video->update_semaphore);
+		os_event_signal(video->frame_free_event);
 		pthread_join(video->thread, &thread_ret);
 	}
 }
@@ -30,6 +30,7 @@ struct video_frame;
 
 struct video_output;
 typedef struct video_output video_t;
+struct video_frame_ref;
 
 enum video_format {
 	VIDEO_FORMAT_NONE,
@@ -122,6 +123,9 @@ struct video_data {
 	uint8_t *data[MAX_AV_PLANES];
 	uint32_t linesize[MAX_AV_PLANES];
 	uint64_t timestamp;
+
+	/* same image as the previous frame passed to this callback */
+	bool duplicate;
 };
 
 struct video_output_info {
@@ -313,6 +317,18 @@ EXPORT bool video_output_active(const video_t *video);
 EXPORT const struct video_output_info *video_output_get_info(const video_t *video);
 EXPORT bool video_output_lock_frame(video_t *video, struct video_frame *frame, int count, uint64_t timestamp);
 EXPORT void video_output_unlock_frame(video_t *video);
+
+/* Waits up to the given time for a cache frame to become free, so the next
+ * video_output_lock_frame call does not skip the frame.  Returns true once a
+ * frame is free or the output is stopped. */
+EXPORT bool video_output_wait_for_free_frame(video_t *video, unsigned long milliseconds);
+EXPORT bool video_output_repeat_frame(video_t *video, int count, uint64_t timestamp);
+
+/* Keeps the image of a frame passed to a raw video callback valid after the
+ * callback returns, until the reference is released.  Can only be called from
+ * within the callback, returns NULL for frames not owned by the output. */
+EXPORT struct video_frame_ref *video_output_ref_frame(video_t *video, const struct video_data *frame);
+EXPORT void video_frame_ref_release(struct video_frame_ref *ref);
 EXPORT uint64_t video_output_get_frame_time(const video_t *video);
 EXPORT void video_output_stop(video_t *video);
 EXPORT bool video_output_stopped(video_t *video);
@@ -178,6 +178,26 @@ bool obs_av1_keyframe(const uint8_t *data, size_t size)
 	return false;
 }
 
+/* Returns the offset of the first frame (header) or tile group OBU, or size if
+ * there is none */
+size_t obs_av1_first_frame_offset(const uint8_t *data, size_t size)
+{
+	const uint8_t *start = data, *end = data + size;
+
+	while (start < end) {
+		size_t obu_start, obu_size;
+		int obu_type;
+		parse_obu_header(start, end - start, &obu_start, &obu_size, &obu_type);
+
+		if (obu_type == OBS_OBU_FRAME || obu_type == OBS_OBU_FRAME_HEADER || obu_type == OBS_OBU_TILE_GROUP)
+			return start - data;
+
+		start += obu_start + obu_size;
+	}
+
+	return size;
+}
+
 void obs_extract_av1_headers(const uint8_t *packet, size_t size, uint8_t **new_packet_data, size_t *new_packet_size,
 			     uint8_t **header_data, size_t *header_size)
 {
@@ -47,6 +47,31 @@ bool obs_avc_keyframe(const uint8_t *data, size_t size)
 	return false;
 }
 
+/* Returns the offset of the start code of the first slice NAL, or size if
+ * there is none */
+size_t obs_avc_first_vcl_offset(const uint8_t *data, size_t size)
+{
+	const uint8_t *end = data + size;
+	const uint8_t *start_code = obs_nal_find_startcode(data, end);
+
+	while (start_code < end) {
+		const uint8_t *nal_start = start_code;
+		while (nal_start < end && !*(nal_start++))
+			;
+
+		if (nal_start == end)
+			break;
+
+		const uint8_t type = nal_start[0] & 0x1F;
+		if (type >= OBS_NAL_SLICE && type <= OBS_NAL_SLICE_IDR)
+			return start_code - data;
+
+		start_code = obs_nal_find_startcode(nal_start, end);
+	}
+
+	return size;
+}
+
 const uint8_t *obs_avc_find_startcode(const uint8_t *p, const uint8_t *end)
 {
 	return obs_nal_find_startcode(p, end);
@@ -96,7 +121,19 @@ void obs_parse_avc_packet(struct encoder_packet *avc_packet, const struct encode
 	*avc_packet = *src;
 
 	serialize(&s, &ref, sizeof(ref));
-	serialize_avc_data(&s, src->data, src->size, &avc_packet->keyframe, &avc_packet->priority);
+
+	/* Prefix SEIs go after AUD/SPS/PPS, before the first slice */
+	const uint8_t *prefix;
+	size_t prefix_size;
+	obs_encoder_packet_get_prefix(src, &prefix, &prefix_size);
+
+	size_t vcl = prefix_size ? obs_avc_first_vcl_offset(src->data, src->size) : src->size;
+	serialize_avc_data(&s, src->data, vcl, &avc_packet->keyframe, &avc_packet->priority);
+	if (prefix_size) {
+		serialize_avc_data(&s, prefix, prefix_size, &avc_packet->keyframe, &avc_packet->priority);
+		serialize_avc_data(&s, src->data + vcl, src->size - vcl, &avc_packet->keyframe,
+				   &avc_packet->priority);
+	}
 
 	avc_packet->data = output.bytes.array + sizeof(ref);
 	avc_packet->size = output.bytes.num - sizeof(ref);
@@ -19,6 +19,21 @@
 #include "obs.h"
 #include "obs-internal.h"
 
+/*
+ *   Presenting a swap chain can block on vsync or the compositor, which on
+ * the graphics thread delays every output.  Where shared textures are
+ * available, displays render into a shared texture on the graphics thread
+ * instead, and a second device presents that texture to the swap chain from
+ * its own thread.
+ *
+ *   The keyed mutex of the texture is used as a one-frame mailbox: the
+ * graphics thread releases key 1 after rendering, the present thread
+ * releases key 0 after presenting.  The graphics thread acquires either key,
+ * so a frame that has not been presented yet is simply replaced by the next
+ * one, and a display that is stuck presenting is skipped rather than waited
+ * on.
+ */
+
 bool obs_display_init(struct obs_display *display, const struct gs_init_data *graphics_data)
 {
 	pthread_mutex_init_value(&display->draw_callbacks_mutex);
@@ -45,6 +60,19 @@ bool obs_display_init(struct obs_display *display, const struct gs_init_data *gr
 		display->cy = cy;
 		display->next_cx = cx;
 		display->next_cy = cy;
+
+#ifdef _WIN32
+		if (display->present_offload) {
+			gs_load_swapchain(display->swap);
+			os_atomic_set_long(&display->present_space, (long)gs_get_color_space());
+			gs_load_swapchain(NULL);
+
+			os_atomic_set_long(&display->present_handle, (long)GS_INVALID_HANDLE);
+			os_atomic_set_long(&display->present_generation, 0);
+			display->present_handle_p = GS_INVALID_HANDLE;
+			display->present_generation_p = 0;
+		}
+#endif
 	}
 
 	if (pthread_mutex_init(&display->draw_callbacks_mutex, NULL) != 0) {
@@ -63,25 +91,35 @@ bool obs_display_init(struct obs_display *display, const struct gs_init_data *gr
 obs_display_t *obs_display_create(const struct gs_init_data *graphics_data, uint32_t background_color)
 {
 	struct obs_display *display = bzalloc(sizeof(struct obs_display));
+	graphics_t *graphics = obs->video.graphics;
+	bool success;
+
+	/* the depth/stencil buffer of the swap chain would not be available
+	 * to draw callbacks rendering into the shared texture */
+	if (graphics_data && graphics_data->zsformat == GS_ZS_NONE && obs->video.present_graphics) {
+		display->present_offload = true;
+		graphics = obs->video.present_graphics;
+	}
 
-	gs_enter_context(obs->video.graphics);
+	gs_enter_context(graphics);
 
 	display->background_color = background_color;
+	success = obs_display_init(display, graphics_data);
 
-	if (!obs_display_init(display, graphics_data)) {
+	gs_leave_context();
+
+	if (!success) {
 		obs_display_destroy(display);
-		display = NULL;
-	} else {
-		pthread_mutex_lock(&obs->data.displays_mutex);
-		display->prev_next = &obs->data.first_display;
-		display->next = obs->data.first_display;
-		obs->data.first_display = display;
-		if (display->next)
-			display->next->prev_next = &display->next;
-		pthread_mutex_unlock(&obs->data.displays_mutex);
+		return NULL;
 	}
 
-	gs_leave_context();
+	pthread_mutex_lock(&obs->data.displays_mutex);
+	display->prev_next = &obs->data.first_display;
+	display->next = obs->data.first_display;
+	obs->data.first_display = display;
+	if (display->next)
+		display->next->prev_next = &display->next;
+	pthread_mutex_unlock(&obs->data.displays_mutex);
 
 	return display;
 }
@@ -96,6 +134,9 @@ void obs_display_free(obs_display_t *display)
 		gs_swapchain_destroy(display->swap);
 		display->swap = NULL;
 	}
+
+	gs_texture_destroy(display->present_tex_p);
+	display->present_tex_p = NULL;
 }
 
 void obs_display_destroy(obs_display_t *display)
@@ -108,9 +149,23 @@ void obs_display_destroy(obs_display_t *display)
 			display->next->prev_next = display->prev_next;
 		pthread_mutex_unlock(&obs->data.displays_mutex);
 
-		obs_enter_graphics();
-		obs_display_free(display);
-		obs_leave_graphics();
+		if (display->present_offload) {
+			/* the present thread may be using it until it lets go
+			 * of the present mutex */
+			pthread_mutex_lock(&obs->video.present_mutex);
+			gs_enter_context(obs->video.present_graphics);
+			obs_display_free(display);
+			gs_leave_context();
+			pthread_mutex_unlock(&obs->video.present_mutex);
+
+			obs_enter_graphics();
+			gs_texture_destroy(display->present_tex);
+			obs_leave_graphics();
+		} else {
+			obs_enter_graphics();
+			obs_display_free(display);
+			obs_leave_graphics();
+		}
 
 		bfree(display);
 	}
@@ -167,10 +222,53 @@ void obs_display_remove_draw_callback(obs_display_t *display, void (*draw)(void
 	pthread_mutex_unlock(&display->draw_callbacks_mutex);
 }
 
-static inline bool render_display_begin(struct obs_display *display, uint32_t cx, uint32_t cy, bool update_color_space)
+static void render_display_clear(struct obs_display *display, uint32_t cx, uint32_t cy)
 {
 	struct vec4 clear_color;
 
+	/*
+	 * In contrast to OpenGL or Direct3D 11, Metal and Direct3D 12 require the clear color to use linear gamma
+	 * as either the load command to clear the render target (Metal) or the explicit clear command seem to operate
+	 * on the render target in linear space.
+	 *
+	 * As OpenGL is implemented via Metal on Apple Silicon Macs and "glClear" has to be emulated via an explicit
+	 * render pass that returns the clear color for every fragment, the color becomes subject to automatic sRGB
+	 * gamma encoding if the render target uses an sRGB color format.
+	 */
+#if defined(__APPLE__) && defined(__aarch64__)
+	vec4_from_rgba_srgb(&clear_color, display->background_color);
+#else
+	if (gs_get_color_space() == GS_CS_SRGB)
+		vec4_from_rgba(&clear_color, display->background_color);
+	else
+		vec4_from_rgba_srgb(&clear_color, display->background_color);
+#endif
+	clear_color.w = 1.0f;
+
+	const bool use_clear_workaround = display->use_clear_workaround;
+
+	uint32_t clear_flags = GS_CLEAR_DEPTH | GS_CLEAR_STENCIL;
+	if (!use_clear_workaround)
+		clear_flags |= GS_CLEAR_COLOR;
+	gs_clear(clear_flags, &clear_color, 1.0f, 0);
+
+	gs_enable_depth_test(false);
+	/* gs_enable_blending(false); */
+	gs_set_cull_mode(GS_NEITHER);
+
+	gs_ortho(0.0f, (float)cx, 0.0f, (float)cy, -100.0f, 100.0f);
+	gs_set_viewport(0, 0, cx, cy);
+
+	if (use_clear_workaround) {
+		gs_effect_t *const solid_effect = obs->video.solid_effect;
+		gs_effect_set_vec4(gs_effect_get_param_by_name(solid_effect, "color"), &clear_color);
+		while (gs_effect_loop(solid_effect, "Solid"))
+			gs_draw_sprite(NULL, 0, cx, cy);
+	}
+}
+
+static inline bool render_display_begin(struct obs_display *display, uint32_t cx, uint32_t cy, bool update_color_space)
+{
 	gs_load_swapchain(display->swap);
 
 	if ((display->cx != cx) || (display->cy != cy)) {
@@ -184,98 +282,339 @@ static inline bool render_display_begin(struct obs_display *display, uint32_t cx
 	const bool success = gs_is_present_ready();
 	if (success) {
 		gs_begin_scene();
+		render_display_clear(display, cx, cy);
+	}
 
-		/*
-		 * In contrast to OpenGL or Direct3D 11, Metal and Direct3D 12 require the clear color to use linear gamma
-		 * as either the load command to clear the render target (Metal) or the explicit clear command seem to operate
-		 * on the render target in linear space.
-		 *
-		 * As OpenGL is implemented via Metal on Apple Silicon Macs and "glClear" has to be emulated via an explicit
-		 * render pass that returns the clear color for every fragment, the color becomes subject to automatic sRGB
-		 * gamma encoding if the render target uses an sRGB color format.
-		 */
-#if defined(__APPLE__) && defined(__aarch64__)
-		vec4_from_rgba_srgb(&clear_color, display->background_color);
-#else
-		if (gs_get_color_space() == GS_CS_SRGB)
-			vec4_from_rgba(&clear_color, display->background_color);
-		else
-			vec4_from_rgba_srgb(&clear_color, display->background_color);
-#endif
-		clear_color.w = 1.0f;
+	return success;
+}
 
-		const bool use_clear_workaround = display->use_clear_workaround;
+static inline void render_display_end()
+{
+	gs_end_scene();
+}
 
-		uint32_t clear_flags = GS_CLEAR_DEPTH | GS_CLEAR_STENCIL;
-		if (!use_clear_workaround)
-			clear_flags |= GS_CLEAR_COLOR;
-		gs_clear(clear_flags, &clear_color, 1.0f, 0);
+static void render_display_callbacks(struct obs_display *display, uint32_t cx, uint32_t cy)
+{
+	GS_DEBUG_MARKER_BEGIN(GS_DEBUG_COLOR_DISPLAY, "obs_display");
 
-		gs_enable_depth_test(false);
-		/* gs_enable_blending(false); */
-		gs_set_cull_mode(GS_NEITHER);
+	pthread_mutex_lock(&display->draw_callbacks_mutex);
 
-		gs_ortho(0.0f, (float)cx, 0.0f, (float)cy, -100.0f, 100.0f);
-		gs_set_viewport(0, 0, cx, cy);
+	for (size_t i = 0; i < display->draw_callbacks.num; i++) {
+		struct draw_callback *callback;
+		callback = display->draw_callbacks.array + i;
 
-		if (use_clear_workaround) {
-			gs_effect_t *const solid_effect = obs->video.solid_effect;
-			gs_effect_set_vec4(gs_effect_get_param_by_name(solid_effect, "color"), &clear_color);
-			while (gs_effect_loop(solid_effect, "Solid"))
-				gs_draw_sprite(NULL, 0, cx, cy);
-		}
+		callback->draw(callback->param, cx, cy);
 	}
 
-	return success;
+	pthread_mutex_unlock(&display->draw_callbacks_mutex);
+
+	GS_DEBUG_MARKER_END();
 }
 
-static inline void render_display_end()
+#ifdef _WIN32
+static void render_display_offload(struct obs_display *display, uint32_t cx, uint32_t cy)
 {
+	const enum gs_color_space space = (enum gs_color_space)os_atomic_load_long(&display->present_space);
+	const enum gs_color_format format = gs_get_format_from_space(space);
+	gs_texture_t *tex = display->present_tex;
+
+	if (!tex || gs_texture_get_width(tex) != cx || gs_texture_get_height(tex) != cy ||
+	    gs_texture_get_color_format(tex) != format) {
+		gs_texture_destroy(tex);
+		tex = gs_texture_create(cx, cy, format, 1, NULL, GS_RENDER_TARGET | GS_SHARED_KM_TEX);
+		display->present_tex = tex;
+
+		/* the handle of a destroyed texture can be handed out again, so
+		 * every new texture also bumps the generation.  the handle is
+		 * published first, a present thread seeing the new generation
+		 * always sees the new handle as well */
+		const uint32_t handle = tex ? gs_texture_get_shared_handle(tex) : GS_INVALID_HANDLE;
+		os_atomic_set_long(&display->present_handle, (long)handle);
+		os_atomic_inc_long(&display->present_generation);
+	}
+
+	if (!tex)
+		return;
+
+	/* key 1 is a frame the present thread has not picked up yet, it is
+	 * replaced.  if neither key is free the previous frame is still being
+	 * presented, and this display skips a frame */
+	if (gs_texture_acquire_sync(tex, 0, 0) != 0 && gs_texture_acquire_sync(tex, 1, 0) != 0)
+		return;
+
+	gs_set_render_target_with_color_space(tex, NULL, space);
+	gs_begin_scene();
+
+	render_display_clear(display, cx, cy);
+	render_display_callbacks(display, cx, cy);
+
 	gs_end_scene();
+	gs_set_render_target(NULL, NULL);
+
+	gs_texture_release_sync(tex, 1);
+	os_event_signal(obs->video.present_event);
 }
+#endif
 
 void render_display(struct obs_display *display)
 {
 	uint32_t cx, cy;
-	bool update_color_space;
+	bool update_color_space = false;
 
-	if (!display || !display->enabled)
+	if (!display || !display->enabled || os_atomic_load_bool(&display->occluded))
 		return;
 
 	/* -------------------------------------------- */
 
 	pthread_mutex_lock(&display->draw_info_mutex);
 
+	if (display->min_interval_ns) {
+		const uint64_t now = obs->video.video_time;
+
+		/* half a frame of slack, a cap at an exact divisor of the frame
+		 * rate would otherwise drop to the next divisor on jitter */
+		if (now - display->last_render_ns + obs->video.video_half_frame_interval_ns < display->min_interval_ns) {
+			pthread_mutex_unlock(&display->draw_info_mutex);
+			return;
+		}
+
+		display->last_render_ns = now;
+	}
+
 	cx = display->next_cx;
 	cy = display->next_cy;
-	update_color_space = display->update_color_space;
 
-	display->update_color_space = false;
+	/* the swap chain belongs to the present thread otherwise */
+	if (!display->present_offload) {
+		update_color_space = display->update_color_space;
+		display->update_color_space = false;
+	}
 
 	pthread_mutex_unlock(&display->draw_info_mutex);
 
 	/* -------------------------------------------- */
 
+#ifdef _WIN32
+	if (display->present_offload) {
+		render_display_offload(display, cx, cy);
+		return;
+	}
+#endif
+
 	if (render_display_begin(display, cx, cy, update_color_space)) {
-		GS_DEBUG_MARKER_BEGIN(GS_DEBUG_COLOR_DISPLAY, "obs_display");
+		render_display_callbacks(display, cx, cy);
+		render_display_end();
 
-		pthread_mutex_lock(&display->draw_callbacks_mutex);
+		gs_present();
+	}
+}
 
-		for (size_t i = 0; i < display->draw_callbacks.num; i++) {
-			struct draw_callback *callback;
-			callback = display->draw_callbacks.array + i;
+/* ------------------------------------------------------------------------- */
+/* present thread */
 
-			callback->draw(callback->param, cx, cy);
-		}
+#ifdef _WIN32
 
-		pthread_mutex_unlock(&display->draw_callbacks_mutex);
+static void present_display(struct obs_display *display)
+{
+	gs_effect_t *effect = obs->video.present_effect;
+	const long generation = os_atomic_load_long(&display->present_generation);
+	const uint32_t handle = (uint32_t)os_atomic_load_long(&display->present_handle);
+	bool update_color_space;
+	uint64_t key = 1;
 
-		render_display_end();
+	if (generation != display->present_generation_p || handle != display->present_handle_p) {
+		gs_texture_destroy(display->present_tex_p);
+		display->present_tex_p = handle != GS_INVALID_HANDLE ? gs_texture_open_shared(handle) : NULL;
+		display->present_handle_p = handle;
+		display->present_generation_p = generation;
+	}
 
-		GS_DEBUG_MARKER_END();
+	pthread_mutex_lock(&display->draw_info_mutex);
+	update_color_space = display->update_color_space;
+	display->update_color_space = false;
+	pthread_mutex_unlock(&display->draw_info_mutex);
 
+	gs_load_swapchain(display->swap);
+
+	if (update_color_space) {
+		gs_update_color_space();
+		os_atomic_set_long(&display->present_space, (long)gs_get_color_space());
+	}
+
+	gs_texture_t *tex = display->present_tex_p;
+	if (!tex || gs_texture_acquire_sync(tex, 1, 0) != 0)
+		return;
+
+	const uint32_t cx = gs_texture_get_width(tex);
+	const uint32_t cy = gs_texture_get_height(tex);
+
+	if (display->cx != cx || display->cy != cy) {
+		gs_resize(cx, cy);
+
+		pthread_mutex_lock(&display->draw_info_mutex);
+		display->cx = cx;
+		display->cy = cy;
+		pthread_mutex_unlock(&display->draw_info_mutex);
+	}
+
+	if (gs_is_present_ready()) {
+		const bool previous = gs_framebuffer_srgb_enabled();
+
+		gs_begin_scene();
+
+		gs_enable_depth_test(false);
+		gs_enable_blending(false);
+		gs_enable_framebuffer_srgb(false);
+		gs_set_cull_mode(GS_NEITHER);
+		gs_ortho(0.0f, (float)cx, 0.0f, (float)cy, -100.0f, 100.0f);
+		gs_set_viewport(0, 0, cx, cy);
+
+		gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), tex);
+		while (gs_effect_loop(effect, "Draw"))
+			gs_draw_sprite(tex, 0, cx, cy);
+
+		gs_enable_framebuffer_srgb(previous);
+		gs_enable_blending(true);
+
+		gs_end_scene();
 		gs_present();
+
+		key = 0;
+	}
+
+	/* a frame that could not be presented stays pending */
+	gs_texture_release_sync(tex, key);
+}
+
+static void *present_thread(void *param)
+{
+	struct obs_core_video *video = param;
+	DARRAY(struct obs_display *) displays;
+
+	da_init(displays);
+	os_set_thread_name("libobs: present thread");
+
+	while (os_event_wait(video->present_event) == 0) {
+		if (os_atomic_load_bool(&video->present_stop))
+			break;
+
+		/* displays are not freed while the present mutex is held */
+		pthread_mutex_lock(&video->present_mutex);
+
+		pthread_mutex_lock(&obs->data.displays_mutex);
+		for (struct obs_display *display = obs->data.first_display; display; display = display->next) {
+			if (display->present_offload && display->enabled)
+				da_push_back(displays, &display);
+		}
+		pthread_mutex_unlock(&obs->data.displays_mutex);
+
+		gs_enter_context(video->present_graphics);
+
+		for (size_t i = 0; i < displays.num; i++)
+			present_display(displays.array[i]);
+
+		gs_leave_context();
+
+		pthread_mutex_unlock(&video->present_mutex);
+
+		da_resize(displays, 0);
 	}
+
+	da_free(displays);
+	return NULL;
+}
+
+void obs_display_present_init(const char *module, uint32_t adapter)
+{
+	struct obs_core_video *video = &obs->video;
+	graphics_t *graphics = NULL;
+	bool supported;
+
+	/* OpenGL swaps need the context the frame was rendered with, there is
+	 * nothing to gain from a second device there */
+	obs_enter_graphics();
+	supported = gs_get_device_type() == GS_DEVICE_DIRECT3D_11 && gs_shared_texture_available();
+	obs_leave_graphics();
+
+	if (!supported)
+		return;
+
+	if (gs_create(&graphics, module, adapter) != GS_SUCCESS) {
+		blog(LOG_WARNING, "Failed to create present device, displays "
+				  "are presented from the graphics thread");
+		return;
+	}
+
+	gs_enter_context(graphics);
+	char *filename = obs_find_data_file("default.effect");
+	video->present_effect = gs_effect_create_from_file(filename, NULL);
+	bfree(filename);
+	gs_leave_context();
+
+	if (!video->present_effect)
+		goto fail;
+	if (pthread_mutex_init(&video->present_mutex, NULL) != 0)
+		goto fail;
+	if (os_event_init(&video->present_event, OS_EVENT_TYPE_AUTO) != 0) {
+		pthread_mutex_destroy(&video->present_mutex);
+		goto fail;
+	}
+
+	video->present_graphics = graphics;
+	video->present_stop = false;
+
+	if (pthread_create(&video->present_thread, NULL, present_thread, video) != 0) {
+		video->present_graphics = NULL;
+		os_event_destroy(video->present_event);
+		pthread_mutex_destroy(&video->present_mutex);
+		goto fail;
+	}
+
+	video->present_thread_active = true;
+	blog(LOG_INFO, "Displays are presented from a separate thread");
+	return;
+
+fail:
+	blog(LOG_WARNING, "Failed to start present thread, displays are "
+			  "presented from the graphics thread");
+
+	gs_enter_context(graphics);
+	gs_effect_destroy(video->present_effect);
+	video->present_effect = NULL;
+	gs_leave_context();
+
+	gs_destroy(graphics);
+}
+#else
+void obs_display_present_init(const char *module, uint32_t adapter)
+{
+	UNUSED_PARAMETER(module);
+	UNUSED_PARAMETER(adapter);
+}
+#endif
+
+void obs_display_present_free(void)
+{
+	struct obs_core_video *video = &obs->video;
+
+	if (!video->present_thread_active)
+		return;
+
+	os_atomic_set_bool(&video->present_stop, true);
+	os_event_signal(video->present_event);
+	pthread_join(video->present_thread, NULL);
+	video->present_thread_active = false;
+
+	gs_enter_context(video->present_graphics);
+	gs_effect_destroy(video->present_effect);
+	video->present_effect = NULL;
+	gs_leave_context();
+
+	gs_destroy(video->present_graphics);
+	video->present_graphics = NULL;
+
+	os_event_destroy(video->present_event);
+	pthread_mutex_destroy(&video->present_mutex);
 }
 
 void obs_display_set_enabled(obs_display_t *display, bool enable)
@@ -295,6 +634,22 @@ void obs_display_set_background_color(obs_display_t *display, uint32_t color)
 		display->background_color = color;
 }
 
+void obs_display_set_max_fps(obs_display_t *display, double fps)
+{
+	if (!display)
+		return;
+
+	pthread_mutex_lock(&display->draw_info_mutex);
+	display->min_interval_ns = fps > 0.0 ? (uint64_t)(1000000000.0 / fps) : 0;
+	pthread_mutex_unlock(&display->draw_info_mutex);
+}
+
+void obs_display_set_occluded(obs_display_t *display, bool occluded)
+{
+	if (display)
+		os_atomic_set_bool(&display->occluded, occluded);
+}
+
 void obs_display_size(obs_display_t *display, uint32_t *width, uint32_t *height)
 {
 	*width = 0;
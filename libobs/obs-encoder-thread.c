@@ -0,0 +1,318 @@
+/******************************************************************************
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "obs-internal.h"
+
+/*
+ * Dedicated encode threads.
+ *
+ * The raw data callback (audio-io mix callback or video-io frame callback)
+ * only queues frames for the encoder and assigns their timestamps, the actual
+ * encode call happens on the encoder's own thread.
+ *
+ * Audio: every queued frame is encoded, so timestamps stay continuous.  If the
+ * queue is full the producer waits for a free slot rather than dropping data.
+ *
+ * Video: video-io delivers the same cached frame to every raw encoder in turn,
+ * so a single slow encoder used to hold up all the others.  The encoder's
+ * queue now holds a reference to the video-io buffer of each frame, video-io
+ * moves on to a new buffer rather than overwriting one that is still queued.
+ * If the queue is full the frame is dropped for this encoder only, its
+ * timestamp is still consumed so the remaining frames stay in sync with
+ * audio.  In freewheel mode nothing runs in real time, so the producer waits
+ * for a free slot instead, which holds up video-io and in turn the graphics
+ * thread until the encoder has caught up.
+ */
+
+static inline bool on_encode_thread(const struct encode_thread *et)
+{
+	return pthread_equal(pthread_self(), et->thread) != 0;
+}
+
+static void encode_audio_frame(struct obs_encoder *encoder, struct encode_thread_frame *slot, bool *failed)
+{
+	struct encoder_frame enc_frame;
+
+	memset(&enc_frame, 0, sizeof(struct encoder_frame));
+
+	for (size_t i = 0; i < encoder->planes; i++) {
+		enc_frame.data[i] = slot->audio[i];
+		enc_frame.linesize[i] = (uint32_t)encoder->framesize_bytes;
+	}
+
+	enc_frame.frames = (uint32_t)encoder->framesize;
+	enc_frame.pts = slot->pts;
+
+	if (!do_encode(encoder, &enc_frame, NULL))
+		*failed = true;
+}
+
+static void encode_video_frame(struct obs_encoder *encoder, struct encode_thread_frame *slot, bool *failed)
+{
+	struct encoder_frame enc_frame;
+
+	memset(&enc_frame, 0, sizeof(struct encoder_frame));
+
+	for (size_t i = 0; i < MAX_AV_PLANES; i++) {
+		enc_frame.data[i] = slot->video.data[i];
+		enc_frame.linesize[i] = slot->video.linesize[i];
+	}
+
+	enc_frame.frames = 1;
+	enc_frame.pts = slot->pts;
+	enc_frame.duplicate = slot->duplicate;
+
+	if (slot->reconfigure)
+		encoder->reconfigure_requested = true;
+
+	if (!do_encode(encoder, &enc_frame, &slot->timestamp))
+		*failed = true;
+}
+
+static inline void release_video_slot(struct encode_thread_frame *slot)
+{
+	video_frame_ref_release(slot->video_ref);
+	slot->video_ref = NULL;
+	memset(&slot->video, 0, sizeof(slot->video));
+}
+
+static void *encode_thread(void *data)
+{
+	struct obs_encoder *encoder = data;
+	struct encode_thread *et = encoder->encode_thread;
+	bool failed = false;
+
+	os_set_thread_name("obs encode thread");
+
+	while (os_sem_wait(et->frames_sem) == 0) {
+		bool stopping = os_atomic_load_bool(&et->stopping);
+
+		/* Drain queued frames on stop, unless encoding failed */
+		if (stopping && (failed || !os_atomic_load_long(&et->queued)))
+			break;
+		if (!os_atomic_load_long(&et->queued))
+			continue;
+
+		struct encode_thread_frame *slot = &et->frames[et->read_idx];
+
+		if (!failed) {
+			if (et->video)
+				encode_video_frame(encoder, slot, &failed);
+			else
+				encode_audio_frame(encoder, slot, &failed);
+		}
+
+		if (et->video)
+			release_video_slot(slot);
+
+		et->read_idx = (et->read_idx + 1) % ENCODE_THREAD_QUEUE_SIZE;
+		os_atomic_dec_long(&et->queued);
+		os_sem_post(et->free_sem);
+	}
+
+	return NULL;
+}
+
+static void destroy_encode_thread_data(struct encode_thread *et)
+{
+	/* frames left in the queue after an encode error */
+	for (size_t i = 0; i < ENCODE_THREAD_QUEUE_SIZE; i++) {
+		if (et->video) {
+			release_video_slot(&et->frames[i]);
+			continue;
+		}
+
+		for (size_t j = 0; j < MAX_AV_PLANES; j++)
+			bfree(et->frames[i].audio[j]);
+	}
+
+	os_sem_destroy(et->frames_sem);
+	os_sem_destroy(et->free_sem);
+	bfree(et);
+}
+
+void start_encode_thread(obs_encoder_t *encoder)
+{
+	/* Clean up a thread that stopped itself after an encode error */
+	free_encode_thread(encoder);
+
+	if (!encoder->threaded)
+		return;
+
+	struct encode_thread *et = bzalloc(sizeof(struct encode_thread));
+	et->video = encoder->info.type == OBS_ENCODER_VIDEO;
+
+	if (os_sem_init(&et->frames_sem, 0) != 0)
+		goto fail;
+	if (os_sem_init(&et->free_sem, ENCODE_THREAD_QUEUE_SIZE) != 0)
+		goto fail;
+
+	if (!et->video) {
+		for (size_t i = 0; i < ENCODE_THREAD_QUEUE_SIZE; i++) {
+			for (size_t j = 0; j < encoder->planes; j++)
+				et->frames[i].audio[j] = bmalloc(encoder->framesize_bytes);
+		}
+	}
+
+	encoder->encode_thread = et;
+
+	if (pthread_create(&et->thread, NULL, encode_thread, encoder) != 0) {
+		encoder->encode_thread = NULL;
+		goto fail;
+	}
+
+	return;
+
+fail:
+	blog(LOG_WARNING, "encoder '%s': Failed to create encode thread, encoding inline", encoder->context.name);
+	destroy_encode_thread_data(et);
+}
+
+void stop_encode_thread(obs_encoder_t *encoder)
+{
+	struct encode_thread *et = encoder->encode_thread;
+	if (!et)
+		return;
+
+	os_atomic_set_bool(&et->stopping, true);
+
+	/* Wake up the producer in case it is waiting for a free slot, then
+	 * the encode thread so it can drain the queue and exit */
+	os_sem_post(et->free_sem);
+	os_sem_post(et->frames_sem);
+
+	/* Encode errors stop the encoder from the encode thread itself, in
+	 * that case the thread is joined the next time the encoder starts or
+	 * when it is destroyed. */
+	if (!on_encode_thread(et) && !et->thread_joined) {
+		pthread_join(et->thread, NULL);
+		et->thread_joined = true;
+	}
+
+	if (et->dropped_frames) {
+		blog(LOG_INFO, "encoder '%s': %ld frames dropped because the encoder could not keep up",
+		     encoder->context.name, et->dropped_frames);
+		et->dropped_frames = 0;
+	}
+}
+
+/* Must only be called once the encoder is disconnected from its media */
+void free_encode_thread(obs_encoder_t *encoder)
+{
+	struct encode_thread *et = encoder->encode_thread;
+	if (!et || on_encode_thread(et))
+		return;
+
+	if (!et->thread_joined)
+		stop_encode_thread(encoder);
+
+	encoder->encode_thread = NULL;
+	destroy_encode_thread_data(et);
+}
+
+bool encode_thread_queue_audio(obs_encoder_t *encoder)
+{
+	struct encode_thread *et = encoder->encode_thread;
+
+	if (os_atomic_load_bool(&et->stopping))
+		return false;
+
+	if (os_atomic_load_long(&et->queued) == ENCODE_THREAD_QUEUE_SIZE && !et->warned_full) {
+		blog(LOG_WARNING, "encoder '%s': Encode queue full, encoder cannot keep up", encoder->context.name);
+		et->warned_full = true;
+	}
+
+	os_sem_wait(et->free_sem);
+
+	if (os_atomic_load_bool(&et->stopping))
+		return false;
+
+	struct encode_thread_frame *slot = &et->frames[et->write_idx];
+
+	for (size_t i = 0; i < encoder->planes; i++)
+		deque_pop_front(&encoder->audio_input_buffer[i], slot->audio[i], encoder->framesize_bytes);
+
+	slot->pts = encoder->cur_pts;
+	encoder->cur_pts += encoder->framesize;
+
+	et->write_idx = (et->write_idx + 1) % ENCODE_THREAD_QUEUE_SIZE;
+	os_atomic_inc_long(&et->queued);
+	os_sem_post(et->frames_sem);
+	return true;
+}
+
+void encode_thread_queue_video(obs_encoder_t *encoder, struct video_data *frame, bool duplicate)
+{
+	struct encode_thread *et = encoder->encode_thread;
+	int64_t pts = encoder->cur_pts;
+
+	if (os_atomic_load_bool(&et->stopping))
+		return;
+
+	encoder->cur_pts += encoder->timebase_num * encoder->frame_rate_divisor;
+
+	/* Never wait on the encoder here, that would stall video-io for every
+	 * other raw encoder.  Only this encoder loses the frame.  Freewheel
+	 * mode has no deadline to keep, there the wait below throttles the
+	 * whole pipeline to the slowest encoder. */
+	if (os_atomic_load_long(&et->queued) == ENCODE_THREAD_QUEUE_SIZE && !obs_freewheel_enabled()) {
+		if (!et->warned_full) {
+			blog(LOG_WARNING, "encoder '%s': Encode queue full, dropping frames", encoder->context.name);
+			et->warned_full = true;
+		}
+
+		goto drop;
+	}
+
+	struct video_frame_ref *ref = video_output_ref_frame(encoder->media, frame);
+	if (!ref)
+		goto drop;
+
+	os_sem_wait(et->free_sem);
+
+	if (os_atomic_load_bool(&et->stopping)) {
+		video_frame_ref_release(ref);
+		return;
+	}
+
+	struct encode_thread_frame *slot = &et->frames[et->write_idx];
+
+	for (size_t i = 0; i < MAX_AV_PLANES; i++) {
+		slot->video.data[i] = frame->data[i];
+		slot->video.linesize[i] = frame->linesize[i];
+	}
+	slot->video_ref = ref;
+
+	slot->pts = pts;
+	slot->timestamp = frame->timestamp;
+	slot->duplicate = duplicate && !et->frame_dropped;
+	et->frame_dropped = false;
+
+	/* Group reconfiguration has to land on this exact frame, so the request
+	 * travels with the frame rather than being picked up by whatever frame
+	 * the encode thread happens to be working on. */
+	slot->reconfigure = encoder->reconfigure_requested;
+	encoder->reconfigure_requested = false;
+
+	et->write_idx = (et->write_idx + 1) % ENCODE_THREAD_QUEUE_SIZE;
+	os_atomic_inc_long(&et->queued);
+	os_sem_post(et->frames_sem);
+	return;
+
+drop:
+	et->dropped_frames++;
+	et->frame_dropped = true;
+	video_output_inc_texture_skipped_frames(encoder->media);
+}
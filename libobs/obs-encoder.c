@@ -17,6 +17,11 @@
 
 #include "obs.h"
 #include "obs-internal.h"
+#include "obs-avc.h"
+#include "obs-av1.h"
+#ifdef ENABLE_HEVC
+#include "obs-hevc.h"
+#endif
 #include "util/util_uint64.h"
 
 #define encoder_active(encoder) os_atomic_load_bool(&encoder->active)
@@ -144,9 +149,10 @@ static struct obs_encoder *create_encoder(const char *id, enum obs_encoder_type
 	obs_context_init_control(&encoder->context, encoder, (obs_destroy_cb)obs_encoder_destroy);
 	obs_context_data_insert(&encoder->context, &obs->data.encoders_mutex, &obs->data.first_encoder);
 
-	if (type == OBS_ENCODER_VIDEO) {
+	if (type == OBS_ENCODER_VIDEO)
 		encoder->frame_rate_divisor = 1;
-	}
+
+	encoder->threaded = ei && (ei->caps & OBS_ENCODER_CAP_THREADED) != 0;
 
 	blog(LOG_DEBUG, "encoder '%s' (%s) created", name, id);
 
@@ -372,6 +378,7 @@ static void add_connection(struct obs_encoder *encoder)
 		struct audio_convert_info audio_info = {0};
 		get_audio_info(encoder, &audio_info);
 
+		start_encode_thread(encoder);
 		audio_output_connect(encoder->media, encoder->mixer_idx, &audio_info, receive_audio, encoder);
 	} else {
 		struct video_scale_info info = {0};
@@ -380,6 +387,7 @@ static void add_connection(struct obs_encoder *encoder)
 		if (gpu_encode_available(encoder)) {
 			start_gpu_encode(encoder);
 		} else {
+			start_encode_thread(encoder);
 			start_raw_video(encoder->media, &info, encoder->frame_rate_divisor, receive_video, encoder);
 		}
 	}
@@ -413,12 +421,16 @@ void obs_encoder_group_actually_destroy(obs_encoder_group_t *group);
 static void remove_connection(struct obs_encoder *encoder, bool shutdown)
 {
 	if (encoder->info.type == OBS_ENCODER_AUDIO) {
+		stop_encode_thread(encoder);
 		audio_output_disconnect(encoder->media, encoder->mixer_idx, receive_audio, encoder);
+		free_encode_thread(encoder);
 	} else {
 		if (gpu_encode_available(encoder)) {
 			stop_gpu_encode(encoder);
 		} else {
+			stop_encode_thread(encoder);
 			stop_raw_video(encoder->media, receive_video, encoder);
+			free_encode_thread(encoder);
 		}
 	}
 
@@ -476,6 +488,7 @@ void obs_encoder_destroy(obs_encoder_t *encoder)
 
 		obs_encoder_set_group(encoder, NULL);
 
+		free_encode_thread(encoder);
 		free_audio_buffers(encoder);
 
 		if (encoder->context.data)
@@ -822,6 +835,11 @@ static inline void obs_encoder_start_internal(obs_encoder_t *encoder, encoded_ca
 	if (idx == DARRAY_INVALID)
 		da_push_back(encoder->callbacks, &cb);
 
+	if (first) {
+		encoder->encode_time_total_ns = 0;
+		encoder->encode_time_count = 0;
+	}
+
 	pthread_mutex_unlock(&encoder->callbacks_mutex);
 
 	if (first) {
@@ -1044,6 +1062,43 @@ bool obs_encoder_set_frame_rate_divisor(obs_encoder_t *encoder, uint32_t frame_r
 	return true;
 }
 
+bool obs_encoder_set_threaded(obs_encoder_t *encoder, bool threaded)
+{
+	if (!obs_encoder_valid(encoder, "obs_encoder_set_threaded"))
+		return false;
+
+	if (encoder_active(encoder)) {
+		blog(LOG_WARNING,
+		     "encoder '%s': Cannot change threading "
+		     "while the encoder is active",
+		     obs_encoder_get_name(encoder));
+		return false;
+	}
+
+	encoder->threaded = threaded;
+	return true;
+}
+
+bool obs_encoder_threaded(const obs_encoder_t *encoder)
+{
+	return obs_encoder_valid(encoder, "obs_encoder_threaded") ? encoder->threaded : false;
+}
+
+uint64_t obs_encoder_get_average_encode_time_ns(obs_encoder_t *encoder)
+{
+	uint64_t total, count;
+
+	if (!obs_encoder_valid(encoder, "obs_encoder_get_average_encode_time_ns"))
+		return 0;
+
+	pthread_mutex_lock(&encoder->callbacks_mutex);
+	total = encoder->encode_time_total_ns;
+	count = encoder->encode_time_count;
+	pthread_mutex_unlock(&encoder->callbacks_mutex);
+
+	return count ? total / count : 0;
+}
+
 bool obs_encoder_scaling_enabled(const obs_encoder_t *encoder)
 {
 	if (!obs_encoder_valid(encoder, "obs_encoder_scaling_enabled"))
@@ -1464,6 +1519,7 @@ bool do_encode(struct obs_encoder *encoder, struct encoder_frame *frame, const u
 	bool received = false;
 	bool success;
 	uint64_t fer_ts = 0;
+	uint64_t ferc_ts = 0;
 
 	if (encoder->reconfigure_requested) {
 		encoder->reconfigure_requested = false;
@@ -1483,6 +1539,13 @@ bool do_encode(struct obs_encoder *encoder, struct encoder_frame *frame, const u
 	success = encoder->info.encode(encoder->context.data, frame, &pkt, &received);
 	profile_end(encoder->profile_encoder_encode_name);
 
+	ferc_ts = os_gettime_ns();
+
+	pthread_mutex_lock(&encoder->callbacks_mutex);
+	encoder->encode_time_total_ns += ferc_ts - fer_ts;
+	encoder->encode_time_count++;
+	pthread_mutex_unlock(&encoder->callbacks_mutex);
+
 	/* Generate and enqueue the frame timing metrics, namely
 	 * the CTS (composition time), FER (frame encode request), FERC
 	 * (frame encode request complete) and current PTS. PTS is used to
@@ -1491,7 +1554,7 @@ bool do_encode(struct obs_encoder *encoder, struct encoder_frame *frame, const u
 		struct encoder_packet_time *ept = da_push_back_new(encoder->encoder_packet_times);
 		// Get the frame encode request complete timestamp
 		if (success) {
-			ept->ferc = os_gettime_ns();
+			ept->ferc = ferc_ts;
 		} else {
 			// Encode had error, set ferc to 0
 			ept->ferc = 0;
@@ -1615,11 +1678,24 @@ static void receive_video(void *param, struct video_data *frame)
 		}
 	}
 
-	if (video_pause_check(&encoder->pause, frame->timestamp))
+	if (video_pause_check(&encoder->pause, frame->timestamp)) {
+		encoder->video_frame_skipped = true;
 		goto wait_for_audio;
+	}
 
 	handle_encoder_group_reconfigure_request(encoder);
 
+	if (!encoder->start_ts)
+		encoder->start_ts = frame->timestamp;
+
+	const bool duplicate = frame->duplicate && !encoder->video_frame_skipped;
+	encoder->video_frame_skipped = false;
+
+	if (encoder->encode_thread) {
+		encode_thread_queue_video(encoder, frame, duplicate);
+		goto wait_for_audio;
+	}
+
 	memset(&enc_frame, 0, sizeof(struct encoder_frame));
 
 	for (size_t i = 0; i < MAX_AV_PLANES; i++) {
@@ -1627,11 +1703,9 @@ static void receive_video(void *param, struct video_data *frame)
 		enc_frame.linesize[i] = frame->linesize[i];
 	}
 
-	if (!encoder->start_ts)
-		encoder->start_ts = frame->timestamp;
-
 	enc_frame.frames = 1;
 	enc_frame.pts = encoder->cur_pts;
+	enc_frame.duplicate = duplicate;
 
 	if (do_encode(encoder, &enc_frame, &frame->timestamp))
 		encoder->cur_pts += encoder->timebase_num * encoder->frame_rate_divisor;
@@ -1854,9 +1928,9 @@ static void receive_audio(void *param, size_t mix_idx, struct audio_data *in)
 		goto end;
 
 	while (encoder->audio_input_buffer[0].size >= encoder->framesize_bytes) {
-		if (!send_audio_data(encoder)) {
+		bool success = encoder->encode_thread ? encode_thread_queue_audio(encoder) : send_audio_data(encoder);
+		if (!success)
 			break;
-		}
 	}
 
 	UNUSED_PARAMETER(mix_idx);
@@ -1885,6 +1959,23 @@ void obs_encoder_remove_output(struct obs_encoder *encoder, struct obs_output *o
 	pthread_mutex_unlock(&encoder->outputs_mutex);
 }
 
+static inline void packet_buffer_ref(uint8_t *data)
+{
+	if (data) {
+		long *p_refs = ((long *)data) - 1;
+		os_atomic_inc_long(p_refs);
+	}
+}
+
+static inline void packet_buffer_release(uint8_t *data)
+{
+	if (data) {
+		long *p_refs = ((long *)data) - 1;
+		if (os_atomic_dec_long(p_refs) == 0)
+			bfree(p_refs);
+	}
+}
+
 void obs_encoder_packet_create_instance(struct encoder_packet *dst, const struct encoder_packet *src)
 {
 	long *p_refs;
@@ -1901,10 +1992,7 @@ void obs_encoder_packet_ref(struct encoder_packet *dst, struct encoder_packet *s
 	if (!src)
 		return;
 
-	if (src->data) {
-		long *p_refs = ((long *)src->data) - 1;
-		os_atomic_inc_long(p_refs);
-	}
+	packet_buffer_ref(src->data);
 
 	*dst = *src;
 }
@@ -1914,13 +2002,123 @@ void obs_encoder_packet_release(struct encoder_packet *pkt)
 	if (!pkt)
 		return;
 
-	if (pkt->data) {
-		long *p_refs = ((long *)pkt->data) - 1;
-		if (os_atomic_dec_long(p_refs) == 0)
-			bfree(p_refs);
+	packet_buffer_release(pkt->data);
+	memset(pkt, 0, sizeof(struct encoder_packet));
+}
+
+/* Prefix units of the packet currently being delivered to an output on this
+ * thread.  They are kept out of struct encoder_packet so its layout stays the
+ * same for plugins built against older headers. */
+static THREAD_LOCAL struct packet_prefix *cur_prefix = NULL;
+
+static inline struct packet_prefix *get_prefix(const struct encoder_packet *pkt)
+{
+	struct packet_prefix *prefix = cur_prefix;
+
+	if (!prefix || !pkt || !prefix->packet)
+		return NULL;
+	if (pkt != prefix->packet && pkt->data != prefix->packet->data)
+		return NULL;
+
+	return prefix;
+}
+
+void packet_prefix_begin(struct packet_prefix *prefix, struct encoder_packet *pkt)
+{
+	da_resize(prefix->units, 0);
+	prefix->packet = pkt;
+	cur_prefix = prefix;
+}
+
+void packet_prefix_end(struct packet_prefix *prefix)
+{
+	da_resize(prefix->units, 0);
+	prefix->packet = NULL;
+	cur_prefix = NULL;
+}
+
+/* Replaces the packet data with a copy that has the units inserted in front
+ * of the first coded slice/frame */
+static void insert_prefix(struct encoder_packet *pkt, const uint8_t *units, size_t units_size)
+{
+	size_t offset = obs_encoder_packet_prefix_offset(pkt);
+	size_t size = pkt->size + units_size;
+	long *p_refs = bmalloc(sizeof(long) + size);
+	uint8_t *data = (uint8_t *)(p_refs + 1);
+	*p_refs = 1;
+
+	memcpy(data, pkt->data, offset);
+	memcpy(data + offset, units, units_size);
+	memcpy(data + offset + units_size, pkt->data + offset, pkt->size - offset);
+
+	packet_buffer_release(pkt->data);
+
+	pkt->data = data;
+	pkt->size = size;
+}
+
+void obs_encoder_packet_add_prefix(struct encoder_packet *pkt, const uint8_t *data, size_t size)
+{
+	if (!pkt || !data || !size)
+		return;
+
+	struct packet_prefix *prefix = get_prefix(pkt);
+	if (prefix) {
+		da_push_back_array(prefix->units, data, size);
+		return;
 	}
 
-	memset(pkt, 0, sizeof(struct encoder_packet));
+	/* Not being delivered to an output, nothing would pick the units
+	 * up later */
+	insert_prefix(pkt, data, size);
+}
+
+bool obs_encoder_packet_get_prefix(const struct encoder_packet *pkt, const uint8_t **data, size_t *size)
+{
+	struct packet_prefix *prefix = get_prefix(pkt);
+
+	*data = NULL;
+	*size = 0;
+
+	if (!prefix || !prefix->units.num)
+		return false;
+
+	*data = prefix->units.array;
+	*size = prefix->units.num;
+	return true;
+}
+
+size_t obs_encoder_packet_prefix_offset(const struct encoder_packet *pkt)
+{
+	const char *codec = pkt->encoder ? obs_encoder_get_codec(pkt->encoder) : NULL;
+
+	if (!codec || pkt->type != OBS_ENCODER_VIDEO)
+		return pkt->size;
+
+	if (strcmp(codec, "h264") == 0)
+		return obs_avc_first_vcl_offset(pkt->data, pkt->size);
+	if (strcmp(codec, "av1") == 0)
+		return obs_av1_first_frame_offset(pkt->data, pkt->size);
+#ifdef ENABLE_HEVC
+	if (strcmp(codec, "hevc") == 0)
+		return obs_hevc_first_vcl_offset(pkt->data, pkt->size);
+#endif
+
+	return pkt->size;
+}
+
+void obs_encoder_packet_merge_prefix(struct encoder_packet *pkt)
+{
+	struct packet_prefix *prefix = get_prefix(pkt);
+
+	if (!prefix || !prefix->units.num)
+		return;
+
+	insert_prefix(pkt, prefix->units.array, prefix->units.num);
+	da_resize(prefix->units, 0);
+
+	/* lookups by data pointer have to find the new buffer */
+	prefix->packet = pkt;
 }
 
 void obs_encoder_set_preferred_video_format(obs_encoder_t *encoder, enum video_format format)
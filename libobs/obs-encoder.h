@@ -39,6 +39,7 @@ typedef struct obs_encoder obs_encoder_t;
 #define OBS_ENCODER_CAP_ROI (1 << 4)
 #define OBS_ENCODER_CAP_SCALING (1 << 5)
 #define OBS_ENCODER_CAP_MULTITRACK_DYN_BITRATE (1 << 6)
+#define OBS_ENCODER_CAP_THREADED (1 << 7)
 
 /** Specifies the encoder type */
 enum obs_encoder_type {
@@ -156,6 +157,12 @@ struct encoder_frame {
 
 	/** Presentation timestamp */
 	int64_t pts;
+
+	/**
+	 * Video only: the image is identical to the previous frame passed to
+	 * the encoder, so it can be encoded as a skipped/repeated frame
+	 */
+	bool duplicate;
 };
 
 /** Encoder region of interest */
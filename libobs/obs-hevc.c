@@ -46,6 +46,31 @@ bool obs_hevc_keyframe(const uint8_t *data, size_t size)
 	return false;
 }
 
+/* Returns the offset of the start code of the first VCL NAL, or size if there
+ * is none */
+size_t obs_hevc_first_vcl_offset(const uint8_t *data, size_t size)
+{
+	const uint8_t *end = data + size;
+	const uint8_t *start_code = obs_nal_find_startcode(data, end);
+
+	while (start_code < end) {
+		const uint8_t *nal_start = start_code;
+		while (nal_start < end && !*(nal_start++))
+			;
+
+		if (nal_start == end)
+			break;
+
+		const uint8_t type = (nal_start[0] & 0x7F) >> 1;
+		if (type < OBS_HEVC_NAL_VPS)
+			return start_code - data;
+
+		start_code = obs_nal_find_startcode(nal_start, end);
+	}
+
+	return size;
+}
+
 static int compute_hevc_keyframe_priority(const uint8_t *nal_start, bool *is_keyframe, int priority)
 {
 	int new_priority;
@@ -121,7 +146,19 @@ void obs_parse_hevc_packet(struct encoder_packet *hevc_packet, const struct enco
 	*hevc_packet = *src;
 
 	serialize(&s, &ref, sizeof(ref));
-	serialize_hevc_data(&s, src->data, src->size, &hevc_packet->keyframe, &hevc_packet->priority);
+
+	/* Prefix SEIs go after AUD/VPS/SPS/PPS, before the first slice */
+	const uint8_t *prefix;
+	size_t prefix_size;
+	obs_encoder_packet_get_prefix(src, &prefix, &prefix_size);
+
+	size_t vcl = prefix_size ? obs_hevc_first_vcl_offset(src->data, src->size) : src->size;
+	serialize_hevc_data(&s, src->data, vcl, &hevc_packet->keyframe, &hevc_packet->priority);
+	if (prefix_size) {
+		serialize_hevc_data(&s, prefix, prefix_size, &hevc_packet->keyframe, &hevc_packet->priority);
+		serialize_hevc_data(&s, src->data + vcl, src->size - vcl, &hevc_packet->keyframe,
+				    &hevc_packet->priority);
+	}
 
 	hevc_packet->data = output.bytes.array + sizeof(ref);
 	hevc_packet->size = output.bytes.num - sizeof(ref);
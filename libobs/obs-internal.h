@@ -35,6 +35,7 @@
 
 #include "media-io/audio-resampler.h"
 #include "media-io/video-io.h"
+#include "media-io/video-frame.h"
 #include "media-io/audio-io.h"
 
 #include "obs.h"
@@ -51,6 +52,7 @@
 #define MICROSECOND_DEN 1000000
 #define NUM_ENCODE_TEXTURES 10
 #define NUM_ENCODE_TEXTURE_FRAMES_TO_WAIT 1
+#define ENCODE_THREAD_QUEUE_SIZE 8
 
 static inline int64_t packet_dts_usec(struct encoder_packet *packet)
 {
@@ -78,6 +80,16 @@ struct packet_callback {
 	void *param;
 };
 
+/* SEI NAL units/metadata OBUs (captions, metrics) attached to a packet while
+ * it is being delivered to an output, see obs_encoder_packet_add_prefix */
+struct packet_prefix {
+	struct encoder_packet *packet;
+	DARRAY(uint8_t) units;
+};
+
+extern void packet_prefix_begin(struct packet_prefix *prefix, struct encoder_packet *pkt);
+extern void packet_prefix_end(struct packet_prefix *prefix);
+
 struct reconnect_callback {
 	bool (*reconnect_cb)(void *data, obs_output_t *output, int code);
 	void *param;
@@ -299,12 +311,29 @@ struct obs_display {
 	DARRAY(struct draw_callback) draw_callbacks;
 	bool use_clear_workaround;
 
+	/* see obs_display_set_max_fps / obs_display_set_occluded */
+	volatile bool occluded;
+	uint64_t min_interval_ns;
+	uint64_t last_render_ns;
+
+	/* presented from the present thread, see obs-display.c */
+	bool present_offload;
+	gs_texture_t *present_tex;
+	volatile long present_handle;
+	volatile long present_generation;
+	volatile long present_space;
+	gs_texture_t *present_tex_p;
+	uint32_t present_handle_p;
+	long present_generation_p;
+
 	struct obs_display *next;
 	struct obs_display **prev_next;
 };
 
 extern bool obs_display_init(struct obs_display *display, const struct gs_init_data *graphics_data);
 extern void obs_display_free(struct obs_display *display);
+extern void obs_display_present_init(const char *module, uint32_t adapter);
+extern void obs_display_present_free(void);
 
 /* ------------------------------------------------------------------------- */
 /* core */
@@ -341,9 +370,14 @@ struct obs_core_video_mix {
 #endif
 	gs_texture_t *render_texture;
 	gs_texture_t *output_texture;
+	/* horizontal pass of separable scaling, see obs_draw_separable_scale */
+	gs_texrender_t *scale_texrender;
 	enum gs_color_space render_space;
 	bool texture_rendered;
+	/* output_texture holds a scaled image of the current frame */
+	bool output_scaled;
 	bool textures_copied[NUM_TEXTURES];
+	bool textures_duplicate[NUM_TEXTURES];
 	bool texture_converted;
 	bool using_nv12_tex;
 	bool using_p010_tex;
@@ -377,6 +411,11 @@ struct obs_core_video_mix {
 
 	float color_matrix[16];
 
+	/* render state of the last rendered frame, frames with the same state
+	 * reuse the previous output (see mix_frame_unchanged) */
+	uint64_t frame_gen;
+	bool frame_gen_valid;
+
 	bool encoder_only_mix;
 	long encoder_refs;
 
@@ -396,11 +435,46 @@ struct obs_core_video {
 	gs_effect_t *conversion_effect;
 	gs_effect_t *bicubic_effect;
 	gs_effect_t *lanczos_effect;
+	gs_effect_t *separable_scale_effect;
 	gs_effect_t *area_effect;
 	gs_effect_t *bilinear_lowres_effect;
 	gs_effect_t *premultiplied_alpha_effect;
 	gs_samplerstate_t *point_sampler;
 
+	/* compiles effect passes ahead of their first use, see
+	 * obs_warm_up_effects */
+	pthread_t effect_warmup_thread;
+	bool effect_warmup_active;
+	volatile bool effect_warmup_stop;
+
+	/* separate device presenting displays, see obs-display.c */
+	graphics_t *present_graphics;
+	gs_effect_t *present_effect;
+	pthread_mutex_t present_mutex;
+	os_event_t *present_event;
+	pthread_t present_thread;
+	bool present_thread_active;
+	volatile bool present_stop;
+
+	/* see obs_set_frame_pacing, spin_ns is the calibrated spin tail of
+	 * precise pacing, wake_latency_ns the average oversleep it covers */
+	volatile long frame_pacing;
+	bool pacing_realtime;
+	uint64_t pacing_spin_ns;
+	uint64_t pacing_wake_latency_ns;
+
+	/* virtual clock of freewheel mode, see obs_set_freewheel.  time is
+	 * the last rendered frame, now the frame rendered next (the clock
+	 * read by other threads), audio_next the audio tick waiting for it */
+	volatile bool freewheel;
+	bool freewheel_active;
+	pthread_mutex_t freewheel_mutex;
+	os_event_t *freewheel_video_event;
+	os_event_t *freewheel_audio_event;
+	uint64_t freewheel_time;
+	uint64_t freewheel_now;
+	uint64_t freewheel_audio_next;
+
 	uint64_t video_time;
 	uint64_t video_frame_interval_ns;
 	uint64_t video_half_frame_interval_ns;
@@ -409,10 +483,22 @@ struct obs_core_video {
 	pthread_t video_thread;
 	uint32_t total_frames;
 	uint32_t lagged_frames;
+	uint32_t unchanged_frames;
 	bool thread_initialized;
 
+	/* scene item textures reused from a previous frame / re-rendered */
+	uint64_t scene_cache_hits;
+	uint64_t scene_cache_misses;
+
+	/* source draws served from / rendered into a source's render memo */
+	uint64_t render_memo_hits;
+	uint64_t render_memo_renders;
+
 	gs_texture_t *transparent_texture;
 
+	/* graphics thread only, see obs-sprite-batch.c */
+	struct sprite_batch *sprite_batch;
+
 	gs_effect_t *deinterlace_discard_effect;
 	gs_effect_t *deinterlace_discard_2x_effect;
 	gs_effect_t *deinterlace_linear_effect;
@@ -437,6 +523,13 @@ struct obs_core_video {
 
 extern void add_ready_encoder_group(obs_encoder_t *encoder);
 
+/* Batched drawing of scene items that are simple quads, sprite_batch_add
+ * returns false if the source has to be rendered normally, in which case
+ * queued sprites must be flushed first to keep the draw order. */
+extern bool sprite_batch_add(obs_source_t *source, const struct matrix4 *transform);
+extern void sprite_batch_flush(void);
+extern void sprite_batch_free(void);
+
 struct audio_monitor;
 
 struct obs_core_audio {
@@ -600,6 +693,8 @@ extern gs_effect_t *obs_load_effect(gs_effect_t **effect, const char *file);
 
 extern bool audio_callback(void *param, uint64_t start_ts_in, uint64_t end_ts_in, uint64_t *out_ts, uint32_t mixers,
 			   struct audio_output_data *mixes);
+extern enum audio_clock_state obs_freewheel_audio_clock(void *param, uint64_t audio_time);
+extern uint64_t obs_clock_ns(void);
 
 extern struct obs_core_video_mix *get_mix_for_video(video_t *video);
 
@@ -755,6 +850,30 @@ struct async_frame {
 	bool used;
 };
 
+/* Upload slots of the async textures (see gs_texture_map_slot) that the next
+ * frame is copied into on the thread that outputs it, so the graphics thread
+ * only has to issue the texture copy */
+struct async_upload {
+	pthread_mutex_t mutex;
+	bool mapped;
+	gs_texture_t *tex[MAX_AV_PLANES];
+	uint32_t slot[MAX_AV_PLANES];
+	uint8_t *data[MAX_AV_PLANES];
+	uint32_t linesize[MAX_AV_PLANES];
+	uint32_t lines[MAX_AV_PLANES];
+
+	/* frame layout the textures were created for */
+	enum video_format format;
+	uint32_t width;
+	uint32_t height;
+	bool full_range;
+	uint8_t trc;
+
+	/* cached frame whose data is in the slots */
+	struct obs_source_frame *frame;
+	uint64_t timestamp;
+};
+
 enum audio_action_type {
 	AUDIO_ACTION_VOL,
 	AUDIO_ACTION_MUTE,
@@ -842,6 +961,10 @@ struct obs_source {
 	/* used to temporarily disable sources if needed */
 	bool enabled;
 
+	/* incremented whenever the video of the source may have changed, see
+	 * obs_source_get_video_gen */
+	volatile long video_gen;
+
 	/* hint to allow sources to render more quickly */
 	bool texcoords_centered;
 
@@ -919,6 +1042,7 @@ struct obs_source {
 	uint32_t async_convert_width[MAX_AV_PLANES];
 	uint32_t async_convert_height[MAX_AV_PLANES];
 	uint64_t async_last_rendered_ts;
+	struct async_upload async_upload;
 
 	pthread_mutex_t caption_cb_mutex;
 	DARRAY(struct caption_cb_info) caption_cb_list;
@@ -945,6 +1069,27 @@ struct obs_source {
 	bool rendering_filter;
 	bool filter_bypass_active;
 
+	/* graphics thread only, filters below this one that are drawn as part
+	 * of its pass and the source they are applied to, see
+	 * obs-source-fused.c */
+	DARRAY(struct obs_source *) fused_chain;
+	DARRAY(const char *) fused_shaders;
+	DARRAY(const char *) fused_effect_shaders;
+	struct obs_source *fused_target;
+	gs_effect_t *fused_effect;
+
+	/* graphics thread only, output of the source rendered once for all
+	 * of its draws in a frame, see render_video_memo */
+	gs_texrender_t *render_memo;
+	uint64_t render_memo_frame;
+	uint32_t render_memo_draws;
+	uint32_t render_memo_prev_draws;
+	uint32_t render_memo_cx;
+	uint32_t render_memo_cy;
+	enum gs_color_space render_memo_space;
+	bool render_memo_valid;
+	bool render_memo_active;
+
 	/* sources specific hotkeys */
 	obs_hotkey_pair_id mute_unmute_key;
 	obs_hotkey_id push_to_mute_key;
@@ -1011,6 +1156,7 @@ extern bool obs_source_init_context(struct obs_source *source, obs_data_t *setti
 extern bool obs_transition_init(obs_source_t *transition);
 extern void obs_transition_free(obs_source_t *transition);
 extern void obs_transition_tick(obs_source_t *transition, float t);
+extern bool obs_transition_get_video_gen(obs_source_t *transition, uint64_t *gen);
 extern void obs_transition_enum_sources(obs_source_t *transition, obs_source_enum_proc_t enum_callback, void *param);
 extern void obs_transition_save(obs_source_t *source, obs_data_t *data);
 extern void obs_transition_load(obs_source_t *source, obs_data_t *data);
@@ -1123,6 +1269,23 @@ extern void obs_source_deactivate(obs_source_t *source, enum view_type type);
 extern void obs_source_video_tick(obs_source_t *source, float seconds);
 extern float obs_source_get_target_volume(obs_source_t *source, obs_source_t *target);
 extern uint64_t obs_source_get_last_async_ts(const obs_source_t *source);
+extern bool obs_source_get_video_gen(obs_source_t *source, uint64_t *gen);
+extern bool obs_scene_get_video_gen(obs_scene_t *scene, uint64_t *gen);
+
+#define VIDEO_GEN_HASH_INIT 0xcbf29ce484222325ULL
+
+/* FNV-1a, only used to detect changes of render state between frames */
+static inline uint64_t video_gen_hash(uint64_t hash, const void *data, size_t size)
+{
+	const uint8_t *bytes = data;
+
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 0x100000001b3ULL;
+	}
+
+	return hash;
+}
 
 extern void obs_source_audio_render(obs_source_t *source, uint32_t mixers, size_t channels, size_t sample_rate,
 				    size_t size);
@@ -1135,6 +1298,7 @@ extern bool update_async_texture(struct obs_source *source, const struct obs_sou
 extern bool update_async_textures(struct obs_source *source, const struct obs_source_frame *frame,
 				  gs_texture_t *tex[MAX_AV_PLANES], gs_texrender_t *texrender);
 extern bool set_async_texture_size(struct obs_source *source, const struct obs_source_frame *frame);
+extern void release_async_upload(struct obs_source *source);
 extern void remove_async_frame(obs_source_t *source, struct obs_source_frame *frame);
 
 extern void set_deinterlace_texture_size(obs_source_t *source);
@@ -1142,6 +1306,11 @@ extern void deinterlace_process_last_frame(obs_source_t *source, uint64_t sys_ti
 extern void deinterlace_update_async_video(obs_source_t *source);
 extern void deinterlace_render(obs_source_t *s);
 
+extern obs_source_t *fused_filter_begin(obs_source_t *filter, obs_source_t *target, obs_source_t *parent);
+extern gs_effect_t *fused_filter_get_effect(obs_source_t *filter);
+extern void fused_filter_end(obs_source_t *filter);
+extern void fused_filter_free(obs_source_t *filter);
+
 /* ------------------------------------------------------------------------- */
 /* outputs  */
 
@@ -1283,6 +1452,8 @@ struct obs_output {
 	pthread_mutex_t pkt_callbacks_mutex;
 	DARRAY(struct packet_callback) pkt_callbacks;
 
+	struct packet_prefix packet_prefix;
+
 	struct reconnect_callback reconnect_callback;
 
 	bool valid;
@@ -1339,6 +1510,43 @@ struct encoder_callback {
 	void *param;
 };
 
+struct encode_thread_frame {
+	/* audio: plane buffers owned by the queue */
+	uint8_t *audio[MAX_AV_PLANES];
+
+	/* video: image of the referenced video-io buffer */
+	struct video_frame video;
+	struct video_frame_ref *video_ref;
+
+	int64_t pts;
+	uint64_t timestamp;
+	bool reconfigure;
+	bool duplicate;
+};
+
+/* Bounded single-producer/single-consumer frame queue feeding a dedicated
+ * encode thread. Slots are handed over via the free/frames semaphores, so
+ * the producer never takes a lock. */
+struct encode_thread {
+	pthread_t thread;
+	bool thread_joined;
+
+	os_sem_t *frames_sem;
+	os_sem_t *free_sem;
+	volatile bool stopping;
+	volatile long queued;
+
+	struct encode_thread_frame frames[ENCODE_THREAD_QUEUE_SIZE];
+	size_t write_idx;
+	size_t read_idx;
+	bool warned_full;
+
+	/* video only */
+	bool video;
+	long dropped_frames;
+	bool frame_dropped;
+};
+
 struct obs_encoder_group {
 	pthread_mutex_t mutex;
 	/* allows group to be destroyed even if some encoders are active */
@@ -1409,6 +1617,16 @@ struct obs_encoder {
 	// Number of frames successfully encoded
 	uint32_t encoded_frames;
 
+	/* Time spent in the encode callback since the encoder was started,
+	 * protected by callbacks_mutex */
+	uint64_t encode_time_total_ns;
+	uint64_t encode_time_count;
+
+	/* Encode on a dedicated thread instead of the raw data callback,
+	 * see obs-encoder-thread.c */
+	bool threaded;
+	struct encode_thread *encode_thread;
+
 	/* Regions of interest to prioritize during encoding */
 	pthread_mutex_t roi_mutex;
 	DARRAY(struct obs_encoder_roi) roi;
@@ -1428,6 +1646,9 @@ struct obs_encoder {
 	uint64_t first_raw_ts;
 	uint64_t start_ts;
 
+	/* a raw frame was not passed on, so the next one is not a duplicate */
+	bool video_frame_skipped;
+
 	/* track encoders that are part of a gop-aligned multi track group */
 	struct obs_encoder_group *encoder_group;
 	uint64_t last_reconfigure_request;
@@ -1469,6 +1690,12 @@ extern void obs_encoder_remove_output(struct obs_encoder *encoder, struct obs_ou
 extern bool start_gpu_encode(obs_encoder_t *encoder);
 extern void stop_gpu_encode(obs_encoder_t *encoder);
 
+extern void start_encode_thread(obs_encoder_t *encoder);
+extern void stop_encode_thread(obs_encoder_t *encoder);
+extern void free_encode_thread(obs_encoder_t *encoder);
+extern bool encode_thread_queue_audio(obs_encoder_t *encoder);
+extern void encode_thread_queue_video(obs_encoder_t *encoder, struct video_data *frame, bool duplicate);
+
 extern bool do_encode(struct obs_encoder *encoder, struct encoder_frame *frame, const uint64_t *frame_cts);
 extern void send_off_encoder_packet(obs_encoder_t *encoder, bool success, bool received, struct encoder_packet *pkt);
 
@@ -1531,5 +1758,10 @@ extern uint64_t source_profiler_source_render_begin(gs_timer_t **timer);
 /* Submit start timestamp and GPU timer after rendering source */
 extern void source_profiler_source_render_end(obs_source_t *source, uint64_t start, gs_timer_t *timer);
 
+/* Open/close a named section (filter, technique pass, format conversion)
+ * within the rendering of a source, sections nest */
+extern void source_profiler_section_begin(obs_source_t *source, const char *format, ...);
+extern void source_profiler_section_end(obs_source_t *source);
+
 /* Remove source from profiler hashmaps */
 extern void source_profiler_remove_source(obs_source_t *source);
@@ -27,6 +27,7 @@ enum obs_nix_platform_type {
 	OBS_NIX_PLATFORM_INVALID,
 	OBS_NIX_PLATFORM_X11_EGL,
 	OBS_NIX_PLATFORM_WAYLAND,
+	OBS_NIX_PLATFORM_SURFACELESS,
 };
 
 /**
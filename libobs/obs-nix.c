@@ -419,6 +419,51 @@ void log_system_info(void)
 		obs_nix_x11_log_info();
 }
 
+/* headless instances have no keyboard to read from */
+static bool headless_hotkeys_init(struct obs_core_hotkeys *hotkeys)
+{
+	UNUSED_PARAMETER(hotkeys);
+	return true;
+}
+
+static void headless_hotkeys_free(struct obs_core_hotkeys *hotkeys)
+{
+	UNUSED_PARAMETER(hotkeys);
+}
+
+static bool headless_hotkeys_is_pressed(obs_hotkeys_platform_t *context, obs_key_t key)
+{
+	UNUSED_PARAMETER(context);
+	UNUSED_PARAMETER(key);
+	return false;
+}
+
+static void headless_key_to_str(obs_key_t key, struct dstr *dstr)
+{
+	dstr_copy(dstr, obs_key_to_name(key));
+}
+
+static obs_key_t headless_key_from_virtual_key(int sym)
+{
+	UNUSED_PARAMETER(sym);
+	return OBS_KEY_NONE;
+}
+
+static int headless_key_to_virtual_key(obs_key_t key)
+{
+	UNUSED_PARAMETER(key);
+	return 0;
+}
+
+static const struct obs_nix_hotkeys_vtable headless_hotkeys_vtable = {
+	.init = headless_hotkeys_init,
+	.free = headless_hotkeys_free,
+	.is_pressed = headless_hotkeys_is_pressed,
+	.key_to_str = headless_key_to_str,
+	.key_from_virtual_key = headless_key_from_virtual_key,
+	.key_to_virtual_key = headless_key_to_virtual_key,
+};
+
 bool obs_hotkeys_platform_init(struct obs_core_hotkeys *hotkeys)
 {
 	switch (obs_get_nix_platform()) {
@@ -430,6 +475,9 @@ bool obs_hotkeys_platform_init(struct obs_core_hotkeys *hotkeys)
 		hotkeys_vtable = obs_nix_wayland_get_hotkeys_vtable();
 		break;
 #endif
+	case OBS_NIX_PLATFORM_SURFACELESS:
+		hotkeys_vtable = &headless_hotkeys_vtable;
+		break;
 	default:
 		break;
 	}
@@ -332,6 +332,7 @@ void obs_output_destroy(obs_output_t *output)
 			da_free(output->encoder_packet_times[i]);
 
 		da_free(output->pkt_callbacks);
+		da_free(output->packet_prefix.units);
 
 		clear_raw_audio_buffers(output);
 
@@ -544,7 +545,7 @@ void obs_output_stop(obs_output_t *output)
 		obs_output_delay_stop(output);
 	} else if (!stopping(output)) {
 		do_output_signal(output, "stopping");
-		obs_output_actual_stop(output, false, os_gettime_ns());
+		obs_output_actual_stop(output, false, obs_clock_ns());
 	}
 }
 
@@ -657,7 +658,7 @@ static inline uint64_t get_closest_v_ts(struct pause_data *pause)
 {
 	uint64_t interval = obs->video.video_frame_interval_ns;
 	uint64_t i2 = interval * 2;
-	uint64_t ts = os_gettime_ns();
+	uint64_t ts = obs_clock_ns();
 
 	return pause->last_video_ts + ((ts - pause->last_video_ts + i2) / interval) * interval;
 }
@@ -1498,11 +1499,9 @@ static size_t extract_buffer_from_sei(sei_t *sei, uint8_t **data_out)
 static const uint8_t nal_start[4] = {0, 0, 0, 1};
 static bool add_caption(struct obs_output *output, struct encoder_packet *out)
 {
-	struct encoder_packet backup = *out;
 	sei_t sei;
 	uint8_t *data = NULL;
 	size_t size;
-	long ref = 1;
 	bool avc = false;
 	bool hevc = false;
 	bool av1 = false;
@@ -1558,9 +1557,10 @@ static bool add_caption(struct obs_output *output, struct encoder_packet *out)
 #endif
 	sei_init(&sei, 0.0);
 
+	/* The caption SEI/OBU is attached as a prefix unit rather than
+	 * appended to a copy of the packet data, muxers insert it in front
+	 * of the first slice/frame. */
 	da_init(out_data);
-	da_push_back_array(out_data, (uint8_t *)&ref, sizeof(ref));
-	da_push_back_array(out_data, out->data, out->size);
 
 	if (ctrack->caption_data.size > 0) {
 
@@ -1627,8 +1627,6 @@ static bool add_caption(struct obs_output *output, struct encoder_packet *out)
 		 * mechanisms. A slightly modified SEI for HEVC and a metadata
 		 * OBU for AV1. */
 		if (avc) {
-			/* TODO: SEI should come after AUD/SPS/PPS,
-			 * but before any VCL */
 			da_push_back_array(out_data, nal_start, 4);
 			da_push_back_array(out_data, data, size);
 #ifdef ENABLE_HEVC
@@ -1643,11 +1641,15 @@ static bool add_caption(struct obs_output *output, struct encoder_packet *out)
 			 * nuh_temporal_id_plus1    u(3)
 			 * }
 			 */
-			const uint8_t suffix_sei_nal_type = 40;
+			/* The units are inserted in front of the first slice
+			 * of the access unit, where only prefix SEIs (39) are
+			 * allowed; suffix SEIs (40) have to follow a VCL NAL
+			 * unit (H.265 7.4.2.4.4). */
+			const uint8_t prefix_sei_nal_type = 39;
 			/* The first bit is always 0, so we just need to
 			 * save the last bit off the original header and
 			 * add the SEI NAL type. */
-			uint8_t first_byte = (suffix_sei_nal_type << 1) | (0x01 & hevc_nal_header[0]);
+			uint8_t first_byte = (prefix_sei_nal_type << 1) | (0x01 & hevc_nal_header[0]);
 			hevc_nal_header[0] = first_byte;
 			/* The HEVC NAL unit header is 2 byte instead of
 			 * one, otherwise everything else is the
@@ -1668,12 +1670,9 @@ static bool add_caption(struct obs_output *output, struct encoder_packet *out)
 		if (data) {
 			bfree(data);
 		}
-		obs_encoder_packet_release(out);
-
-		*out = backup;
-		out->data = (uint8_t *)out_data.array + sizeof(ref);
-		out->size = out_data.num - sizeof(ref);
+		obs_encoder_packet_add_prefix(out, out_data.array, out_data.num);
 	}
+	da_free(out_data);
 	sei_free(&sei);
 	return avc || hevc || av1;
 }
@@ -1686,6 +1685,8 @@ static inline void send_interleaved(struct obs_output *output)
 
 	da_erase(output->interleaved_packets, 0);
 
+	packet_prefix_begin(&output->packet_prefix, &out);
+
 	if (out.type == OBS_ENCODER_VIDEO) {
 		output->total_frames++;
 
@@ -1753,7 +1754,13 @@ static inline void send_interleaved(struct obs_output *output)
 	}
 	pthread_mutex_unlock(&output->pkt_callbacks_mutex);
 
+	/* Outputs that do not handle prefix units get them merged into the
+	 * packet data */
+	if (!(output->info.flags & OBS_OUTPUT_PACKET_PREFIX))
+		obs_encoder_packet_merge_prefix(&out);
+
 	output->info.encoded_packet(output->context.data, &out);
+	packet_prefix_end(&output->packet_prefix);
 	obs_encoder_packet_release(&out);
 }
 
@@ -2710,8 +2717,6 @@ static void reset_raw_output(obs_output_t *output)
 
 static void calculate_batch_size(struct obs_output *output)
 {
-	struct obs_video_info ovi;
-	obs_get_video_info(&ovi);
 	DARRAY(uint64_t) intervals;
 	da_init(intervals);
 
@@ -2722,8 +2727,14 @@ static void calculate_batch_size(struct obs_output *output)
 		if (!output->video_encoders[i])
 			continue;
 
-		uint32_t den = ovi.fps_den * obs_encoder_get_frame_rate_divisor(output->video_encoders[i]);
-		uint64_t encoder_interval = util_mul_div64(1000000000ULL, den, ovi.fps_num);
+		/* Use the encoder's own video_t (which already accounts for its
+		 * frame rate divisor), encoders are not necessarily fed by the
+		 * main canvas and libobs may run without obs_reset_video(). */
+		const struct video_output_info *voi = video_output_get_info(obs_encoder_video(output->video_encoders[i]));
+		if (!voi)
+			continue;
+
+		uint64_t encoder_interval = util_mul_div64(1000000000ULL, voi->fps_den, voi->fps_num);
 		da_push_back(intervals, &encoder_interval);
 
 		largest_interval = encoder_interval > largest_interval ? encoder_interval : largest_interval;
@@ -32,6 +32,7 @@ extern "C" {
 #define OBS_OUTPUT_MULTI_TRACK_AUDIO OBS_OUTPUT_MULTI_TRACK
 #define OBS_OUTPUT_MULTI_TRACK_VIDEO (1 << 6)
 #define OBS_OUTPUT_MULTI_TRACK_AV (OBS_OUTPUT_MULTI_TRACK_AUDIO | OBS_OUTPUT_MULTI_TRACK_VIDEO)
+#define OBS_OUTPUT_PACKET_PREFIX (1 << 7)
 
 #define MAX_OUTPUT_AUDIO_ENCODERS 6
 #define MAX_OUTPUT_VIDEO_ENCODERS 10
@@ -894,6 +894,51 @@ static bool are_texcoords_centered(struct matrix4 *m)
 	return memcmp(m, &copy, sizeof(*m)) == 0;
 }
 
+/* Everything that went into item_render, see obs_source_get_video_gen */
+static bool item_cache_key(struct obs_scene_item *item, uint32_t width, uint32_t height, uint32_t cx, uint32_t cy,
+			   enum gs_color_space space, uint64_t *key)
+{
+	uint64_t hash = VIDEO_GEN_HASH_INIT;
+	uint64_t source_gen;
+
+	if (transition_active(item->show_transition) || transition_active(item->hide_transition))
+		return false;
+	if (!obs_source_get_video_gen(item->source, &source_gen))
+		return false;
+
+	hash = video_gen_hash(hash, &source_gen, sizeof(source_gen));
+	hash = video_gen_hash(hash, &width, sizeof(width));
+	hash = video_gen_hash(hash, &height, sizeof(height));
+	hash = video_gen_hash(hash, &cx, sizeof(cx));
+	hash = video_gen_hash(hash, &cy, sizeof(cy));
+	hash = video_gen_hash(hash, &item->crop, sizeof(item->crop));
+	hash = video_gen_hash(hash, &item->bounds_crop, sizeof(item->bounds_crop));
+	hash = video_gen_hash(hash, &space, sizeof(space));
+
+	*key = hash;
+	return true;
+}
+
+/* Called on the first render of the item each frame, decides whether the
+ * texture from a previous frame can be drawn as is */
+static void check_item_cache(struct obs_scene_item *item, uint32_t width, uint32_t height, uint32_t cx, uint32_t cy,
+			     enum gs_color_space space)
+{
+	uint64_t key;
+
+	item->cache_checked = true;
+
+	if (item->cache_valid && item_cache_key(item, width, height, cx, cy, space, &key) &&
+	    key == item->cache_key && gs_texrender_get_texture(item->item_render)) {
+		obs->video.scene_cache_hits++;
+		return;
+	}
+
+	gs_texrender_reset(item->item_render);
+	item->cache_valid = false;
+	obs->video.scene_cache_misses++;
+}
+
 static inline void render_item(struct obs_scene_item *item)
 {
 	GS_DEBUG_MARKER_BEGIN_FORMAT(GS_DEBUG_COLOR_ITEM, "Item: %s", obs_source_get_name(item->source));
@@ -912,6 +957,7 @@ static inline void render_item(struct obs_scene_item *item)
 
 	if (!item->item_render && use_texrender) {
 		item->item_render = gs_texrender_create(format, GS_ZS_NONE);
+		item->cache_valid = false;
 	}
 
 	if (item->item_render) {
@@ -925,6 +971,9 @@ static inline void render_item(struct obs_scene_item *item)
 		uint32_t cx = calc_cx(item, width);
 		uint32_t cy = calc_cy(item, height);
 
+		if (!item->cache_checked)
+			check_item_cache(item, width, height, cx, cy, source_space);
+
 		if (cx && cy && gs_texrender_begin_with_color_space(item->item_render, cx, cy, source_space)) {
 			float cx_scale = (float)width / (float)cx;
 			float cy_scale = (float)height / (float)cy;
@@ -955,6 +1004,11 @@ static inline void render_item(struct obs_scene_item *item)
 			}
 
 			gs_texrender_end(item->item_render);
+
+			/* Rendering updates nested transforms, so the key is
+			 * taken afterwards to match what was drawn */
+			item->cache_valid =
+				item_cache_key(item, width, height, cx, cy, source_space, &item->cache_key);
 		}
 	}
 
@@ -987,6 +1041,25 @@ cleanup:
 	GS_DEBUG_MARKER_END();
 }
 
+/* Items drawn as is, without their own texture, can be merged with their
+ * neighbours into a single draw */
+static bool batch_item(struct obs_scene_item *item)
+{
+	if (!item->user_visible || transition_active(item->show_transition) ||
+	    transition_active(item->hide_transition))
+		return false;
+	if (item_texture_enabled(item))
+		return false;
+	if (!sprite_batch_add(item->source, &item->draw_transform))
+		return false;
+
+	if (item->item_render) {
+		gs_texrender_destroy(item->item_render);
+		item->item_render = NULL;
+	}
+	return true;
+}
+
 static void scene_video_tick(void *data, float seconds)
 {
 	struct obs_scene *scene = data;
@@ -995,8 +1068,7 @@ static void scene_video_tick(void *data, float seconds)
 	video_lock(scene);
 	item = scene->first_item;
 	while (item) {
-		if (item->item_render)
-			gs_texrender_reset(item->item_render);
+		item->cache_checked = false;
 		item = item->next;
 	}
 	video_unlock(scene);
@@ -1076,12 +1148,15 @@ static void scene_video_render(void *data, gs_effect_t *effect)
 
 	item = scene->first_item;
 	while (item) {
-		if (item->user_visible || transition_active(item->hide_transition))
+		if ((item->user_visible || transition_active(item->hide_transition)) && !batch_item(item)) {
+			sprite_batch_flush();
 			render_item(item);
+		}
 
 		item = item->next;
 	}
 
+	sprite_batch_flush();
 	gs_blend_state_pop();
 
 	video_unlock(scene);
@@ -1093,6 +1168,65 @@ static void scene_video_render(void *data, gs_effect_t *effect)
 	UNUSED_PARAMETER(effect);
 }
 
+/* Returns false if an item may draw differently without its source changing */
+static bool hash_item_video_state(struct obs_scene_item *item, uint64_t *hash)
+{
+	uint64_t source_gen;
+
+	if (transition_active(item->show_transition) || transition_active(item->hide_transition))
+		return false;
+	if (os_atomic_load_bool(&item->update_transform) || os_atomic_load_bool(&item->update_group_resize))
+		return false;
+	if (obs_source_removed(item->source) || source_size_changed(item))
+		return false;
+
+	*hash = video_gen_hash(*hash, &item->id, sizeof(item->id));
+	*hash = video_gen_hash(*hash, &item->user_visible, sizeof(item->user_visible));
+
+	if (!item->user_visible)
+		return true;
+	if (!obs_source_get_video_gen(item->source, &source_gen))
+		return false;
+
+	*hash = video_gen_hash(*hash, &source_gen, sizeof(source_gen));
+	*hash = video_gen_hash(*hash, &item->draw_transform, sizeof(item->draw_transform));
+	*hash = video_gen_hash(*hash, &item->crop, sizeof(item->crop));
+	*hash = video_gen_hash(*hash, &item->bounds_crop, sizeof(item->bounds_crop));
+	*hash = video_gen_hash(*hash, &item->output_scale, sizeof(item->output_scale));
+	*hash = video_gen_hash(*hash, &item->scale_filter, sizeof(item->scale_filter));
+	*hash = video_gen_hash(*hash, &item->blend_method, sizeof(item->blend_method));
+	*hash = video_gen_hash(*hash, &item->blend_type, sizeof(item->blend_type));
+	return true;
+}
+
+/* Used by obs_source_get_video_gen for scenes and groups, lets a parent scene
+ * keep the texture of a nested scene while nothing in it changes */
+bool obs_scene_get_video_gen(obs_scene_t *scene, uint64_t *gen)
+{
+	uint64_t hash = VIDEO_GEN_HASH_INIT;
+	bool cacheable = true;
+	uint32_t cx, cy;
+
+	video_lock(scene);
+
+	cx = scene_getwidth(scene);
+	cy = scene_getheight(scene);
+	hash = video_gen_hash(hash, &cx, sizeof(cx));
+	hash = video_gen_hash(hash, &cy, sizeof(cy));
+
+	for (struct obs_scene_item *item = scene->first_item; item; item = item->next) {
+		if (!hash_item_video_state(item, &hash)) {
+			cacheable = false;
+			break;
+		}
+	}
+
+	video_unlock(scene);
+
+	*gen = hash;
+	return cacheable;
+}
+
 static void set_visibility(struct obs_scene_item *item, bool vis)
 {
 	pthread_mutex_lock(&item->actions_mutex);
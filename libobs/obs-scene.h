@@ -51,6 +51,12 @@ struct obs_scene_item {
 	gs_texrender_t *item_render;
 	struct obs_sceneitem_crop crop;
 
+	/* item_render is kept across frames as long as cache_key stays the
+	 * same, cache_checked is cleared every tick */
+	bool cache_checked;
+	bool cache_valid;
+	uint64_t cache_key;
+
 	bool absolute_coordinates;
 	struct vec2 pos;
 	struct vec2 scale;
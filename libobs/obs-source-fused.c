@@ -0,0 +1,249 @@
+/******************************************************************************
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "obs-internal.h"
+
+/*
+ * Fused filter chains
+ *
+ * Effect filters normally render their target into their own texrender and
+ * then draw that with their effect, so every filter in a chain costs a full
+ * render target round trip.  Filters that implement
+ * obs_source_info.video_get_fused_shader describe themselves as a per-pixel
+ * function instead.  When a fusable filter is processed and the filters
+ * below it are fusable as well, their functions are compiled together with
+ * its own into one effect, and the source below the fused run is rendered
+ * directly into the texrender of the outermost filter.  The filters inside
+ * the run are not rendered at all for that frame.
+ *
+ * Identifiers in the shader code starting with '$' are replaced with a
+ * prefix unique to the position of the filter in the run, the filter then
+ * looks up its parameters with that prefix in video_set_fused_params.
+ */
+
+static const char *fused_effect_header = "\
+uniform float4x4 ViewProj;\n\
+uniform texture2d image;\n\
+\n\
+sampler_state textureSampler {\n\
+	Filter    = Linear;\n\
+	AddressU  = Clamp;\n\
+	AddressV  = Clamp;\n\
+};\n\
+\n\
+struct VertData {\n\
+	float4 pos : POSITION;\n\
+	float2 uv  : TEXCOORD0;\n\
+};\n\
+\n\
+VertData VSDefault(VertData v_in)\n\
+{\n\
+	VertData vert_out;\n\
+	vert_out.pos = mul(float4(v_in.pos.xyz, 1.0), ViewProj);\n\
+	vert_out.uv  = v_in.uv;\n\
+	return vert_out;\n\
+}\n\
+\n";
+
+static const char *fused_effect_technique = "\
+technique Draw\n\
+{\n\
+	pass\n\
+	{\n\
+		vertex_shader = VSDefault(v_in);\n\
+		pixel_shader  = PSFused(v_in);\n\
+	}\n\
+}\n";
+
+static inline void fused_prefix(char *prefix, size_t size, size_t idx)
+{
+	snprintf(prefix, size, "f%zu_", idx);
+}
+
+static const char *get_fused_shader(const obs_source_t *filter, const obs_source_t *source)
+{
+	if (!source->info.video_get_fused_shader || !source->info.video_set_fused_params)
+		return NULL;
+	if ((source->info.output_flags & OBS_SOURCE_SRGB) != (filter->info.output_flags & OBS_SOURCE_SRGB))
+		return NULL;
+
+	const char *shader = source->info.video_get_fused_shader(source->context.data);
+	return (shader && *shader) ? shader : NULL;
+}
+
+static gs_effect_t *compile_fused_effect(obs_source_t *filter)
+{
+	struct dstr code = {0};
+	struct dstr func = {0};
+	char *errors = NULL;
+	char prefix[16];
+	gs_effect_t *effect;
+
+	dstr_copy(&code, fused_effect_header);
+
+	for (size_t i = 0; i < filter->fused_shaders.num; i++) {
+		fused_prefix(prefix, sizeof(prefix), i);
+		dstr_copy(&func, filter->fused_shaders.array[i]);
+		dstr_replace(&func, "$", prefix);
+		dstr_cat_dstr(&code, &func);
+		dstr_cat(&code, "\n");
+	}
+
+	/* functions take and return straight alpha, the innermost filter of
+	 * the run is applied first */
+	dstr_cat(&code, "float4 PSFused(VertData v_in) : TARGET\n"
+			"{\n"
+			"\tfloat4 rgba = image.Sample(textureSampler, v_in.uv);\n"
+			"\trgba.rgb *= (rgba.a > 0.) ? (1. / rgba.a) : 0.;\n");
+	for (size_t i = filter->fused_shaders.num; i > 0; i--) {
+		fused_prefix(prefix, sizeof(prefix), i - 1);
+		dstr_catf(&code, "\trgba = %sProcessPixel(rgba);\n", prefix);
+	}
+	dstr_cat(&code, "\trgba.rgb *= rgba.a;\n"
+			"\treturn rgba;\n"
+			"}\n\n");
+	dstr_cat(&code, fused_effect_technique);
+
+	effect = gs_effect_create(code.array, "fused filter chain", &errors);
+	if (!effect) {
+		blog(LOG_WARNING, "Failed to compile fused effect for %zu filters starting at '%s', rendering them "
+				  "separately: %s",
+		     filter->fused_shaders.num, filter->context.name, errors ? errors : "(unknown error)");
+	}
+
+	bfree(errors);
+	dstr_free(&func);
+	dstr_free(&code);
+	return effect;
+}
+
+/* the effect is kept for as long as the filters of the run keep returning
+ * the same shader code, a failed compile is remembered the same way so it
+ * is not retried every frame */
+static gs_effect_t *get_fused_effect(obs_source_t *filter)
+{
+	const size_t size = filter->fused_shaders.num * sizeof(const char *);
+
+	if (filter->fused_effect_shaders.num == filter->fused_shaders.num &&
+	    memcmp(filter->fused_effect_shaders.array, filter->fused_shaders.array, size) == 0)
+		return filter->fused_effect;
+
+	gs_effect_destroy(filter->fused_effect);
+	filter->fused_effect = compile_fused_effect(filter);
+	da_copy(filter->fused_effect_shaders, filter->fused_shaders);
+	return filter->fused_effect;
+}
+
+void fused_filter_end(obs_source_t *filter)
+{
+	for (size_t i = 0; i < filter->fused_chain.num; i++)
+		obs_source_release(filter->fused_chain.array[i]);
+	da_resize(filter->fused_chain, 0);
+
+	obs_source_release(filter->fused_target);
+	filter->fused_target = NULL;
+}
+
+obs_source_t *fused_filter_begin(obs_source_t *filter, obs_source_t *target, obs_source_t *parent)
+{
+	obs_source_t *inner = target;
+	const char *shader;
+
+	fused_filter_end(filter);
+
+	if (target == parent)
+		return target;
+
+	shader = get_fused_shader(filter, filter);
+	if (!shader)
+		return target;
+
+	da_resize(filter->fused_shaders, 0);
+	da_push_back(filter->fused_shaders, &shader);
+
+	while (inner && inner != parent && inner->info.type == OBS_SOURCE_TYPE_FILTER) {
+		/* skipped by render_video anyway */
+		if (!inner->context.data || !inner->enabled || (inner->info.output_flags & OBS_SOURCE_VIDEO) == 0) {
+			inner = inner->filter_target;
+			continue;
+		}
+
+		shader = get_fused_shader(filter, inner);
+		if (!shader)
+			break;
+
+		obs_source_t *ref = obs_source_get_ref(inner);
+		if (!ref)
+			break;
+
+		da_push_back(filter->fused_shaders, &shader);
+		da_push_back(filter->fused_chain, &ref);
+		inner = inner->filter_target;
+	}
+
+	if (!inner || !filter->fused_chain.num || !get_fused_effect(filter)) {
+		fused_filter_end(filter);
+		return target;
+	}
+
+	filter->fused_target = obs_source_get_ref(inner);
+	if (!filter->fused_target) {
+		fused_filter_end(filter);
+		return target;
+	}
+
+	return inner;
+}
+
+gs_effect_t *fused_filter_get_effect(obs_source_t *filter)
+{
+	gs_effect_t *effect = filter->fused_effect;
+	char prefix[16];
+
+	fused_prefix(prefix, sizeof(prefix), 0);
+	filter->info.video_set_fused_params(filter->context.data, effect, prefix);
+
+	for (size_t i = 0; i < filter->fused_chain.num; i++) {
+		obs_source_t *source = filter->fused_chain.array[i];
+
+		fused_prefix(prefix, sizeof(prefix), i + 1);
+		source->info.video_set_fused_params(source->context.data, effect, prefix);
+	}
+
+	return effect;
+}
+
+void fused_filter_free(obs_source_t *filter)
+{
+	fused_filter_end(filter);
+
+	gs_effect_destroy(filter->fused_effect);
+	filter->fused_effect = NULL;
+
+	da_free(filter->fused_chain);
+	da_free(filter->fused_shaders);
+	da_free(filter->fused_effect_shaders);
+}
+
+gs_eparam_t *obs_filter_get_fused_param(gs_effect_t *effect, const char *prefix, const char *name)
+{
+	char full_name[128];
+
+	if (!effect || !prefix || !name)
+		return NULL;
+
+	snprintf(full_name, sizeof(full_name), "%s%s", prefix, name);
+	return gs_effect_get_param_by_name(effect, full_name);
+}
@@ -611,6 +611,42 @@ void obs_transition_enum_sources(obs_source_t *transition, obs_source_enum_proc_
 	unlock_transition(transition);
 }
 
+/* Used by obs_source_get_video_gen, a transition that is not transitioning
+ * only draws its current source */
+bool obs_transition_get_video_gen(obs_source_t *transition, uint64_t *gen)
+{
+	uint64_t hash = VIDEO_GEN_HASH_INIT;
+	uint64_t source_gen;
+	struct matrix4 matrix;
+	obs_source_t *source;
+	bool cacheable = true;
+
+	lock_transition(transition);
+
+	if (transition->transitioning_video || transition->transitioning_audio) {
+		unlock_transition(transition);
+		return false;
+	}
+
+	source = obs_source_get_ref(transition->transition_sources[0]);
+	matrix = transition->transition_matrices[0];
+
+	unlock_transition(transition);
+
+	hash = video_gen_hash(hash, &source, sizeof(source));
+	hash = video_gen_hash(hash, &matrix, sizeof(matrix));
+
+	if (source) {
+		cacheable = obs_source_get_video_gen(source, &source_gen);
+		if (cacheable)
+			hash = video_gen_hash(hash, &source_gen, sizeof(source_gen));
+		obs_source_release(source);
+	}
+
+	*gen = hash;
+	return cacheable;
+}
+
 static inline void render_child(obs_source_t *transition, obs_source_t *child, size_t idx, enum gs_color_space space)
 {
 	uint32_t cx = get_cx(transition);
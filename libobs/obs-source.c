@@ -221,6 +221,7 @@ static bool obs_source_init(struct obs_source *source)
 	source->audio_active = true;
 	pthread_mutex_init_value(&source->filter_mutex);
 	pthread_mutex_init_value(&source->async_mutex);
+	pthread_mutex_init_value(&source->async_upload.mutex);
 	pthread_mutex_init_value(&source->audio_mutex);
 	pthread_mutex_init_value(&source->audio_buf_mutex);
 	pthread_mutex_init_value(&source->audio_cb_mutex);
@@ -239,6 +240,8 @@ static bool obs_source_init(struct obs_source *source)
 		return false;
 	if (pthread_mutex_init_recursive(&source->async_mutex) != 0)
 		return false;
+	if (pthread_mutex_init(&source->async_upload.mutex, NULL) != 0)
+		return false;
 	if (pthread_mutex_init(&source->caption_cb_mutex, NULL) != 0)
 		return false;
 	if (pthread_mutex_init(&source->media_actions_mutex, NULL) != 0)
@@ -789,6 +792,7 @@ static void obs_source_destroy_defer(struct obs_source *source)
 		obs_source_frame_decref(source->async_cache.array[i].frame);
 
 	gs_enter_context(obs->video.graphics);
+	release_async_upload(source);
 	if (source->async_texrender)
 		gs_texrender_destroy(source->async_texrender);
 	if (source->async_prev_texrender)
@@ -799,6 +803,9 @@ static void obs_source_destroy_defer(struct obs_source *source)
 	}
 	if (source->filter_texrender)
 		gs_texrender_destroy(source->filter_texrender);
+	fused_filter_free(source);
+	if (source->render_memo)
+		gs_texrender_destroy(source->render_memo);
 	if (source->color_space_texrender)
 		gs_texrender_destroy(source->color_space_texrender);
 	gs_leave_context();
@@ -830,6 +837,7 @@ static void obs_source_destroy_defer(struct obs_source *source)
 	pthread_mutex_destroy(&source->audio_mutex);
 	pthread_mutex_destroy(&source->caption_cb_mutex);
 	pthread_mutex_destroy(&source->async_mutex);
+	pthread_mutex_destroy(&source->async_upload.mutex);
 	pthread_mutex_destroy(&source->media_actions_mutex);
 	obs_data_release(source->private_settings);
 	obs_context_data_free(&source->context);
@@ -1059,6 +1067,7 @@ static void obs_source_deferred_update(obs_source_t *source)
 		long count = os_atomic_load_long(&source->defer_update_count);
 		source->info.update(source->context.data, source->context.settings);
 		os_atomic_compare_swap_long(&source->defer_update_count, count, 0);
+		os_atomic_inc_long(&source->video_gen);
 		obs_source_dosignal(source, "source_update", "update");
 	}
 }
@@ -1089,6 +1098,90 @@ void obs_source_reset_settings(obs_source_t *source, obs_data_t *settings)
 	obs_source_update(source, settings);
 }
 
+void obs_source_video_changed(obs_source_t *source)
+{
+	if (!obs_source_valid(source, "obs_source_video_changed"))
+		return;
+
+	os_atomic_inc_long(&source->video_gen);
+}
+
+static inline bool source_video_static(const obs_source_t *source)
+{
+	uint32_t flags = source->info.output_flags;
+
+	if ((flags & OBS_SOURCE_STATIC_VIDEO) != 0)
+		return true;
+
+	/* async video only changes when a new frame is picked in async_tick,
+	 * unless deinterlacing alternates fields in between */
+	return (flags & OBS_SOURCE_ASYNC) != 0 && !source->info.video_render &&
+	       source->deinterlace_mode == OBS_DEINTERLACE_MODE_DISABLE;
+}
+
+/* Sets gen to a value that changes whenever the video of the source (including
+ * its filters) may have changed.  Returns false if it can change at any time,
+ * in which case it has to be rendered every frame. */
+bool obs_source_get_video_gen(obs_source_t *source, uint64_t *gen)
+{
+	uint64_t hash = VIDEO_GEN_HASH_INIT;
+	bool cacheable = true;
+	long own_gen;
+
+	if (obs_source_removed(source))
+		return false;
+
+	if (source->info.type == OBS_SOURCE_TYPE_SCENE) {
+		uint64_t scene_gen;
+
+		if (!obs_scene_get_video_gen(source->context.data, &scene_gen))
+			return false;
+
+		hash = video_gen_hash(hash, &scene_gen, sizeof(scene_gen));
+
+	} else if (source->info.type == OBS_SOURCE_TYPE_TRANSITION) {
+		uint64_t transition_gen;
+
+		if (!obs_transition_get_video_gen(source, &transition_gen))
+			return false;
+
+		hash = video_gen_hash(hash, &transition_gen, sizeof(transition_gen));
+
+	} else if (!source_video_static(source)) {
+		return false;
+	}
+
+	own_gen = os_atomic_load_long(&source->video_gen);
+	hash = video_gen_hash(hash, &own_gen, sizeof(own_gen));
+	hash = video_gen_hash(hash, &source->enabled, sizeof(source->enabled));
+	hash = video_gen_hash(hash, &source->async_rotation, sizeof(source->async_rotation));
+
+	pthread_mutex_lock(&source->filter_mutex);
+
+	for (size_t i = 0; i < source->filters.num; i++) {
+		obs_source_t *filter = source->filters.array[i];
+
+		hash = video_gen_hash(hash, &filter, sizeof(filter));
+		hash = video_gen_hash(hash, &filter->enabled, sizeof(filter->enabled));
+
+		if (!filter->enabled || !(filter->info.output_flags & OBS_SOURCE_VIDEO))
+			continue;
+
+		if (!source_video_static(filter)) {
+			cacheable = false;
+			break;
+		}
+
+		own_gen = os_atomic_load_long(&filter->video_gen);
+		hash = video_gen_hash(hash, &own_gen, sizeof(own_gen));
+	}
+
+	pthread_mutex_unlock(&source->filter_mutex);
+
+	*gen = hash;
+	return cacheable;
+}
+
 void obs_source_update_properties(obs_source_t *source)
 {
 	if (!obs_source_valid(source, "obs_source_update_properties"))
@@ -1348,8 +1441,10 @@ static void async_tick(obs_source_t *source)
 		filter_frame(source, &source->prev_async_frame);
 	filter_frame(source, &source->cur_async_frame);
 
-	if (source->cur_async_frame)
+	if (source->cur_async_frame) {
 		source->async_update_texture = set_async_texture_size(source, source->cur_async_frame);
+		os_atomic_inc_long(&source->video_gen);
+	}
 
 	pthread_mutex_unlock(&source->async_mutex);
 }
@@ -2103,6 +2198,161 @@ static inline bool init_gpu_conversion(struct obs_source *source, const struct o
 	return false;
 }
 
+/* Gives the upload slots back before the async textures are destroyed or
+ * swapped, waiting for a copy into them that is still in progress */
+void release_async_upload(struct obs_source *source)
+{
+	struct async_upload *upload = &source->async_upload;
+
+	pthread_mutex_lock(&upload->mutex);
+
+	if (upload->mapped) {
+		for (size_t c = 0; c < MAX_AV_PLANES; c++) {
+			if (upload->tex[c])
+				gs_texture_release_slot(upload->tex[c], upload->slot[c]);
+			upload->tex[c] = NULL;
+			upload->data[c] = NULL;
+		}
+	}
+
+	upload->mapped = false;
+	upload->frame = NULL;
+
+	pthread_mutex_unlock(&upload->mutex);
+}
+
+/* Hands the slots for the next frame to the outputting thread, where the
+ * graphics subsystem supports it */
+static void map_async_upload(struct obs_source *source)
+{
+	struct async_upload *upload = &source->async_upload;
+	bool mapped = true;
+
+	if (upload->mapped || !source->async_textures[0] || deinterlacing_enabled(source))
+		return;
+	if (pthread_mutex_trylock(&upload->mutex) != 0)
+		return;
+
+	for (size_t c = 0; c < MAX_AV_PLANES; c++) {
+		gs_texture_t *tex = mapped ? source->async_textures[c] : NULL;
+
+		upload->tex[c] = NULL;
+		upload->data[c] = NULL;
+
+		if (!tex)
+			continue;
+
+		if (!gs_texture_map_slot(tex, &upload->slot[c], &upload->data[c], &upload->linesize[c])) {
+			upload->data[c] = NULL;
+			mapped = false;
+			continue;
+		}
+
+		upload->tex[c] = tex;
+		upload->lines[c] = gs_texture_get_height(tex);
+	}
+
+	if (mapped) {
+		upload->format = source->async_format;
+		upload->width = source->async_width;
+		upload->height = source->async_height;
+		upload->full_range = source->async_full_range;
+		upload->trc = source->async_trc;
+		upload->frame = NULL;
+		upload->mapped = true;
+	} else {
+		for (size_t c = 0; c < MAX_AV_PLANES; c++) {
+			if (upload->tex[c])
+				gs_texture_release_slot(upload->tex[c], upload->slot[c]);
+			upload->tex[c] = NULL;
+			upload->data[c] = NULL;
+		}
+	}
+
+	pthread_mutex_unlock(&upload->mutex);
+}
+
+static inline bool async_upload_matches(const struct async_upload *upload, const struct obs_source_frame *frame)
+{
+	return upload->format == frame->format && upload->width == frame->width && upload->height == frame->height &&
+	       upload->full_range == frame->full_range && upload->trc == frame->trc;
+}
+
+/* Copies a newly cached frame into the mapped slots, on the thread that
+ * outputs it */
+static void fill_async_upload(struct obs_source *source, struct obs_source_frame *frame)
+{
+	struct async_upload *upload = &source->async_upload;
+
+	pthread_mutex_lock(&upload->mutex);
+
+	if (upload->mapped && !upload->frame && async_upload_matches(upload, frame)) {
+		for (size_t c = 0; c < MAX_AV_PLANES; c++) {
+			const uint8_t *src = frame->data[c];
+			uint8_t *dst = upload->data[c];
+
+			if (!dst || !src)
+				continue;
+
+			uint32_t row = frame->linesize[c];
+			if (row > upload->linesize[c])
+				row = upload->linesize[c];
+
+			if (frame->linesize[c] == upload->linesize[c]) {
+				memcpy(dst, src, (size_t)row * upload->lines[c]);
+				continue;
+			}
+
+			for (uint32_t y = 0; y < upload->lines[c]; y++) {
+				memcpy(dst, src, row);
+				dst += upload->linesize[c];
+				src += frame->linesize[c];
+			}
+		}
+
+		upload->frame = frame;
+		upload->timestamp = frame->timestamp;
+	}
+
+	pthread_mutex_unlock(&upload->mutex);
+}
+
+/* Uploads the frame from the slots if it was copied there, otherwise the
+ * caller has to upload it from the cached frame */
+static bool upload_async_frame(struct obs_source *source, const struct obs_source_frame *frame,
+			       gs_texture_t *tex[MAX_AV_PLANES])
+{
+	struct async_upload *upload = &source->async_upload;
+	bool uploaded = false;
+
+	if (!upload->mapped || tex[0] != upload->tex[0])
+		return false;
+	if (pthread_mutex_trylock(&upload->mutex) != 0)
+		return false;
+
+	if (upload->frame == frame && upload->timestamp == frame->timestamp) {
+		for (size_t c = 0; c < MAX_AV_PLANES; c++) {
+			if (upload->tex[c])
+				gs_texture_unmap_slot(upload->tex[c], upload->slot[c]);
+			upload->tex[c] = NULL;
+			upload->data[c] = NULL;
+		}
+
+		upload->mapped = false;
+		upload->frame = NULL;
+		uploaded = true;
+
+	} else if (upload->frame && (upload->timestamp <= frame->timestamp ||
+				     upload->timestamp - frame->timestamp > MAX_TS_VAR)) {
+		/* the copied frame was skipped, let a newer one have the
+		 * slots */
+		upload->frame = NULL;
+	}
+
+	pthread_mutex_unlock(&upload->mutex);
+	return uploaded;
+}
+
 bool set_async_texture_size(struct obs_source *source, const struct obs_source_frame *frame)
 {
 	enum convert_type cur = get_convert_type(frame->format, frame->full_range, frame->trc);
@@ -2120,6 +2370,8 @@ bool set_async_texture_size(struct obs_source *source, const struct obs_source_f
 
 	gs_enter_context(obs->video.graphics);
 
+	release_async_upload(source);
+
 	for (size_t c = 0; c < MAX_AV_PLANES; c++) {
 		gs_texture_destroy(source->async_textures[c]);
 		source->async_textures[c] = NULL;
@@ -2356,7 +2608,8 @@ static bool update_async_texrender(struct obs_source *source, const struct obs_s
 
 	gs_texrender_reset(texrender);
 
-	upload_raw_frame(tex, frame);
+	if (!upload_async_frame(source, frame, tex))
+		upload_raw_frame(tex, frame);
 
 	uint32_t cx = source->async_width;
 	uint32_t cy = source->async_height;
@@ -2457,7 +2710,8 @@ bool update_async_textures(struct obs_source *source, const struct obs_source_fr
 
 	type = get_convert_type(frame->format, frame->full_range, frame->trc);
 	if (type == CONVERT_NONE) {
-		gs_texture_set_image(tex[0], frame->data[0], frame->linesize[0], false);
+		if (!upload_async_frame(source, frame, tex))
+			gs_texture_set_image(tex[0], frame->data[0], frame->linesize[0], false);
 		return true;
 	}
 
@@ -2497,6 +2751,7 @@ static void recreate_async_texture(obs_source_t *source, enum gs_color_format fo
 {
 	uint32_t cx = gs_texture_get_width(source->async_textures[0]);
 	uint32_t cy = gs_texture_get_height(source->async_textures[0]);
+	release_async_upload(source);
 	gs_texture_destroy(source->async_textures[0]);
 	source->async_textures[0] = gs_texture_create(cx, cy, format, 1, NULL, GS_DYNAMIC);
 }
@@ -2526,13 +2781,17 @@ static void obs_source_update_async_video(obs_source_t *source)
 			}
 
 			if (source->async_update_texture) {
+				source_profiler_section_begin(source, "Convert Format");
 				update_async_textures(source, frame, source->async_textures, source->async_texrender);
+				source_profiler_section_end(source);
 				source->async_update_texture = false;
 			}
 
 			source->async_last_rendered_ts = frame->timestamp;
 			obs_source_release_frame(source, frame);
 		}
+
+		map_async_upload(source);
 	}
 }
 
@@ -2729,6 +2988,12 @@ static void source_render(obs_source_t *source, gs_effect_t *effect)
 	gs_timer_t *timer = NULL;
 	const uint64_t start = source_profiler_source_render_begin(&timer);
 
+	/* filters are also timed as part of the section tree of the source
+	 * they are applied to */
+	obs_source_t *const section_source = source->filter_parent;
+	if (section_source)
+		source_profiler_section_begin(section_source, "%s", source->context.name ? source->context.name : "");
+
 	void *const data = source->context.data;
 	const enum gs_color_space current_space = gs_get_color_space();
 	const enum gs_color_space source_space = obs_source_get_color_space(source, 1, &current_space);
@@ -2840,6 +3105,9 @@ static void source_render(obs_source_t *source, gs_effect_t *effect)
 	} else {
 		source->info.video_render(data, effect);
 	}
+
+	if (section_source)
+		source_profiler_section_end(section_source);
 	source_profiler_source_render_end(source, start, timer);
 }
 
@@ -2945,6 +3213,125 @@ static inline void render_video(obs_source_t *source)
 	GS_DEBUG_MARKER_END();
 }
 
+/* Scenes, transitions and filtered sources shown in several places (canvases,
+ * views, the multiview, projectors) are rendered once per frame into
+ * render_memo, the other draws in that frame sample it instead.  Only done
+ * for sources drawn more than once in the previous frame, for everything else
+ * the extra texture would just be overhead. */
+static inline bool render_memo_eligible(obs_source_t *source)
+{
+	if (source->rendering_filter || source->render_memo_active)
+		return false;
+	if (source->info.type != OBS_SOURCE_TYPE_SCENE && source->info.type != OBS_SOURCE_TYPE_TRANSITION &&
+	    (source->info.type != OBS_SOURCE_TYPE_INPUT || !source->filters.num))
+		return false;
+
+	return obs_in_task_thread(OBS_TASK_GRAPHICS);
+}
+
+/* The memo holds premultiplied output, which can only stand in for a direct
+ * draw with normal alpha blending */
+static inline bool render_memo_blend_compatible(void)
+{
+	enum gs_blend_type src_c, dest_c, src_a, dest_a;
+	enum gs_blend_op_type op;
+
+	if (!gs_get_blend_function(&src_c, &dest_c, &src_a, &dest_a, &op))
+		return false;
+
+	return (src_c == GS_BLEND_ONE || src_c == GS_BLEND_SRCALPHA) && dest_c == GS_BLEND_INVSRCALPHA &&
+	       src_a == GS_BLEND_ONE && dest_a == GS_BLEND_INVSRCALPHA && op == GS_BLEND_OP_ADD;
+}
+
+static bool update_render_memo(obs_source_t *source, uint32_t cx, uint32_t cy, enum gs_color_space space)
+{
+	const enum gs_color_format format = gs_get_format_from_space(space);
+	struct vec4 clear_color;
+
+	if (source->render_memo && gs_texrender_get_format(source->render_memo) != format) {
+		gs_texrender_destroy(source->render_memo);
+		source->render_memo = NULL;
+	}
+
+	if (!source->render_memo)
+		source->render_memo = gs_texrender_create(format, GS_ZS_NONE);
+
+	gs_texrender_reset(source->render_memo);
+	if (!gs_texrender_begin_with_color_space(source->render_memo, cx, cy, space))
+		return false;
+
+	vec4_zero(&clear_color);
+	gs_clear(GS_CLEAR_COLOR, &clear_color, 0.0f, 0);
+	gs_ortho(0.0f, (float)cx, 0.0f, (float)cy, -100.0f, 100.0f);
+
+	source->render_memo_active = true;
+	render_video(source);
+	source->render_memo_active = false;
+
+	gs_texrender_end(source->render_memo);
+
+	source->render_memo_cx = cx;
+	source->render_memo_cy = cy;
+	source->render_memo_space = space;
+	source->render_memo_valid = true;
+	obs->video.render_memo_renders++;
+	return true;
+}
+
+static void draw_render_memo(obs_source_t *source)
+{
+	gs_texture_t *tex = gs_texrender_get_texture(source->render_memo);
+	gs_effect_t *effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+
+	gs_blend_state_push();
+	gs_blend_function_separate(GS_BLEND_ONE, GS_BLEND_INVSRCALPHA, GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+
+	while (gs_effect_loop(effect, "Draw"))
+		obs_source_draw(tex, 0, 0, 0, 0, false);
+
+	gs_blend_state_pop();
+}
+
+static bool render_video_memo(obs_source_t *source)
+{
+	const uint64_t frame = obs->video.video_time;
+	const enum gs_color_space space = gs_get_color_space();
+	uint32_t cx, cy;
+
+	if (!render_memo_eligible(source))
+		return false;
+
+	if (source->render_memo_frame != frame) {
+		source->render_memo_prev_draws = source->render_memo_draws;
+		source->render_memo_draws = 0;
+		source->render_memo_frame = frame;
+		source->render_memo_valid = false;
+	}
+
+	source->render_memo_draws++;
+
+	if (source->render_memo_prev_draws < 2 || !render_memo_blend_compatible())
+		return false;
+
+	cx = obs_source_get_width(source);
+	cy = obs_source_get_height(source);
+	if (!cx || !cy)
+		return false;
+
+	if (source->render_memo_valid) {
+		/* drawn at another size or color space earlier this frame */
+		if (cx != source->render_memo_cx || cy != source->render_memo_cy || space != source->render_memo_space)
+			return false;
+
+		obs->video.render_memo_hits++;
+	} else if (!update_render_memo(source, cx, cy, space)) {
+		return false;
+	}
+
+	draw_render_memo(source);
+	return true;
+}
+
 void obs_source_video_render(obs_source_t *source)
 {
 	if (!obs_source_valid(source, "obs_source_video_render"))
@@ -2952,7 +3339,8 @@ void obs_source_video_render(obs_source_t *source)
 
 	source = obs_source_get_ref(source);
 	if (source) {
-		render_video(source);
+		if (!render_video_memo(source))
+			render_video(source);
 		obs_source_release(source);
 	}
 }
@@ -3571,12 +3959,15 @@ static void obs_source_output_video_internal(obs_source_t *source, const struct
 		source->last_frame_ts = 0;
 		free_async_cache(source);
 		pthread_mutex_unlock(&source->async_mutex);
+		os_atomic_inc_long(&source->video_gen);
 		return;
 	}
 
 	source_profiler_async_frame_received(source);
 
 	struct obs_source_frame *output = cache_video(source, frame);
+	if (output)
+		fill_async_upload(source, output);
 
 	/* ------------------------------------------- */
 	pthread_mutex_lock(&source->async_mutex);
@@ -3782,6 +4173,7 @@ void obs_source_show_preloaded_video(obs_source_t *source)
 	set_async_texture_size(source, source->async_preload_frame);
 	update_async_textures(source, source->async_preload_frame, source->async_textures, source->async_texrender);
 	source->async_active = true;
+	os_atomic_inc_long(&source->video_gen);
 
 	obs_leave_graphics();
 
@@ -4292,22 +4684,25 @@ const char *obs_source_get_unversioned_id(const obs_source_t *source)
 	return obs_source_valid(source, "obs_source_get_unversioned_id") ? source->info.unversioned_id : NULL;
 }
 
-static inline void render_filter_bypass(obs_source_t *target, gs_effect_t *effect, const char *tech_name)
+static inline void render_filter_bypass(obs_source_t *parent, obs_source_t *target, gs_effect_t *effect,
+					const char *tech_name)
 {
 	gs_technique_t *tech = gs_effect_get_technique(effect, tech_name);
 	size_t passes, i;
 
 	passes = gs_technique_begin(tech);
 	for (i = 0; i < passes; i++) {
+		source_profiler_section_begin(parent, "%s pass %zu", tech_name, i);
 		gs_technique_begin_pass(tech, i);
 		obs_source_video_render(target);
 		gs_technique_end_pass(tech);
+		source_profiler_section_end(parent);
 	}
 	gs_technique_end(tech);
 }
 
-static inline void render_filter_tex(gs_texture_t *tex, gs_effect_t *effect, uint32_t width, uint32_t height,
-				     const char *tech_name)
+static inline void render_filter_tex(obs_source_t *parent, gs_texture_t *tex, gs_effect_t *effect, uint32_t width,
+				     uint32_t height, const char *tech_name)
 {
 	gs_technique_t *tech = gs_effect_get_technique(effect, tech_name);
 	gs_eparam_t *image = gs_effect_get_param_by_name(effect, "image");
@@ -4325,9 +4720,11 @@ static inline void render_filter_tex(gs_texture_t *tex, gs_effect_t *effect, uin
 
 	passes = gs_technique_begin(tech);
 	for (i = 0; i < passes; i++) {
+		source_profiler_section_begin(parent, "%s pass %zu", tech_name, i);
 		gs_technique_begin_pass(tech, i);
 		gs_draw_sprite(tex, 0, width, height);
 		gs_technique_end_pass(tech);
+		source_profiler_section_end(parent);
 	}
 	gs_technique_end(tech);
 
@@ -4375,6 +4772,11 @@ bool obs_source_process_filter_begin_with_color_space(obs_source_t *filter, enum
 
 	filter_flags = filter->info.output_flags;
 	parent_flags = parent->info.output_flags;
+
+	/* fusable filters directly below this one are drawn as part of its
+	 * pass, in which case the source below them is the target */
+	target = fused_filter_begin(filter, target, parent);
+
 	cx = get_base_width(target);
 	cy = get_base_height(target);
 
@@ -4390,6 +4792,7 @@ bool obs_source_process_filter_begin_with_color_space(obs_source_t *filter, enum
 	}
 
 	if (!cx || !cy) {
+		fused_filter_end(filter);
 		obs_source_skip_video_filter(filter);
 		return false;
 	}
@@ -4403,6 +4806,8 @@ bool obs_source_process_filter_begin_with_color_space(obs_source_t *filter, enum
 		filter->filter_texrender = gs_texrender_create(format, GS_ZS_NONE);
 	}
 
+	source_profiler_section_begin(parent, "Input");
+
 	if (gs_texrender_begin_with_color_space(filter->filter_texrender, cx, cy, space)) {
 		gs_blend_state_push();
 		gs_blend_function_separate(GS_BLEND_SRCALPHA, GS_BLEND_INVSRCALPHA, GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
@@ -4424,6 +4829,8 @@ bool obs_source_process_filter_begin_with_color_space(obs_source_t *filter, enum
 
 		gs_texrender_end(filter->filter_texrender);
 	}
+
+	source_profiler_section_end(parent);
 	return true;
 }
 
@@ -4440,11 +4847,13 @@ void obs_source_process_filter_tech_end(obs_source_t *filter, gs_effect_t *effec
 	const bool filter_bypass_active = filter->filter_bypass_active;
 	filter->filter_bypass_active = false;
 
-	target = obs_filter_get_target(filter);
+	target = filter->fused_target ? filter->fused_target : obs_filter_get_target(filter);
 	parent = obs_filter_get_parent(filter);
 
-	if (!target || !parent)
+	if (!target || !parent) {
+		fused_filter_end(filter);
 		return;
+	}
 
 	filter_flags = filter->info.output_flags;
 
@@ -4452,16 +4861,22 @@ void obs_source_process_filter_tech_end(obs_source_t *filter, gs_effect_t *effec
 
 	const char *tech = tech_name ? tech_name : "Draw";
 
+	if (filter->fused_target) {
+		effect = fused_filter_get_effect(filter);
+		tech = "Draw";
+	}
+
 	if (filter_bypass_active) {
-		render_filter_bypass(target, effect, tech);
+		render_filter_bypass(parent, target, effect, tech);
 	} else {
 		texture = gs_texrender_get_texture(filter->filter_texrender);
 		if (texture) {
-			render_filter_tex(texture, effect, width, height, tech);
+			render_filter_tex(parent, texture, effect, width, height, tech);
 		}
 	}
 
 	gs_set_linear_srgb(previous);
+	fused_filter_end(filter);
 }
 
 void obs_source_process_filter_end(obs_source_t *filter, gs_effect_t *effect, uint32_t width, uint32_t height)
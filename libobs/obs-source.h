@@ -208,6 +208,12 @@ enum obs_media_state {
  */
 #define OBS_SOURCE_REQUIRES_CANVAS (1 << 17)
 
+/**
+ * Source video only changes when its settings are updated or when it calls
+ * obs_source_video_changed, so scenes may reuse its last rendered output
+ */
+#define OBS_SOURCE_STATIC_VIDEO (1 << 18)
+
 /** @} */
 
 typedef void (*obs_source_enum_proc_t)(obs_source_t *parent, obs_source_t *child, void *param);
@@ -216,6 +222,22 @@ struct obs_source_audio_mix {
 	struct audio_output_data output[MAX_AUDIO_MIXES];
 };
 
+/**
+ * Describes the video of a source that is a single textured (or solid) quad,
+ * see obs_source_info.video_get_sprite
+ */
+struct obs_source_sprite {
+	/** Premultiplied texture sampled as sRGB, NULL for a solid color */
+	gs_texture_t *texture;
+
+	/** Linear premultiplied color, multiplied with the texture */
+	struct vec4 color;
+
+	/** Size the quad is drawn at */
+	uint32_t cx;
+	uint32_t cy;
+};
+
 /**
  * Source definition structure
  */
@@ -555,6 +577,42 @@ struct obs_source_info {
 	/** Gets custom icons for dark and light themes */
 	const char *(*get_dark_icon)(void *type_data);
 	const char *(*get_light_icon)(void *type_data);
+
+	/**
+	 * Optional: describes the video of the source as a single quad, so
+	 * scenes can batch it with other items instead of calling
+	 * video_render.  Called on the graphics thread right before the
+	 * source would have been rendered.
+	 *
+	 * @param       data    Source data
+	 * @param[out]  sprite  Texture, color and size of the quad
+	 * @return              false to be rendered through video_render
+	 */
+	bool (*video_get_sprite)(void *data, struct obs_source_sprite *sprite);
+
+	/**
+	 * Optional, filters only: returns the effect code of a per-pixel
+	 * function named $ProcessPixel that takes and returns a straight
+	 * alpha float4, which lets adjacent filters be drawn in a single
+	 * pass.  Identifiers starting with '$' are made unique.  The string
+	 * must stay valid while the filter exists, return a different
+	 * string to change the code.
+	 *
+	 * @param   data  Filter data
+	 * @return        Effect code, or NULL if the filter can't be fused
+	 *                for this frame
+	 */
+	const char *(*video_get_fused_shader)(void *data);
+
+	/**
+	 * Sets the parameters of the fused function returned by
+	 * video_get_fused_shader, see obs_filter_get_fused_param.
+	 *
+	 * @param  data    Filter data
+	 * @param  effect  Effect the function has been fused into
+	 * @param  prefix  Prefix that replaced '$' for this filter
+	 */
+	void (*video_set_fused_params)(void *data, gs_effect_t *effect, const char *prefix);
 };
 
 EXPORT void obs_register_source_s(const struct obs_source_info *info, size_t size);
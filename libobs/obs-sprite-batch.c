@@ -0,0 +1,471 @@
+/******************************************************************************
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "obs-internal.h"
+
+/*
+ * Scene item sprite batching.
+ *
+ * Scenes made of many small image and color sources used to issue one draw
+ * per item, along with the effect and blend state changes around it.  Sources
+ * that implement obs_source_info.video_get_sprite describe their video as a
+ * single quad instead, and consecutive quads are merged into one vertex buffer
+ * and drawn with a single gs_draw call.
+ *
+ * Solid colors sample a white patch and small static textures are copied into
+ * a shared atlas (one per texture format images are loaded as), so runs of
+ * both can be drawn together.  Textures that don't fit an atlas are still
+ * batched, but only with sprites using the same texture.  An atlas is cleared
+ * when it runs out of space, at most once per SPRITE_ATLAS_RESET_INTERVAL so a
+ * working set larger than the atlas doesn't end up being copied every frame.
+ */
+
+#define SPRITE_BATCH_SIZE 256
+#define SPRITE_VERTS 6
+
+#define SPRITE_ATLAS_SIZE 2048
+#define SPRITE_ATLAS_MAX_SIZE 512
+#define SPRITE_ATLAS_COUNT 2
+#define SPRITE_ATLAS_RESET_INTERVAL 1000000000ULL
+
+#define SPRITE_WHITE_SIZE 4
+
+struct sprite_atlas_entry {
+	obs_source_t *source;
+	gs_texture_t *texture;
+	uint64_t gen;
+
+	/* position of the texture in the atlas, excluding its border */
+	uint32_t x;
+	uint32_t y;
+	uint32_t cx;
+	uint32_t cy;
+};
+
+struct sprite_atlas {
+	enum gs_color_format format;
+	gs_texture_t *texture;
+	bool failed;
+
+	DARRAY(struct sprite_atlas_entry) entries;
+	uint32_t shelf_x;
+	uint32_t shelf_y;
+	uint32_t shelf_cy;
+	uint64_t last_reset;
+};
+
+struct sprite_batch {
+	gs_vertbuffer_t *vb;
+	gs_texture_t *white;
+	struct sprite_atlas atlases[SPRITE_ATLAS_COUNT];
+
+	/* sprites queued in vb, all drawn with texture */
+	gs_texture_t *texture;
+	size_t count;
+
+	uint64_t total_sprites;
+	uint64_t total_draws;
+};
+
+static struct sprite_batch *sprite_batch_create(void)
+{
+	struct sprite_batch *batch = bzalloc(sizeof(struct sprite_batch));
+	uint32_t white[SPRITE_WHITE_SIZE * SPRITE_WHITE_SIZE];
+	const uint8_t *white_data = (const uint8_t *)white;
+
+	memset(white, 0xFF, sizeof(white));
+	batch->white = gs_texture_create(SPRITE_WHITE_SIZE, SPRITE_WHITE_SIZE, GS_RGBA, 1, &white_data, 0);
+
+	batch->atlases[0].format = GS_RGBA;
+	batch->atlases[1].format = GS_BGRA;
+
+	struct gs_vb_data *vbd = gs_vbdata_create();
+	vbd->num = SPRITE_BATCH_SIZE * SPRITE_VERTS;
+	vbd->points = bzalloc(sizeof(struct vec3) * vbd->num);
+	vbd->num_tex = 2;
+	vbd->tvarray = bzalloc(sizeof(struct gs_tvertarray) * 2);
+	vbd->tvarray[0].width = 2;
+	vbd->tvarray[0].array = bzalloc(sizeof(struct vec2) * vbd->num);
+	vbd->tvarray[1].width = 4;
+	vbd->tvarray[1].array = bzalloc(sizeof(struct vec4) * vbd->num);
+
+	batch->vb = gs_vertexbuffer_create(vbd, GS_DYNAMIC);
+
+	if (!batch->white || !batch->vb)
+		blog(LOG_WARNING, "Failed to create sprite batch resources, "
+				  "scene items will be drawn individually");
+
+	return batch;
+}
+
+void sprite_batch_free(void)
+{
+	struct sprite_batch *batch = obs->video.sprite_batch;
+	if (!batch)
+		return;
+
+	if (batch->total_sprites)
+		blog(LOG_INFO, "Sprite batching: %" PRIu64 " sprites drawn in %" PRIu64 " draw calls",
+		     batch->total_sprites, batch->total_draws);
+
+	gs_vertexbuffer_destroy(batch->vb);
+	gs_texture_destroy(batch->white);
+	for (size_t i = 0; i < SPRITE_ATLAS_COUNT; i++) {
+		gs_texture_destroy(batch->atlases[i].texture);
+		da_free(batch->atlases[i].entries);
+	}
+	bfree(batch);
+
+	obs->video.sprite_batch = NULL;
+}
+
+static inline void atlas_clear(struct sprite_atlas *atlas)
+{
+	da_resize(atlas->entries, 0);
+
+	/* The white patch always stays at the origin */
+	atlas->shelf_x = SPRITE_WHITE_SIZE;
+	atlas->shelf_y = 0;
+	atlas->shelf_cy = SPRITE_WHITE_SIZE;
+	atlas->last_reset = os_gettime_ns();
+}
+
+static bool atlas_init(struct sprite_batch *batch, struct sprite_atlas *atlas)
+{
+	if (atlas->texture)
+		return true;
+	if (atlas->failed)
+		return false;
+
+	atlas->texture = gs_texture_create(SPRITE_ATLAS_SIZE, SPRITE_ATLAS_SIZE, atlas->format, 1, NULL, 0);
+	if (!atlas->texture) {
+		blog(LOG_WARNING, "Failed to create sprite atlas");
+		atlas->failed = true;
+		return false;
+	}
+
+	/* White is white in either channel order */
+	gs_texture_t *white = batch->white;
+	if (atlas->format != GS_RGBA) {
+		uint32_t data[SPRITE_WHITE_SIZE * SPRITE_WHITE_SIZE];
+		const uint8_t *ptr = (const uint8_t *)data;
+
+		memset(data, 0xFF, sizeof(data));
+		white = gs_texture_create(SPRITE_WHITE_SIZE, SPRITE_WHITE_SIZE, atlas->format, 1, &ptr, 0);
+	}
+
+	if (white)
+		gs_copy_texture_region(atlas->texture, 0, 0, white, 0, 0, SPRITE_WHITE_SIZE, SPRITE_WHITE_SIZE);
+	if (white != batch->white)
+		gs_texture_destroy(white);
+
+	atlas_clear(atlas);
+	return true;
+}
+
+/* Simple shelf packing, sprites in a scene tend to have similar sizes */
+static bool atlas_alloc(struct sprite_atlas *atlas, uint32_t cx, uint32_t cy, uint32_t *x, uint32_t *y)
+{
+	if (atlas->shelf_x + cx > SPRITE_ATLAS_SIZE) {
+		atlas->shelf_x = 0;
+		atlas->shelf_y += atlas->shelf_cy;
+		atlas->shelf_cy = 0;
+	}
+
+	if (atlas->shelf_y + cy > SPRITE_ATLAS_SIZE)
+		return false;
+
+	*x = atlas->shelf_x;
+	*y = atlas->shelf_y;
+
+	atlas->shelf_x += cx;
+	if (cy > atlas->shelf_cy)
+		atlas->shelf_cy = cy;
+	return true;
+}
+
+/* Copies the texture with a one texel border repeating its edges, so linear
+ * filtering never picks up texels of a neighbouring sprite */
+static void atlas_copy(struct sprite_atlas *atlas, const struct sprite_atlas_entry *entry)
+{
+	gs_texture_t *dst = atlas->texture;
+	gs_texture_t *tex = entry->texture;
+	const uint32_t x = entry->x;
+	const uint32_t y = entry->y;
+	const uint32_t cx = entry->cx;
+	const uint32_t cy = entry->cy;
+
+	gs_copy_texture_region(dst, x, y, tex, 0, 0, cx, cy);
+
+	gs_copy_texture_region(dst, x - 1, y, tex, 0, 0, 1, cy);
+	gs_copy_texture_region(dst, x + cx, y, tex, cx - 1, 0, 1, cy);
+	gs_copy_texture_region(dst, x, y - 1, tex, 0, 0, cx, 1);
+	gs_copy_texture_region(dst, x, y + cy, tex, 0, cy - 1, cx, 1);
+
+	gs_copy_texture_region(dst, x - 1, y - 1, tex, 0, 0, 1, 1);
+	gs_copy_texture_region(dst, x + cx, y - 1, tex, cx - 1, 0, 1, 1);
+	gs_copy_texture_region(dst, x - 1, y + cy, tex, 0, cy - 1, 1, 1);
+	gs_copy_texture_region(dst, x + cx, y + cy, tex, cx - 1, cy - 1, 1, 1);
+}
+
+static inline void entry_get_uv(const struct sprite_atlas_entry *entry, struct vec4 *uv)
+{
+	const float scale = 1.0f / (float)SPRITE_ATLAS_SIZE;
+
+	vec4_set(uv, (float)entry->x * scale, (float)entry->y * scale, (float)(entry->x + entry->cx) * scale,
+		 (float)(entry->y + entry->cy) * scale);
+}
+
+static struct sprite_atlas_entry *atlas_find(struct sprite_atlas *atlas, obs_source_t *source, gs_texture_t *tex)
+{
+	for (size_t i = 0; i < atlas->entries.num; i++) {
+		struct sprite_atlas_entry *entry = &atlas->entries.array[i];
+		if (entry->source == source && entry->texture == tex)
+			return entry;
+	}
+
+	return NULL;
+}
+
+static struct sprite_atlas *find_atlas(struct sprite_batch *batch, enum gs_color_format format)
+{
+	for (size_t i = 0; i < SPRITE_ATLAS_COUNT; i++) {
+		if (batch->atlases[i].format == format)
+			return &batch->atlases[i];
+	}
+
+	return NULL;
+}
+
+/* Returns the atlas holding the texture, or NULL if the texture has to be
+ * drawn on its own */
+static gs_texture_t *atlas_get_texture(struct sprite_batch *batch, obs_source_t *source, gs_texture_t *tex,
+				       struct vec4 *uv)
+{
+	const uint32_t cx = gs_texture_get_width(tex);
+	const uint32_t cy = gs_texture_get_height(tex);
+	struct sprite_atlas *atlas = find_atlas(batch, gs_texture_get_color_format(tex));
+	struct sprite_atlas_entry *entry;
+	uint64_t gen;
+
+	if (!atlas)
+		return NULL;
+	if (!cx || !cy || cx > SPRITE_ATLAS_MAX_SIZE || cy > SPRITE_ATLAS_MAX_SIZE)
+		return NULL;
+
+	/* Textures of sources that change every frame would be copied every
+	 * frame, those are cheaper to draw directly */
+	if (!obs_source_get_video_gen(source, &gen))
+		return NULL;
+	if (!atlas_init(batch, atlas))
+		return NULL;
+
+	entry = atlas_find(atlas, source, tex);
+	if (entry && entry->cx == cx && entry->cy == cy) {
+		if (entry->gen != gen) {
+			entry->gen = gen;
+			atlas_copy(atlas, entry);
+		}
+
+		entry_get_uv(entry, uv);
+		return atlas->texture;
+	}
+
+	if (entry)
+		da_erase(atlas->entries, entry - atlas->entries.array);
+
+	uint32_t x, y;
+	if (!atlas_alloc(atlas, cx + 2, cy + 2, &x, &y)) {
+		if (os_gettime_ns() - atlas->last_reset < SPRITE_ATLAS_RESET_INTERVAL)
+			return NULL;
+
+		/* Queued sprites may point at regions about to be reused */
+		if (batch->texture == atlas->texture)
+			sprite_batch_flush();
+
+		atlas_clear(atlas);
+		if (!atlas_alloc(atlas, cx + 2, cy + 2, &x, &y))
+			return NULL;
+	}
+
+	entry = da_push_back_new(atlas->entries);
+	entry->source = source;
+	entry->texture = tex;
+	entry->gen = gen;
+	entry->x = x + 1;
+	entry->y = y + 1;
+	entry->cx = cx;
+	entry->cy = cy;
+
+	atlas_copy(atlas, entry);
+	entry_get_uv(entry, uv);
+	return atlas->texture;
+}
+
+static bool get_source_sprite(obs_source_t *source, struct obs_source_sprite *sprite)
+{
+	const uint32_t flags = source->info.output_flags;
+
+	if (!source->info.video_get_sprite || !source->context.data || !source->enabled)
+		return false;
+	if ((flags & OBS_SOURCE_ASYNC) != 0 || (flags & OBS_SOURCE_SRGB) == 0)
+		return false;
+	if (source->filters.num)
+		return false;
+
+	/* Anything that would need a color space conversion in source_render
+	 * is drawn normally */
+	const enum gs_color_space current_space = gs_get_color_space();
+	if (current_space != GS_CS_SRGB && current_space != GS_CS_SRGB_16F)
+		return false;
+
+	const enum gs_color_space source_space = obs_source_get_color_space(source, 1, &current_space);
+	if (source_space != GS_CS_SRGB && source_space != GS_CS_SRGB_16F)
+		return false;
+
+	memset(sprite, 0, sizeof(*sprite));
+	if (!source->info.video_get_sprite(source->context.data, sprite))
+		return false;
+
+	if (sprite->texture &&
+	    (gs_get_texture_type(sprite->texture) != GS_TEXTURE_2D || gs_texture_is_rect(sprite->texture)))
+		return false;
+
+	return true;
+}
+
+static void add_vertices(struct sprite_batch *batch, const struct obs_source_sprite *sprite,
+			 const struct matrix4 *transform, const struct vec4 *uv)
+{
+	struct gs_vb_data *data = gs_vertexbuffer_get_data(batch->vb);
+	const size_t idx = batch->count * SPRITE_VERTS;
+	struct vec3 *points = data->points + idx;
+	struct vec2 *uvs = (struct vec2 *)data->tvarray[0].array + idx;
+	struct vec4 *colors = (struct vec4 *)data->tvarray[1].array + idx;
+	struct vec3 corners[4];
+	struct vec2 corner_uvs[4];
+
+	vec3_set(&corners[0], 0.0f, 0.0f, 0.0f);
+	vec3_set(&corners[1], (float)sprite->cx, 0.0f, 0.0f);
+	vec3_set(&corners[2], 0.0f, (float)sprite->cy, 0.0f);
+	vec3_set(&corners[3], (float)sprite->cx, (float)sprite->cy, 0.0f);
+
+	vec2_set(&corner_uvs[0], uv->x, uv->y);
+	vec2_set(&corner_uvs[1], uv->z, uv->y);
+	vec2_set(&corner_uvs[2], uv->x, uv->w);
+	vec2_set(&corner_uvs[3], uv->z, uv->w);
+
+	for (size_t i = 0; i < 4; i++)
+		vec3_transform(&corners[i], &corners[i], transform);
+
+	/* Two triangles with the same winding as the sprite triangle strip */
+	static const size_t order[SPRITE_VERTS] = {0, 1, 2, 2, 1, 3};
+	for (size_t i = 0; i < SPRITE_VERTS; i++) {
+		points[i] = corners[order[i]];
+		uvs[i] = corner_uvs[order[i]];
+		colors[i] = sprite->color;
+	}
+}
+
+bool sprite_batch_add(obs_source_t *source, const struct matrix4 *transform)
+{
+	struct sprite_batch *batch = obs->video.sprite_batch;
+	struct obs_source_sprite sprite;
+	gs_texture_t *tex;
+	struct vec4 uv;
+
+	if (batch && (!batch->vb || !batch->white))
+		return false;
+	if (!get_source_sprite(source, &sprite))
+		return false;
+
+	if (!batch) {
+		batch = sprite_batch_create();
+		obs->video.sprite_batch = batch;
+
+		if (!batch->vb || !batch->white)
+			return false;
+	}
+
+	if (!sprite.cx || !sprite.cy)
+		return true;
+
+	if (!sprite.texture) {
+		/* Any atlas works, prefer the one already being drawn */
+		tex = batch->white;
+		for (size_t i = 0; i < SPRITE_ATLAS_COUNT; i++) {
+			gs_texture_t *atlas = batch->atlases[i].texture;
+			if (atlas && (tex == batch->white || atlas == batch->texture))
+				tex = atlas;
+		}
+
+		/* Sample the middle of the white patch */
+		const float size = tex == batch->white ? (float)SPRITE_WHITE_SIZE : (float)SPRITE_ATLAS_SIZE;
+		const float center = (float)(SPRITE_WHITE_SIZE / 2) / size;
+		vec4_set(&uv, center, center, center, center);
+
+	} else {
+		tex = atlas_get_texture(batch, source, sprite.texture, &uv);
+		if (!tex) {
+			tex = sprite.texture;
+			vec4_set(&uv, 0.0f, 0.0f, 1.0f, 1.0f);
+		}
+	}
+
+	if (batch->count && (batch->texture != tex || batch->count == SPRITE_BATCH_SIZE))
+		sprite_batch_flush();
+
+	add_vertices(batch, &sprite, transform, &uv);
+	batch->texture = tex;
+	batch->count++;
+	batch->total_sprites++;
+	return true;
+}
+
+void sprite_batch_flush(void)
+{
+	struct sprite_batch *batch = obs->video.sprite_batch;
+	if (!batch || !batch->count)
+		return;
+
+	GS_DEBUG_MARKER_BEGIN_FORMAT(GS_DEBUG_COLOR_ITEM, "Sprites: %zu", batch->count);
+
+	gs_effect_t *effect = obs->video.default_effect;
+	gs_eparam_t *image = gs_effect_get_param_by_name(effect, "image");
+
+	const bool previous = gs_framebuffer_srgb_enabled();
+	gs_enable_framebuffer_srgb(true);
+
+	gs_blend_state_push();
+	gs_blend_function(GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+
+	gs_vertexbuffer_flush(batch->vb);
+	gs_load_vertexbuffer(batch->vb);
+	gs_load_indexbuffer(NULL);
+
+	gs_effect_set_texture_srgb(image, batch->texture);
+
+	while (gs_effect_loop(effect, "DrawSprites"))
+		gs_draw(GS_TRIS, 0, (uint32_t)(batch->count * SPRITE_VERTS));
+
+	gs_blend_state_pop();
+	gs_enable_framebuffer_srgb(previous);
+
+	GS_DEBUG_MARKER_END();
+
+	batch->texture = NULL;
+	batch->count = 0;
+	batch->total_draws++;
+}
@@ -133,6 +133,18 @@ static inline void unmap_last_surface(struct obs_core_video_mix *video)
 	}
 }
 
+static inline void call_rendered_callbacks(void)
+{
+	pthread_mutex_lock(&obs->data.draw_callbacks_mutex);
+
+	for (size_t i = 0; i < obs->data.rendered_callbacks.num; ++i) {
+		struct rendered_callback *const callback = &obs->data.rendered_callbacks.array[i];
+		callback->rendered(callback->param);
+	}
+
+	pthread_mutex_unlock(&obs->data.draw_callbacks_mutex);
+}
+
 static inline bool can_reuse_mix_texture(const struct obs_core_video_mix *mix, size_t *idx)
 {
 	for (size_t i = 0, num = obs->video.mixes.num; i < num; i++) {
@@ -203,20 +215,152 @@ static inline void render_main_texture(struct obs_core_video_mix *video)
 
 	video->texture_rendered = true;
 
+	call_rendered_callbacks();
+
+	GS_DEBUG_MARKER_END();
+	profile_end(render_main_texture_name);
+}
+
+/* Combines the video generation of every channel of the view (see
+ * obs_source_get_video_gen) with the state that affects conversion.  Returns
+ * false if the frame has to be rendered no matter what. */
+static bool get_mix_frame_gen(struct obs_core_video_mix *video, bool raw_active, bool gpu_active, uint64_t *gen)
+{
+	struct obs_view *view = video->view;
+	uint64_t hash = VIDEO_GEN_HASH_INIT;
+	bool cacheable;
+
+	/* main render callbacks can draw anything */
 	pthread_mutex_lock(&obs->data.draw_callbacks_mutex);
+	cacheable = obs->data.draw_callbacks.num == 0;
+	pthread_mutex_unlock(&obs->data.draw_callbacks_mutex);
 
-	for (size_t i = 0; i < obs->data.rendered_callbacks.num; ++i) {
-		struct rendered_callback *const callback = &obs->data.rendered_callbacks.array[i];
-		callback->rendered(callback->param);
+	if (!cacheable)
+		return false;
+
+	const float sdr_white_level = obs->video.sdr_white_level;
+	const float hdr_nominal_peak_level = obs->video.hdr_nominal_peak_level;
+
+	hash = video_gen_hash(hash, &raw_active, sizeof(raw_active));
+	hash = video_gen_hash(hash, &gpu_active, sizeof(gpu_active));
+	hash = video_gen_hash(hash, &video->render_space, sizeof(video->render_space));
+	hash = video_gen_hash(hash, &sdr_white_level, sizeof(sdr_white_level));
+	hash = video_gen_hash(hash, &hdr_nominal_peak_level, sizeof(hdr_nominal_peak_level));
+
+	pthread_mutex_lock(&view->channels_mutex);
+
+	for (size_t i = 0; i < MAX_CHANNELS; i++) {
+		obs_source_t *source = view->channels[i];
+		uint64_t source_gen;
+
+		hash = video_gen_hash(hash, &source, sizeof(source));
+		if (!source)
+			continue;
+
+		if (!obs_source_get_video_gen(source, &source_gen)) {
+			cacheable = false;
+			break;
+		}
+
+		hash = video_gen_hash(hash, &source_gen, sizeof(source_gen));
 	}
 
-	pthread_mutex_unlock(&obs->data.draw_callbacks_mutex);
+	pthread_mutex_unlock(&view->channels_mutex);
 
-	GS_DEBUG_MARKER_END();
-	profile_end(render_main_texture_name);
+	*gen = hash;
+	return cacheable;
+}
+
+static inline bool mix_frame_unchanged(struct obs_core_video_mix *video, bool raw_active, bool gpu_active)
+{
+	uint64_t gen;
+
+	if (!video->frame_gen_valid || !video->texture_rendered)
+		return false;
+	if (!get_mix_frame_gen(video, raw_active, gpu_active, &gen))
+		return false;
+
+	return gen == video->frame_gen;
+}
+
+bool obs_use_separable_scale(enum obs_scale_type type, uint32_t src_cx, uint32_t src_cy, uint32_t cx, uint32_t cy)
+{
+	if (!obs->video.separable_scale_effect)
+		return false;
+	if (type != OBS_SCALE_BICUBIC && type != OBS_SCALE_LANCZOS)
+		return false;
+
+	/* the single pass effects are fine for upscaling, and keep the
+	 * undistort option of the scale filter */
+	return cx < src_cx || cy < src_cy;
 }
 
-static inline gs_effect_t *get_scale_effect_internal(struct obs_core_video_mix *mix)
+static void set_separable_params(gs_effect_t *effect, float support, uint32_t src_cx, uint32_t src_cy, float ratio)
+{
+	const float kernel_scale = fmaxf(ratio, 1.0f);
+	struct vec2 base, base_i;
+
+	vec2_set(&base, (float)src_cx, (float)src_cy);
+	vec2_set(&base_i, 1.0f / (float)src_cx, 1.0f / (float)src_cy);
+
+	gs_effect_set_vec2(gs_effect_get_param_by_name(effect, "base_dimension"), &base);
+	gs_effect_set_vec2(gs_effect_get_param_by_name(effect, "base_dimension_i"), &base_i);
+	gs_effect_set_float(gs_effect_get_param_by_name(effect, "support"), support);
+	gs_effect_set_float(gs_effect_get_param_by_name(effect, "kernel_scale"), kernel_scale);
+	gs_effect_set_int(gs_effect_get_param_by_name(effect, "taps"), (int)ceilf(2.0f * support * kernel_scale) + 1);
+}
+
+/* Two one-dimensional passes, so a downscale by n costs O(n) taps per pixel
+ * instead of O(n^2).  The intermediate texture is half float to not lose
+ * precision on the linear values between the passes. */
+void obs_draw_separable_scale(gs_texrender_t **intermediate, gs_texture_t *tex, enum obs_scale_type type, uint32_t cx,
+			      uint32_t cy, const char *tech_name, float multiplier)
+{
+	gs_effect_t *effect = obs->video.separable_scale_effect;
+	if (!effect || !intermediate || !tex || !cx || !cy)
+		return;
+
+	gs_eparam_t *image = gs_effect_get_param_by_name(effect, "image");
+	const uint32_t src_cx = gs_texture_get_width(tex);
+	const uint32_t src_cy = gs_texture_get_height(tex);
+	const float support = (type == OBS_SCALE_LANCZOS) ? 3.0f : 2.0f;
+
+	if (!*intermediate)
+		*intermediate = gs_texrender_create(GS_RGBA16F, GS_ZS_NONE);
+	gs_texrender_reset(*intermediate);
+
+	if (gs_texrender_begin(*intermediate, cx, src_cy)) {
+		const bool previous = gs_framebuffer_srgb_enabled();
+		gs_enable_framebuffer_srgb(false);
+		gs_blend_state_push();
+		gs_enable_blending(false);
+		gs_ortho(0.0f, (float)cx, 0.0f, (float)src_cy, -100.0f, 100.0f);
+
+		set_separable_params(effect, support, src_cx, src_cy, (float)src_cx / (float)cx);
+		gs_effect_set_texture_srgb(image, tex);
+
+		while (gs_effect_loop(effect, "DrawHorizontal"))
+			gs_draw_sprite(tex, 0, cx, src_cy);
+
+		gs_blend_state_pop();
+		gs_enable_framebuffer_srgb(previous);
+		gs_texrender_end(*intermediate);
+	}
+
+	gs_texture_t *horizontal = gs_texrender_get_texture(*intermediate);
+	if (!horizontal)
+		return;
+
+	set_separable_params(effect, support, cx, src_cy, (float)src_cy / (float)cy);
+	gs_effect_set_texture(image, horizontal);
+	gs_effect_set_float(gs_effect_get_param_by_name(effect, "multiplier"), multiplier);
+
+	while (gs_effect_loop(effect, tech_name ? tech_name : "Draw"))
+		gs_draw_sprite(horizontal, 0, cx, cy);
+}
+
+static inline gs_effect_t *get_scale_effect_internal(struct obs_core_video_mix *mix, uint32_t src_width,
+						     uint32_t src_height)
 {
 	struct obs_core_video *video = &obs->video;
 	const struct video_output_info *info = video_output_get_info(mix->video);
@@ -224,7 +368,7 @@ static inline gs_effect_t *get_scale_effect_internal(struct obs_core_video_mix *
 	/* if the dimension is under half the size of the original image,
 	 * bicubic/lanczos can't sample enough pixels to create an accurate
 	 * image, so use the bilinear low resolution effect instead */
-	if (info->width < (mix->ovi.base_width / 2) && info->height < (mix->ovi.base_height / 2)) {
+	if (info->width < (src_width / 2) && info->height < (src_height / 2)) {
 		return video->bilinear_lowres_effect;
 	}
 
@@ -242,44 +386,114 @@ static inline gs_effect_t *get_scale_effect_internal(struct obs_core_video_mix *
 	return video->bicubic_effect;
 }
 
-static inline bool resolution_close(struct obs_core_video_mix *mix, uint32_t width, uint32_t height)
+static inline bool resolution_close(uint32_t src_width, uint32_t src_height, uint32_t width, uint32_t height)
 {
-	long width_cmp = (long)mix->ovi.base_width - (long)width;
-	long height_cmp = (long)mix->ovi.base_height - (long)height;
+	long width_cmp = (long)src_width - (long)width;
+	long height_cmp = (long)src_height - (long)height;
 
 	return labs(width_cmp) <= 16 && labs(height_cmp) <= 16;
 }
 
-static inline gs_effect_t *get_scale_effect(struct obs_core_video_mix *mix, uint32_t width, uint32_t height)
+static inline gs_effect_t *get_scale_effect(struct obs_core_video_mix *mix, uint32_t src_width, uint32_t src_height,
+					    uint32_t width, uint32_t height)
 {
 	struct obs_core_video *video = &obs->video;
 
-	if (resolution_close(mix, width, height)) {
+	if (resolution_close(src_width, src_height, width, height)) {
 		return video->default_effect;
 	} else {
 		/* if the scale method couldn't be loaded, use either bicubic
 		 * or bilinear by default */
-		gs_effect_t *effect = get_scale_effect_internal(mix);
+		gs_effect_t *effect = get_scale_effect_internal(mix, src_width, src_height);
 		if (!effect)
 			effect = !!video->bicubic_effect ? video->bicubic_effect : video->default_effect;
 		return effect;
 	}
 }
 
+static gs_texture_t *scale_output_texture(struct obs_core_video_mix *mix, gs_texture_t *base);
+
+/* Mixes that show the same view at the same base size and color space have
+ * identical main textures, so a mix can be scaled from the smallest larger
+ * output of another mix instead of the full resolution image.  Larger outputs
+ * that have not been scaled yet this frame are scaled first, so which mix
+ * gets reused does not depend on the order of the mixes.  An output of
+ * exactly the same size is only reused once it has been scaled. */
+static gs_texture_t *get_scale_source(struct obs_core_video_mix *mix, gs_texture_t *base, uint32_t width,
+				      uint32_t height)
+{
+	struct obs_core_video_mix *source = NULL;
+	uint64_t source_area = (uint64_t)mix->ovi.base_width * mix->ovi.base_height;
+	enum gs_color_format format = gs_texture_get_color_format(mix->output_texture);
+
+	for (size_t i = 0, num = obs->video.mixes.num; i < num; i++) {
+		struct obs_core_video_mix *other = obs->video.mixes.array[i];
+		if (other == mix || !other->view || other->view != mix->view)
+			continue;
+		if (!other->output_scaled && !other->raw_was_active && !other->gpu_was_active)
+			continue;
+		if (other->render_space != mix->render_space || other->ovi.scale_type != mix->ovi.scale_type)
+			continue;
+		if (other->ovi.base_width != mix->ovi.base_width || other->ovi.base_height != mix->ovi.base_height)
+			continue;
+
+		const uint32_t other_width = gs_texture_get_width(other->output_texture);
+		const uint32_t other_height = gs_texture_get_height(other->output_texture);
+		const uint64_t other_area = (uint64_t)other_width * other_height;
+
+		if (other_width < width || other_height < height || other_area >= source_area)
+			continue;
+		if (other_width == width && other_height == height &&
+		    (!other->output_scaled || gs_texture_get_color_format(other->output_texture) != format))
+			continue;
+
+		source = other;
+		source_area = other_area;
+	}
+
+	return source ? scale_output_texture(source, base) : base;
+}
+
+/* Scales the main texture of this frame, which is identical for all mixes
+ * that could share it, into the output texture of the mix */
 static const char *render_output_texture_name = "render_output_texture";
-static inline gs_texture_t *render_output_texture(struct obs_core_video_mix *mix)
+static gs_texture_t *scale_output_texture(struct obs_core_video_mix *mix, gs_texture_t *base)
 {
 	struct obs_video_info *const ovi = &mix->ovi;
-	gs_texture_t *texture = mix->render_texture;
 	gs_texture_t *target = mix->output_texture;
 	const uint32_t width = gs_texture_get_width(target);
 	const uint32_t height = gs_texture_get_height(target);
-	if ((width == ovi->base_width) && (height == ovi->base_height))
+
+	if (mix->output_scaled)
+		return target;
+
+	gs_texture_t *texture = get_scale_source(mix, base, width, height);
+
+	const uint32_t src_width = gs_texture_get_width(texture);
+	const uint32_t src_height = gs_texture_get_height(texture);
+	if (src_width == width && src_height == height)
 		return texture;
 
 	profile_start(render_output_texture_name);
 
-	gs_effect_t *effect = get_scale_effect(mix, width, height);
+	if (!resolution_close(src_width, src_height, width, height) &&
+	    obs_use_separable_scale(ovi->scale_type, src_width, src_height, width, height)) {
+		gs_set_render_target(target, NULL);
+		set_render_size(width, height);
+
+		gs_enable_framebuffer_srgb(true);
+		gs_enable_blending(false);
+		obs_draw_separable_scale(&mix->scale_texrender, texture, ovi->scale_type, width, height, "Draw", 1.0f);
+		gs_enable_blending(true);
+		gs_enable_framebuffer_srgb(false);
+
+		mix->output_scaled = true;
+
+		profile_end(render_output_texture_name);
+		return target;
+	}
+
+	gs_effect_t *effect = get_scale_effect(mix, src_width, src_height, width, height);
 	gs_technique_t *tech = gs_effect_get_technique(effect, "Draw");
 
 	gs_eparam_t *image = gs_effect_get_param_by_name(effect, "image");
@@ -292,13 +506,13 @@ static inline gs_texture_t *render_output_texture(struct obs_core_video_mix *mix
 
 	if (bres) {
 		struct vec2 base;
-		vec2_set(&base, (float)mix->ovi.base_width, (float)mix->ovi.base_height);
+		vec2_set(&base, (float)src_width, (float)src_height);
 		gs_effect_set_vec2(bres, &base);
 	}
 
 	if (bres_i) {
 		struct vec2 base_i;
-		vec2_set(&base_i, 1.0f / (float)mix->ovi.base_width, 1.0f / (float)mix->ovi.base_height);
+		vec2_set(&base_i, 1.0f / (float)src_width, 1.0f / (float)src_height);
 		gs_effect_set_vec2(bres_i, &base_i);
 	}
 
@@ -316,11 +530,24 @@ static inline gs_texture_t *render_output_texture(struct obs_core_video_mix *mix
 	gs_enable_blending(true);
 	gs_enable_framebuffer_srgb(false);
 
+	mix->output_scaled = true;
+
 	profile_end(render_output_texture_name);
 
 	return target;
 }
 
+static inline gs_texture_t *render_output_texture(struct obs_core_video_mix *mix)
+{
+	gs_texture_t *texture = mix->render_texture;
+	gs_texture_t *target = mix->output_texture;
+
+	if (gs_texture_get_width(target) == mix->ovi.base_width && gs_texture_get_height(target) == mix->ovi.base_height)
+		return texture;
+
+	return scale_output_texture(mix, texture);
+}
+
 static void render_convert_plane(gs_effect_t *effect, gs_texture_t *target, const char *tech_name)
 {
 	gs_technique_t *tech = gs_effect_get_technique(effect, tech_name);
@@ -436,6 +663,8 @@ static inline void stage_output_texture(struct obs_core_video_mix *video, int cu
 		video->textures_copied[cur_texture] = true;
 	}
 
+	video->textures_duplicate[cur_texture] = false;
+
 	profile_end(stage_output_texture_name);
 }
 
@@ -536,11 +765,38 @@ end:
 	profile_end(output_gpu_encoders_name);
 }
 
+/* Nothing changed since the last frame: the main, output and converted
+ * textures still hold that frame, so only the encoders are fed again and raw
+ * outputs get the previous frame repeated instead of reading it back again */
+static inline void reuse_video(struct obs_core_video_mix *video, bool raw_active, const bool gpu_active,
+			       int cur_texture)
+{
+	call_rendered_callbacks();
+
+	if (gpu_active)
+		output_gpu_encoders(video, raw_active);
+
+	if (raw_active) {
+		unmap_last_surface(video);
+		video->textures_copied[cur_texture] = false;
+		video->textures_duplicate[cur_texture] = true;
+	}
+
+	obs->video.unchanged_frames++;
+}
+
 static inline void render_video(struct obs_core_video_mix *video, bool raw_active, const bool gpu_active,
 				int cur_texture)
 {
+	const bool unchanged = mix_frame_unchanged(video, raw_active, gpu_active);
+
 	gs_begin_scene();
 
+	if (unchanged) {
+		reuse_video(video, raw_active, gpu_active, cur_texture);
+		goto end;
+	}
+
 	gs_enable_depth_test(false);
 	gs_set_cull_mode(GS_NEITHER);
 
@@ -577,6 +833,10 @@ static inline void render_video(struct obs_core_video_mix *video, bool raw_activ
 	gs_set_render_target(NULL, NULL);
 	gs_enable_blending(true);
 
+	/* Taken after rendering, which updates scene transforms */
+	video->frame_gen_valid = get_mix_frame_gen(video, raw_active, gpu_active, &video->frame_gen);
+
+end:
 	gs_end_scene();
 }
 
@@ -802,14 +1062,195 @@ void add_ready_encoder_group(obs_encoder_t *encoder)
 	pthread_mutex_unlock(&obs->video.encoder_group_mutex);
 }
 
+/* bounds of the spin tail of precise frame pacing */
+#define PACING_SPIN_MIN_NS 50000ULL
+#define PACING_SPIN_MAX_NS 2000000ULL
+
+static const char *frame_pacing_name = "frame_pacing";
+
+/* Sleeps until the spin tail before the target and spins the rest.  The tail
+ * follows twice the average amount the sleep overshot recently, so a loaded
+ * system gets a longer spin and an idle one barely spins at all. */
+static bool sleepto_precise(struct obs_core_video *video, uint64_t target)
+{
+	uint64_t now = os_gettime_ns();
+
+	if (target < now)
+		return false;
+
+	if (target - now > video->pacing_spin_ns) {
+		uint64_t wake_target = target - video->pacing_spin_ns;
+		uint64_t latency;
+
+		os_sleepto_ns(wake_target);
+
+		now = os_gettime_ns();
+		latency = now > wake_target ? now - wake_target : 0;
+
+		video->pacing_wake_latency_ns = video->pacing_wake_latency_ns - video->pacing_wake_latency_ns / 8 +
+						latency / 8;
+
+		video->pacing_spin_ns = video->pacing_wake_latency_ns * 2;
+		if (video->pacing_spin_ns < PACING_SPIN_MIN_NS)
+			video->pacing_spin_ns = PACING_SPIN_MIN_NS;
+		else if (video->pacing_spin_ns > PACING_SPIN_MAX_NS)
+			video->pacing_spin_ns = PACING_SPIN_MAX_NS;
+	}
+
+	os_spinto_ns(target);
+	return true;
+}
+
+static inline bool video_sleepto(struct obs_core_video *video, uint64_t target)
+{
+	long pacing = os_atomic_load_long(&video->frame_pacing);
+
+	if (pacing == OBS_FRAME_PACING_PRECISE_REALTIME && !video->pacing_realtime) {
+		/* only attempted once, priority is never lowered again */
+		video->pacing_realtime = true;
+		if (!os_set_thread_realtime())
+			blog(LOG_WARNING, "Could not raise graphics thread priority");
+	}
+
+	if (pacing == OBS_FRAME_PACING_DEFAULT)
+		return os_sleepto_ns(target);
+
+	return sleepto_precise(video, target);
+}
+
+/* a virtual clock further ahead of the system clock than this was left
+ * behind by freewheel mode, and is moved back to the system clock */
+#define FREEWHEEL_REBASE_NS 1000000000ULL
+
+static inline bool stop_requested(void);
+
+/* Frames would otherwise be skipped by video_output_lock_frame when raw
+ * outputs fall behind, there is no deadline to keep in freewheel mode so the
+ * next frame is only rendered once every raw output has room for it. */
+static void freewheel_wait_for_outputs(void)
+{
+	bool waiting = true;
+
+	while (waiting && !stop_requested()) {
+		waiting = false;
+
+		pthread_mutex_lock(&obs->video.mixes_mutex);
+		for (size_t i = 0, num = obs->video.mixes.num; i < num; i++) {
+			struct obs_core_video_mix *mix = obs->video.mixes.array[i];
+
+			if (!mix->view || !video_output_active(mix->video))
+				continue;
+			if (!video_output_wait_for_free_frame(mix->video, 10)) {
+				waiting = true;
+				break;
+			}
+		}
+		pthread_mutex_unlock(&obs->video.mixes_mutex);
+	}
+}
+
+/* In freewheel mode the graphics thread drives the clock: each rendered frame
+ * publishes its time, audio ticks up to that time are then mixed, and only
+ * after that the next frame is rendered.  Neither side waits on the system
+ * clock, so the pipeline runs as fast as it can render and encode while
+ * audio and video timestamps stay in step. */
+static void freewheel_advance(struct obs_core_video *video, uint64_t cur_time, uint64_t interval_ns)
+{
+	video->freewheel_active = true;
+
+	pthread_mutex_lock(&video->freewheel_mutex);
+	video->freewheel_time = cur_time;
+	video->freewheel_now = cur_time + interval_ns;
+	os_event_signal(video->freewheel_video_event);
+
+	while (video->freewheel_audio_next && video->freewheel_audio_next <= cur_time && !stop_requested()) {
+		pthread_mutex_unlock(&video->freewheel_mutex);
+		os_event_timedwait(video->freewheel_audio_event, 10);
+		pthread_mutex_lock(&video->freewheel_mutex);
+	}
+
+	pthread_mutex_unlock(&video->freewheel_mutex);
+
+	freewheel_wait_for_outputs();
+}
+
+enum audio_clock_state obs_freewheel_audio_clock(void *param, uint64_t audio_time)
+{
+	struct obs_core_video *video = &obs->video;
+	bool due;
+
+	if (!os_atomic_load_bool(&video->freewheel)) {
+		pthread_mutex_lock(&video->freewheel_mutex);
+		video->freewheel_audio_next = 0;
+		pthread_mutex_unlock(&video->freewheel_mutex);
+
+		if (audio_time > os_gettime_ns() + FREEWHEEL_REBASE_NS)
+			return AUDIO_CLOCK_RESET;
+
+		os_sleepto_ns_fast(audio_time);
+		return AUDIO_CLOCK_DUE;
+	}
+
+	pthread_mutex_lock(&video->freewheel_mutex);
+	video->freewheel_audio_next = audio_time;
+	due = audio_time <= video->freewheel_time;
+	pthread_mutex_unlock(&video->freewheel_mutex);
+
+	/* the previous tick is mixed once the next one is asked for */
+	os_event_signal(video->freewheel_audio_event);
+
+	if (due)
+		return AUDIO_CLOCK_DUE;
+
+	os_event_timedwait(video->freewheel_video_event, 10);
+
+	UNUSED_PARAMETER(param);
+	return AUDIO_CLOCK_WAIT;
+}
+
+/* current time of the pipeline, which is the virtual clock in freewheel mode */
+uint64_t obs_clock_ns(void)
+{
+	struct obs_core_video *video = &obs->video;
+	uint64_t now;
+
+	if (!os_atomic_load_bool(&video->freewheel))
+		return os_gettime_ns();
+
+	pthread_mutex_lock(&video->freewheel_mutex);
+	now = video->freewheel_now;
+	pthread_mutex_unlock(&video->freewheel_mutex);
+
+	return now;
+}
+
 static inline void video_sleep(struct obs_core_video *video, uint64_t *p_time, uint64_t interval_ns)
 {
 	struct obs_vframe_info vframe_info;
 	uint64_t cur_time = *p_time;
 	uint64_t t = cur_time + interval_ns;
+	bool on_time = true;
 	int count;
 
-	if (os_sleepto_ns(t)) {
+	if (os_atomic_load_bool(&video->freewheel)) {
+		freewheel_advance(video, cur_time, interval_ns);
+
+	} else if (video->freewheel_active && t > os_gettime_ns() + FREEWHEEL_REBASE_NS) {
+		/* back on the system clock, which is behind the virtual one */
+		video->freewheel_active = false;
+		t = os_gettime_ns();
+
+	} else {
+		video->freewheel_active = false;
+		on_time = video_sleepto(video, t);
+
+		/* Zero length, only its time between calls matters: the
+		 * wakeup interval histogram against the frame interval */
+		profile_start(frame_pacing_name);
+		profile_end(frame_pacing_name);
+	}
+
+	if (on_time) {
 		*p_time = t;
 		count = 1;
 	} else {
@@ -907,6 +1348,13 @@ static inline void output_frame(struct obs_core_video_mix *video)
 		profile_start(output_frame_output_video_data_name);
 		output_video_data(video, &frame, vframe_info.count);
 		profile_end(output_frame_output_video_data_name);
+
+	} else if (raw_active && video->textures_duplicate[prev_texture]) {
+		struct obs_vframe_info vframe_info;
+		deque_pop_front(&video->vframe_info_buffer, &vframe_info, sizeof(vframe_info));
+
+		video_output_repeat_frame(video->video, vframe_info.count, vframe_info.timestamp);
+		video->textures_duplicate[prev_texture] = false;
 	}
 
 	if (++video->cur_texture == NUM_TEXTURES)
@@ -916,6 +1364,10 @@ static inline void output_frame(struct obs_core_video_mix *video)
 static inline void output_frames(void)
 {
 	pthread_mutex_lock(&obs->video.mixes_mutex);
+	for (size_t i = 0, num = obs->video.mixes.num; i < num; i++) {
+		struct obs_core_video_mix *mix = obs->video.mixes.array[i];
+		mix->output_scaled = false;
+	}
 	for (size_t i = 0, num = obs->video.mixes.num; i < num; i++) {
 		struct obs_core_video_mix *mix = obs->video.mixes.array[i];
 		if (mix->view) {
@@ -937,6 +1389,7 @@ static void clear_base_frame_data(struct obs_core_video_mix *video)
 {
 	video->texture_rendered = false;
 	video->texture_converted = false;
+	video->frame_gen_valid = false;
 	deque_free(&video->vframe_info_buffer);
 	video->cur_texture = 0;
 }
@@ -944,12 +1397,15 @@ static void clear_base_frame_data(struct obs_core_video_mix *video)
 static void clear_raw_frame_data(struct obs_core_video_mix *video)
 {
 	memset(video->textures_copied, 0, sizeof(video->textures_copied));
+	memset(video->textures_duplicate, 0, sizeof(video->textures_duplicate));
+	video->frame_gen_valid = false;
 	deque_free(&video->vframe_info_buffer);
 }
 
 static void clear_gpu_frame_data(struct obs_core_video_mix *video)
 {
 	deque_free(&video->vframe_info_buffer_gpu);
+	video->frame_gen_valid = false;
 }
 
 extern THREAD_LOCAL bool is_graphics_thread;
@@ -1048,6 +1504,10 @@ static void uninit_winrt_state(struct winrt_state *winrt)
 
 #endif // #ifdef _WIN32
 
+/* render targets not reused within this time are freed */
+#define TEXTURE_POOL_MAX_AGE_NS 3000000000ULL
+
+static const char *texture_pool_trim_name = "texture_pool_trim";
 static const char *tick_sources_name = "tick_sources";
 static const char *render_displays_name = "render_displays";
 static const char *output_frame_name = "output_frame";
@@ -1106,6 +1566,9 @@ bool obs_graphics_thread_loop(struct obs_graphics_context *context)
 
 	gs_enter_context(obs->video.graphics);
 	gs_begin_frame();
+	profile_start(texture_pool_trim_name);
+	gs_texture_pool_trim(TEXTURE_POOL_MAX_AGE_NS);
+	profile_end(texture_pool_trim_name);
 	gs_leave_context();
 
 	profile_start(tick_sources_name);
@@ -1176,6 +1639,9 @@ void *obs_graphics_thread(void *param)
 	const char *video_thread_name = profile_store_name(obs_get_profiler_name_store(),
 							   "obs_graphics_thread(%g" NBSP "ms)", interval / 1000000.);
 	profile_register_root(video_thread_name, interval);
+	profile_register_root(frame_pacing_name, interval);
+
+	obs->video.pacing_spin_ns = PACING_SPIN_MAX_NS / 4;
 
 	srand((unsigned int)time(NULL));
 
@@ -504,6 +504,13 @@ static int obs_init_graphics(struct obs_video_info *ovi)
 	profile_start(shader_comp_name);
 	gs_enter_context(video->graphics);
 
+	if (obs->module_config_path) {
+		struct dstr cache_path = {0};
+		dstr_printf(&cache_path, "%s/%s/shader-cache", obs->module_config_path, ovi->graphics_module);
+		gs_set_cache_path(cache_path.array);
+		dstr_free(&cache_path);
+	}
+
 	char *filename = obs_find_data_file("default.effect");
 	video->default_effect = gs_effect_create_from_file(filename, NULL);
 	bfree(filename);
@@ -522,32 +529,38 @@ static int obs_init_graphics(struct obs_video_info *ovi)
 	video->solid_effect = gs_effect_create_from_file(filename, NULL);
 	bfree(filename);
 
-	filename = obs_find_data_file("repeat.effect");
-	video->repeat_effect = gs_effect_create_from_file(filename, NULL);
-	bfree(filename);
-
 	filename = obs_find_data_file("format_conversion.effect");
 	video->conversion_effect = gs_effect_create_from_file(filename, NULL);
 	bfree(filename);
 
+	filename = obs_find_data_file("premultiplied_alpha.effect");
+	video->premultiplied_alpha_effect = gs_effect_create_from_file(filename, NULL);
+	bfree(filename);
+
+	/* Not drawn with by every scene, their shaders are compiled on first
+	 * use or by obs_warm_up_effects */
+	filename = obs_find_data_file("repeat.effect");
+	video->repeat_effect = gs_effect_create_from_file_lazy(filename, NULL);
+	bfree(filename);
+
 	filename = obs_find_data_file("bicubic_scale.effect");
-	video->bicubic_effect = gs_effect_create_from_file(filename, NULL);
+	video->bicubic_effect = gs_effect_create_from_file_lazy(filename, NULL);
 	bfree(filename);
 
 	filename = obs_find_data_file("lanczos_scale.effect");
-	video->lanczos_effect = gs_effect_create_from_file(filename, NULL);
+	video->lanczos_effect = gs_effect_create_from_file_lazy(filename, NULL);
 	bfree(filename);
 
-	filename = obs_find_data_file("area.effect");
-	video->area_effect = gs_effect_create_from_file(filename, NULL);
+	filename = obs_find_data_file("separable_scale.effect");
+	video->separable_scale_effect = gs_effect_create_from_file_lazy(filename, NULL);
 	bfree(filename);
 
-	filename = obs_find_data_file("bilinear_lowres_scale.effect");
-	video->bilinear_lowres_effect = gs_effect_create_from_file(filename, NULL);
+	filename = obs_find_data_file("area.effect");
+	video->area_effect = gs_effect_create_from_file_lazy(filename, NULL);
 	bfree(filename);
 
-	filename = obs_find_data_file("premultiplied_alpha.effect");
-	video->premultiplied_alpha_effect = gs_effect_create_from_file(filename, NULL);
+	filename = obs_find_data_file("bilinear_lowres_scale.effect");
+	video->bilinear_lowres_effect = gs_effect_create_from_file_lazy(filename, NULL);
 	bfree(filename);
 
 	point_sampler.max_anisotropy = 1;
@@ -576,6 +589,10 @@ static int obs_init_graphics(struct obs_video_info *ovi)
 
 	gs_leave_context();
 	profile_end(shader_comp_name);
+
+	if (success)
+		obs_display_present_init(ovi->graphics_module, ovi->adapter);
+
 	profile_end(obs_init_graphics_name);
 
 	return success ? OBS_VIDEO_SUCCESS : OBS_VIDEO_FAIL;
@@ -776,6 +793,8 @@ static void obs_free_render_textures(struct obs_core_video_mix *video)
 	}
 
 	gs_texture_destroy(video->render_texture);
+	gs_texrender_destroy(video->scale_texrender);
+	video->scale_texrender = NULL;
 
 	for (size_t c = 0; c < NUM_CHANNELS; c++) {
 		if (video->convert_textures[c]) {
@@ -834,6 +853,12 @@ static void obs_free_video(void)
 	da_free(obs->video.mixes);
 	if (num_views > 0)
 		blog(LOG_WARNING, "Number of remaining views: %ld", num_views);
+	if (obs->video.scene_cache_hits || obs->video.scene_cache_misses)
+		blog(LOG_INFO, "Scene item texture cache: %" PRIu64 " hits, %" PRIu64 " misses",
+		     obs->video.scene_cache_hits, obs->video.scene_cache_misses);
+	if (obs->video.render_memo_renders)
+		blog(LOG_INFO, "Source render memo: %" PRIu64 " renders, %" PRIu64 " draws reused",
+		     obs->video.render_memo_renders, obs->video.render_memo_hits);
 	pthread_mutex_unlock(&obs->video.mixes_mutex);
 
 	pthread_mutex_destroy(&obs->video.mixes_mutex);
@@ -852,15 +877,39 @@ static void obs_free_video(void)
 	deque_free(&obs->video.tasks);
 }
 
+static void stop_effect_warmup(void)
+{
+	struct obs_core_video *video = &obs->video;
+
+	if (video->effect_warmup_active) {
+		os_atomic_set_bool(&video->effect_warmup_stop, true);
+		pthread_join(video->effect_warmup_thread, NULL);
+		video->effect_warmup_active = false;
+	}
+}
+
 static void obs_free_graphics(void)
 {
 	struct obs_core_video *video = &obs->video;
 
+	stop_effect_warmup();
+	obs_display_present_free();
+
 	if (video->graphics) {
+		struct gs_texture_pool_stats pool = {0};
+
 		gs_enter_context(video->graphics);
 
+		gs_texture_pool_get_stats(&pool);
+		if (pool.hits || pool.misses)
+			blog(LOG_INFO,
+			     "Texture pool: %" PRIu64 " reused, %" PRIu64 " created, %zu held (%" PRIu64 " KiB)",
+			     pool.hits, pool.misses, pool.free_count, pool.free_bytes / 1024);
+
 		gs_texture_destroy(video->transparent_texture);
 
+		sprite_batch_free();
+
 		gs_samplerstate_destroy(video->point_sampler);
 
 		gs_effect_destroy(video->default_effect);
@@ -871,6 +920,7 @@ static void obs_free_graphics(void)
 		gs_effect_destroy(video->bicubic_effect);
 		gs_effect_destroy(video->repeat_effect);
 		gs_effect_destroy(video->lanczos_effect);
+		gs_effect_destroy(video->separable_scale_effect);
 		gs_effect_destroy(video->area_effect);
 		gs_effect_destroy(video->bilinear_lowres_effect);
 		video->default_effect = NULL;
@@ -923,9 +973,10 @@ static bool obs_init_audio(struct audio_output_info *ai)
 	signal_handler_connect(obs->signals, "deduplication_changed", apply_monitoring_deduplication, NULL);
 
 	errorcode = audio_output_open(&audio->audio, ai);
-	if (errorcode == AUDIO_OUTPUT_SUCCESS)
+	if (errorcode == AUDIO_OUTPUT_SUCCESS) {
+		audio_output_set_clock(audio->audio, obs_freewheel_audio_clock, NULL);
 		return true;
-	else if (errorcode == AUDIO_OUTPUT_INVALIDPARAM)
+	} else if (errorcode == AUDIO_OUTPUT_INVALIDPARAM)
 		blog(LOG_ERROR, "Invalid audio parameters specified");
 	else
 		blog(LOG_ERROR, "Could not open audio output");
@@ -963,6 +1014,32 @@ static void obs_free_audio(void)
 	memset(audio, 0, sizeof(struct obs_core_audio));
 }
 
+/* Leaves nothing behind on failure, obs_shutdown only sees the initial
+ * values then */
+static bool obs_init_freewheel(void)
+{
+	struct obs_core_video *video = &obs->video;
+
+	if (pthread_mutex_init(&video->freewheel_mutex, NULL) != 0)
+		goto fail0;
+	if (os_event_init(&video->freewheel_video_event, OS_EVENT_TYPE_AUTO) != 0)
+		goto fail1;
+	if (os_event_init(&video->freewheel_audio_event, OS_EVENT_TYPE_AUTO) != 0)
+		goto fail2;
+
+	return true;
+
+fail2:
+	os_event_destroy(video->freewheel_video_event);
+	video->freewheel_video_event = NULL;
+fail1:
+	pthread_mutex_destroy(&video->freewheel_mutex);
+	pthread_mutex_init_value(&video->freewheel_mutex);
+fail0:
+	blog(LOG_ERROR, "Failed to initialize freewheel clock");
+	return false;
+}
+
 static bool obs_init_data(void)
 {
 	struct obs_core_data *data = &obs->data;
@@ -1229,6 +1306,7 @@ static bool obs_init(const char *locale, const char *module_config_path, profile
 	pthread_mutex_init_value(&obs->video.task_mutex);
 	pthread_mutex_init_value(&obs->video.encoder_group_mutex);
 	pthread_mutex_init_value(&obs->video.mixes_mutex);
+	pthread_mutex_init_value(&obs->video.freewheel_mutex);
 
 	obs->name_store_owned = !store;
 	obs->name_store = store ? store : profiler_name_store_create();
@@ -1239,6 +1317,8 @@ static bool obs_init(const char *locale, const char *module_config_path, profile
 
 	log_system_info();
 
+	if (!obs_init_freewheel())
+		return false;
 	if (!obs_init_data())
 		return false;
 	if (!obs_init_handlers())
@@ -1437,6 +1517,9 @@ void obs_shutdown(void)
 	os_task_queue_destroy(obs->destruction_task_thread);
 	obs_free_hotkeys();
 	obs_free_graphics();
+	os_event_destroy(obs->video.freewheel_video_event);
+	os_event_destroy(obs->video.freewheel_audio_event);
+	pthread_mutex_destroy(&obs->video.freewheel_mutex);
 	proc_handler_destroy(obs->procs);
 	signal_handler_destroy(obs->signals);
 	obs->procs = NULL;
@@ -1816,6 +1899,85 @@ void obs_leave_graphics(void)
 		gs_leave_context();
 }
 
+static void *effect_warmup_thread(void *param)
+{
+	struct obs_core_video *video = param;
+	uint32_t passes = 0;
+	bool more = true;
+
+	os_set_thread_name("libobs: effect warm-up");
+
+	/* One pass at a time, so the graphics thread is never held up for
+	 * longer than a single shader compile */
+	while (more && !os_atomic_load_bool(&video->effect_warmup_stop)) {
+		gs_enter_context(video->graphics);
+		more = gs_effect_compile_next();
+		gs_leave_context();
+
+		if (more) {
+			passes++;
+			os_sleep_ms(1);
+		}
+	}
+
+	blog(LOG_DEBUG, "Effect warm-up compiled %" PRIu32 " passes", passes);
+	return NULL;
+}
+
+void obs_warm_up_effects(void)
+{
+	struct obs_core_video *video = &obs->video;
+
+	if (!video->graphics || video->effect_warmup_active)
+		return;
+
+	video->effect_warmup_stop = false;
+	if (pthread_create(&video->effect_warmup_thread, NULL, effect_warmup_thread, video) == 0)
+		video->effect_warmup_active = true;
+	else
+		blog(LOG_WARNING, "Failed to create effect warm-up thread");
+}
+
+void obs_set_frame_pacing(enum obs_frame_pacing pacing)
+{
+	if (!obs)
+		return;
+
+	os_atomic_set_long(&obs->video.frame_pacing, (long)pacing);
+}
+
+enum obs_frame_pacing obs_get_frame_pacing(void)
+{
+	return obs ? (enum obs_frame_pacing)os_atomic_load_long(&obs->video.frame_pacing) : OBS_FRAME_PACING_DEFAULT;
+}
+
+bool obs_set_freewheel(bool freewheel)
+{
+	if (!obs)
+		return false;
+	if (os_atomic_load_bool(&obs->video.freewheel) == freewheel)
+		return true;
+
+	if (obs_video_active()) {
+		blog(LOG_WARNING, "obs_set_freewheel: Cannot change the clock while outputs are active");
+		return false;
+	}
+
+	/* the graphics thread moves it on from the next frame */
+	pthread_mutex_lock(&obs->video.freewheel_mutex);
+	obs->video.freewheel_now = os_gettime_ns();
+	pthread_mutex_unlock(&obs->video.freewheel_mutex);
+
+	os_atomic_set_bool(&obs->video.freewheel, freewheel);
+	blog(LOG_INFO, "Freewheel mode %s", freewheel ? "enabled" : "disabled");
+	return true;
+}
+
+bool obs_freewheel_enabled(void)
+{
+	return obs ? os_atomic_load_bool(&obs->video.freewheel) : false;
+}
+
 audio_t *obs_get_audio(void)
 {
 	return obs->audio.audio;
@@ -3082,6 +3244,19 @@ uint32_t obs_get_lagged_frames(void)
 	return obs->video.lagged_frames;
 }
 
+uint32_t obs_get_unchanged_frames(void)
+{
+	return obs->video.unchanged_frames;
+}
+
+void obs_get_scene_cache_stats(uint64_t *hits, uint64_t *misses)
+{
+	if (hits)
+		*hits = obs->video.scene_cache_hits;
+	if (misses)
+		*misses = obs->video.scene_cache_misses;
+}
+
 struct obs_core_video_mix *get_mix_for_video(video_t *v)
 {
 	struct obs_core_video_mix *result = NULL;
@@ -705,6 +705,35 @@ EXPORT void obs_enter_graphics(void);
 /** Helper function for leaving the OBS graphics context */
 EXPORT void obs_leave_graphics(void);
 
+/**
+ * Shaders of effects created with gs_effect_create_from_file_lazy are compiled
+ * the first time they are drawn with.  This starts a background thread that
+ * compiles the remaining ones ahead of time.
+ */
+EXPORT void obs_warm_up_effects(void);
+
+enum obs_frame_pacing {
+	OBS_FRAME_PACING_DEFAULT,
+	OBS_FRAME_PACING_PRECISE,
+	OBS_FRAME_PACING_PRECISE_REALTIME,
+};
+
+/**
+ * Sets how the graphics thread waits for the next frame.  Precise pacing
+ * sleeps until shortly before the frame is due and spins the rest, the
+ * realtime variant also raises the priority of the graphics thread.
+ */
+EXPORT void obs_set_frame_pacing(enum obs_frame_pacing pacing);
+EXPORT enum obs_frame_pacing obs_get_frame_pacing(void);
+
+/**
+ * Runs video and audio on a virtual clock instead of the system clock, as
+ * fast as frames can be rendered and encoded.  Can only be changed while no
+ * outputs are active.
+ */
+EXPORT bool obs_set_freewheel(bool freewheel);
+EXPORT bool obs_freewheel_enabled(void);
+
 /** Gets the main audio output handler for this OBS context */
 EXPORT audio_t *obs_get_audio(void);
 
@@ -804,6 +833,23 @@ enum obs_base_effect {
 /** Returns a commonly used base effect */
 EXPORT gs_effect_t *obs_get_base_effect(enum obs_base_effect effect);
 
+/**
+ * Returns whether scaling with the given type between these sizes is done
+ * with obs_draw_separable_scale (bicubic and lanczos downscales)
+ */
+EXPORT bool obs_use_separable_scale(enum obs_scale_type type, uint32_t src_cx, uint32_t src_cy, uint32_t cx,
+				    uint32_t cy);
+
+/**
+ * Draws a texture at cx x cy with a separable bicubic or lanczos kernel that
+ * is widened to the scale ratio.  The horizontal pass is rendered into
+ * intermediate (created as needed), the vertical pass is drawn with the
+ * technique tech_name (Draw, DrawMultiply, DrawTonemap or
+ * DrawMultiplyTonemap) into the current render target.
+ */
+EXPORT void obs_draw_separable_scale(gs_texrender_t **intermediate, gs_texture_t *tex, enum obs_scale_type type,
+				     uint32_t cx, uint32_t cy, const char *tech_name, float multiplier);
+
 /** Returns the primary obs signal handler */
 EXPORT signal_handler_t *obs_get_signal_handler(void);
 
@@ -913,6 +959,13 @@ EXPORT uint64_t obs_get_frame_interval_ns(void);
 EXPORT uint32_t obs_get_total_frames(void);
 EXPORT uint32_t obs_get_lagged_frames(void);
 
+/** Number of frames that were not rendered again because nothing changed */
+EXPORT uint32_t obs_get_unchanged_frames(void);
+
+/** Number of scene item textures reused from a previous frame (hits) and
+ * rendered again (misses) */
+EXPORT void obs_get_scene_cache_stats(uint64_t *hits, uint64_t *misses);
+
 OBS_DEPRECATED EXPORT bool obs_nv12_tex_active(void);
 OBS_DEPRECATED EXPORT bool obs_p010_tex_active(void);
 
@@ -1023,6 +1076,18 @@ EXPORT bool obs_display_enabled(obs_display_t *display);
 
 EXPORT void obs_display_set_background_color(obs_display_t *display, uint32_t color);
 
+/**
+ * Limits how often the display is rendered and presented, 0 renders it on
+ * every frame.  Skipped frames keep showing the last presented image.
+ */
+EXPORT void obs_display_set_max_fps(obs_display_t *display, double fps);
+
+/**
+ * Marks the display as occluded (minimized or fully covered window), which
+ * skips rendering it until it is visible again.
+ */
+EXPORT void obs_display_set_occluded(obs_display_t *display, bool occluded);
+
 EXPORT void obs_display_size(obs_display_t *display, uint32_t *width, uint32_t *height);
 
 /* ------------------------------------------------------------------------- */
@@ -1451,6 +1516,12 @@ EXPORT void obs_source_output_audio(obs_source_t *source, const struct obs_sourc
 /** Signal an update to any currently used properties via 'update_properties' */
 EXPORT void obs_source_update_properties(obs_source_t *source);
 
+/**
+ * Notifies that the video of a source with the OBS_SOURCE_STATIC_VIDEO flag
+ * changed outside of a settings update
+ */
+EXPORT void obs_source_video_changed(obs_source_t *source);
+
 /** Gets the current async video frame */
 EXPORT struct obs_source_frame *obs_source_get_frame(obs_source_t *source);
 
@@ -1497,6 +1568,12 @@ EXPORT void obs_source_process_filter_tech_end(obs_source_t *filter, gs_effect_t
 /** Skips the filter if the filter is invalid and cannot be rendered */
 EXPORT void obs_source_skip_video_filter(obs_source_t *filter);
 
+/**
+ * Gets a parameter of the fused function of a filter, for use in
+ * obs_source_info.video_set_fused_params.  The name is given without the '$'.
+ */
+EXPORT gs_eparam_t *obs_filter_get_fused_param(gs_effect_t *effect, const char *prefix, const char *name);
+
 /**
  * Adds an active child source.  Must be called by parent sources on child
  * sources when the child is added and active.  This ensures that the source is
@@ -2305,6 +2382,22 @@ EXPORT void obs_encoder_set_gpu_scale_type(obs_encoder_t *encoder, enum obs_scal
  */
 EXPORT bool obs_encoder_set_frame_rate_divisor(obs_encoder_t *encoder, uint32_t divisor);
 
+/**
+ * Runs the encode callback of an encoder on a dedicated thread instead of the
+ * audio/video output thread, so that multiple encoders run in parallel.
+ *
+ * Encoders are only threaded by default if they set OBS_ENCODER_CAP_THREADED.
+ * Threaded raw video encoders reference queued frames instead of copying
+ * them, if an encoder falls behind only its own frames are dropped.  Threaded
+ * audio encoders never drop data.
+ *
+ * Can only be called on stopped encoders, changing this on the fly is not supported
+ */
+EXPORT bool obs_encoder_set_threaded(obs_encoder_t *encoder, bool threaded);
+
+/** Returns whether the encoder runs on a dedicated thread */
+EXPORT bool obs_encoder_threaded(const obs_encoder_t *encoder);
+
 /**
  * Adds region of interest (ROI) for an encoder. This allows prioritizing
  * quality of regions of the frame.
@@ -2344,6 +2437,9 @@ EXPORT uint32_t obs_encoder_get_frame_rate_divisor(const obs_encoder_t *encoder)
 /** For video encoders, returns the number of frames encoded */
 EXPORT uint32_t obs_encoder_get_encoded_frames(const obs_encoder_t *encoder);
 
+/** Returns the average time spent encoding a frame since the encoder started */
+EXPORT uint64_t obs_encoder_get_average_encode_time_ns(obs_encoder_t *encoder);
+
 /** For audio encoders, returns the sample rate of the audio */
 EXPORT uint32_t obs_encoder_get_sample_rate(const obs_encoder_t *encoder);
 
@@ -2452,6 +2548,21 @@ EXPORT uint32_t obs_encoder_get_caps(const obs_encoder_t *encoder);
 EXPORT void obs_encoder_packet_ref(struct encoder_packet *dst, struct encoder_packet *src);
 EXPORT void obs_encoder_packet_release(struct encoder_packet *packet);
 
+/** Appends SEI NAL units (AVC/HEVC) or metadata OBUs (AV1) to a packet's
+ * prefix units without touching the packet data.  Outside of packet delivery
+ * the units are inserted into the packet data right away. */
+EXPORT void obs_encoder_packet_add_prefix(struct encoder_packet *packet, const uint8_t *data, size_t size);
+
+/** Gets the prefix units of a packet that is being delivered to an output */
+EXPORT bool obs_encoder_packet_get_prefix(const struct encoder_packet *packet, const uint8_t **data, size_t *size);
+
+/** Returns the offset into the packet data where its prefix units belong */
+EXPORT size_t obs_encoder_packet_prefix_offset(const struct encoder_packet *packet);
+
+/** Copies the prefix units into the packet data, for outputs that pass
+ * packet data through as-is */
+EXPORT void obs_encoder_packet_merge_prefix(struct encoder_packet *packet);
+
 EXPORT void *obs_encoder_create_rerouted(obs_encoder_t *encoder, const char *reroute_id);
 
 /** Returns whether encoder is paused */
@@ -164,3 +164,28 @@ void dbus_inhibit_sleep(struct dbus_sleep_info *info, const char *reason, bool a
 	else
 		info->cookie = 0;
 }
+
+/* rtkit lives on the system bus, unlike the services above */
+bool dbus_make_thread_high_priority(uint64_t thread_id, int32_t priority)
+{
+	g_autoptr(GDBusConnection) c = NULL;
+	g_autoptr(GVariant) reply = NULL;
+	g_autoptr(GError) error = NULL;
+
+	c = g_bus_get_sync(G_BUS_TYPE_SYSTEM, NULL, &error);
+	if (!c) {
+		blog(LOG_WARNING, "Could not connect to the system bus: %s", error->message);
+		return false;
+	}
+
+	reply = g_dbus_connection_call_sync(c, "org.freedesktop.RealtimeKit1", "/org/freedesktop/RealtimeKit1",
+					    "org.freedesktop.RealtimeKit1", "MakeThreadHighPriority",
+					    g_variant_new("(ti)", thread_id, priority), NULL, G_DBUS_CALL_FLAGS_NONE, -1,
+					    NULL, &error);
+	if (!reply) {
+		blog(LOG_WARNING, "Failed to call MakeThreadHighPriority: %s", error->message);
+		return false;
+	}
+
+	return true;
+}
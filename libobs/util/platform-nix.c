@@ -26,6 +26,7 @@
 #include <unistd.h>
 #include <glob.h>
 #include <time.h>
+#include <sched.h>
 #include <signal.h>
 #include <uuid/uuid.h>
 
@@ -52,6 +53,9 @@
 #include <sys/sysinfo.h>
 #endif
 #include <spawn.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
 #endif
 
 #include "darray.h"
@@ -177,6 +181,16 @@ bool os_sleepto_ns(uint64_t time_target)
 	if (time_target < current)
 		return false;
 
+#if !defined(__APPLE__)
+	/* Same clock as os_gettime_ns, sleeping to an absolute time can't
+	 * drift when the call is interrupted or preempted */
+	struct timespec target;
+	target.tv_sec = time_target / 1000000000;
+	target.tv_nsec = time_target % 1000000000;
+
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &target, NULL) == EINTR)
+		;
+#else
 	time_target -= current;
 
 	struct timespec req, remain;
@@ -189,10 +203,70 @@ bool os_sleepto_ns(uint64_t time_target)
 		req = remain;
 		memset(&remain, 0, sizeof(remain));
 	}
+#endif
 
 	return true;
 }
 
+static inline void cpu_relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+	__asm__ volatile("yield");
+#endif
+}
+
+bool os_spinto_ns(uint64_t time_target)
+{
+	uint64_t current = os_gettime_ns();
+	if (time_target < current)
+		return false;
+
+	while (current < time_target) {
+		cpu_relax();
+		current = os_gettime_ns();
+	}
+
+	return true;
+}
+
+#if defined(__linux__) && defined(GIO_FOUND)
+extern bool dbus_make_thread_high_priority(uint64_t thread_id, int32_t priority);
+#endif
+
+/* nice level requested from rtkit, its default minimum */
+#define RTKIT_NICE_LEVEL -15
+
+bool os_set_thread_realtime(void)
+{
+	struct sched_param param = {0};
+	int policy = SCHED_FIFO;
+
+#ifdef SCHED_RESET_ON_FORK
+	/* don't hand real-time scheduling down to spawned processes */
+	policy |= SCHED_RESET_ON_FORK;
+#endif
+
+	param.sched_priority = sched_get_priority_min(SCHED_FIFO);
+	if (pthread_setschedparam(pthread_self(), policy, &param) == 0) {
+		blog(LOG_INFO, "Thread scheduling set to SCHED_FIFO");
+		return true;
+	}
+
+#if defined(__linux__) && defined(GIO_FOUND)
+	/* rtkit is only asked for a nice level, real-time threads from rtkit
+	 * require an RLIMIT_RTTIME that a long frame (e.g. a shader compile)
+	 * would exceed, which gets the process killed */
+	if (dbus_make_thread_high_priority((uint64_t)syscall(SYS_gettid), RTKIT_NICE_LEVEL)) {
+		blog(LOG_INFO, "Thread priority raised through rtkit");
+		return true;
+	}
+#endif
+
+	return false;
+}
+
 bool os_sleepto_ns_fast(uint64_t time_target)
 {
 	uint64_t current = os_gettime_ns();
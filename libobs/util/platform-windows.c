@@ -361,6 +361,29 @@ bool os_sleepto_ns(uint64_t time_target)
 	return stall;
 }
 
+bool os_spinto_ns(uint64_t time_target)
+{
+	uint64_t current = os_gettime_ns();
+	if (time_target < current)
+		return false;
+
+	while (current < time_target) {
+		YieldProcessor();
+		current = os_gettime_ns();
+	}
+
+	return true;
+}
+
+bool os_set_thread_realtime(void)
+{
+	if (!SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL))
+		return false;
+
+	blog(LOG_INFO, "Thread priority set to THREAD_PRIORITY_TIME_CRITICAL");
+	return true;
+}
+
 bool os_sleepto_ns_fast(uint64_t time_target)
 {
 	uint64_t current = os_gettime_ns();
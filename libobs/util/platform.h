@@ -96,6 +96,20 @@ EXPORT void os_end_high_performance(os_performance_token_t *);
  */
 EXPORT bool os_sleepto_ns(uint64_t time_target);
 EXPORT bool os_sleepto_ns_fast(uint64_t time_target);
+
+/**
+ * Busy-waits until a specific time (in nanoseconds).  Meant for the last
+ * fraction of a millisecond before a deadline, after sleeping with
+ * os_sleepto_ns.  Returns false if already at or past target time.
+ */
+EXPORT bool os_spinto_ns(uint64_t time_target);
+
+/**
+ * Raises the scheduling priority of the calling thread for latency sensitive
+ * work.  Tries real-time scheduling first, and on Linux falls back to asking
+ * rtkit for a high priority.  Returns false if nothing could be changed.
+ */
+EXPORT bool os_set_thread_realtime(void);
 EXPORT void os_sleep_ms(uint32_t duration);
 
 EXPORT uint64_t os_gettime_ns(void);
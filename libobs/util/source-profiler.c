@@ -23,10 +23,26 @@
 #include "threading.h"
 #include "uthash.h"
 
+/* Index of the parent of top-level sections */
+#define SECTION_ROOT SIZE_MAX
+
+/* Named time range within the rendering of a source (a filter, one pass of a
+ * technique, async frame conversion).  Sections opened while another section
+ * of the same source is open become its children. */
+struct section_sample {
+	char name[PROFILER_SECTION_NAME_LEN];
+	size_t parent;
+	bool done;
+	/* Start timestamp until the section is closed, duration after */
+	uint64_t cpu;
+	gs_timer_t *timer;
+};
+
 struct frame_sample {
 	uint64_t tick;
 	DARRAY(uint64_t) render_cpu;
 	DARRAY(gs_timer_t *) render_timers;
+	DARRAY(struct section_sample) sections;
 };
 
 /* Buffer frame data collection to give GPU time to finish rendering.
@@ -53,6 +69,18 @@ struct ucirclebuf {
 	uint64_t *array;
 };
 
+struct section_entry {
+	char name[PROFILER_SECTION_NAME_LEN];
+	size_t parent;
+
+	/* Frames since the section was last rendered */
+	uint64_t unseen;
+
+	/* Sum of all occurrences in a frame, for last N frames */
+	struct ucirclebuf cpu;
+	struct ucirclebuf gpu;
+};
+
 struct profiler_entry {
 	/* the pointer address of the source is the hashtable key */
 	uintptr_t key;
@@ -69,6 +97,8 @@ struct profiler_entry {
 	struct ucirclebuf async_frame_ts;
 	/* Timestamps of last N async frames rendered */
 	struct ucirclebuf async_rendered_ts;
+	/* Section tree, parents always come before their children */
+	DARRAY(struct section_entry) sections;
 
 	UT_hash_handle hh;
 };
@@ -82,6 +112,17 @@ static uint8_t timer_idx = 0;
 static gs_timer_range_t *timer_ranges[FRAME_BUFFER_SIZE] = {0};
 
 static uint64_t profiler_samples = 0;
+
+/* Sections currently open on the graphics thread, innermost last */
+struct open_section {
+	const obs_source_t *source;
+	struct frame_sample *frame;
+	size_t idx;
+};
+static DARRAY(struct open_section) open_sections;
+/* Maps sections of a frame to the section tree of the entry */
+static DARRAY(size_t) section_map;
+
 /* Sources can be rendered more than once per frame, to avoid reallocating
  * memory in the majority of cases, reserve at least two. */
 static const size_t render_times_reservation = 2;
@@ -132,15 +173,18 @@ static struct frame_sample *frame_sample_create(void)
 
 static void frame_sample_destroy(struct frame_sample *sample)
 {
-	if (sample->render_timers.num) {
+	if (sample->render_timers.num || sample->sections.num) {
 		gs_enter_context(obs->video.graphics);
 		for (size_t i = 0; i < sample->render_timers.num; i++)
 			gs_timer_destroy(sample->render_timers.array[i]);
+		for (size_t i = 0; i < sample->sections.num; i++)
+			gs_timer_destroy(sample->sections.array[i].timer);
 		gs_leave_context();
 	}
 
 	da_free(sample->render_cpu);
 	da_free(sample->render_timers);
+	da_free(sample->sections);
 	bfree(sample);
 }
 
@@ -177,8 +221,18 @@ static struct profiler_entry *entry_create(const uintptr_t key)
 	return ent;
 }
 
+static void entry_free_sections(struct profiler_entry *entry)
+{
+	for (size_t i = 0; i < entry->sections.num; i++) {
+		ucirclebuf_free(&entry->sections.array[i].cpu);
+		ucirclebuf_free(&entry->sections.array[i].gpu);
+	}
+	da_free(entry->sections);
+}
+
 static void entry_destroy(struct profiler_entry *entry)
 {
+	entry_free_sections(entry);
 	ucirclebuf_free(&entry->tick);
 	ucirclebuf_free(&entry->render_cpu);
 	ucirclebuf_free(&entry->render_gpu);
@@ -217,6 +271,9 @@ static void profiler_shutdown(void)
 	}
 	pthread_rwlock_unlock(&hm_rwlock);
 
+	da_free(open_sections);
+	da_free(section_map);
+
 	reset_gpu_timers();
 }
 
@@ -280,6 +337,88 @@ static inline bool is_async_video_source(const struct obs_source *source)
 	return (source->info.output_flags & OBS_SOURCE_ASYNC_VIDEO) == OBS_SOURCE_ASYNC_VIDEO;
 }
 
+static size_t find_section_entry(struct profiler_entry *ent, const char *name, size_t parent)
+{
+	for (size_t i = 0; i < ent->sections.num; i++) {
+		struct section_entry *sec = &ent->sections.array[i];
+		if (sec->parent == parent && strcmp(sec->name, name) == 0)
+			return i;
+	}
+
+	struct section_entry *sec = da_push_back_new(ent->sections);
+	strcpy(sec->name, name);
+	sec->parent = parent;
+	sec->unseen = 1;
+	ucirclebuf_init(&sec->cpu, profiler_samples);
+	ucirclebuf_init(&sec->gpu, profiler_samples);
+	return ent->sections.num - 1;
+}
+
+static void collect_sections(struct profiler_entry *ent, struct frame_sample *smp, bool gpu_valid, uint64_t freq)
+{
+	uint64_t ticks = 0;
+
+	for (size_t i = 0; i < ent->sections.num; i++)
+		ent->sections.array[i].unseen++;
+
+	/* sections of a frame reference their parent by index in the frame,
+	 * which always comes before them */
+	da_resize(section_map, smp->sections.num);
+
+	for (size_t i = 0; i < smp->sections.num; i++) {
+		struct section_sample *sec = &smp->sections.array[i];
+		const size_t parent = sec->parent == SECTION_ROOT ? SECTION_ROOT : section_map.array[sec->parent];
+		const size_t idx = find_section_entry(ent, sec->name, parent);
+		struct section_entry *sec_ent = &ent->sections.array[idx];
+
+		section_map.array[i] = idx;
+
+		/* A section rendered more than once in a frame is summed up,
+		 * the value for the frame is pushed on first occurrence and
+		 * added to afterwards. */
+		const bool first = sec_ent->unseen != 0;
+		uint64_t cpu = sec->done ? sec->cpu : 0;
+		uint64_t gpu = 0;
+
+		if (sec->timer) {
+			if (gpu_valid && sec->done && gs_timer_get_data(sec->timer, &ticks))
+				gpu = util_mul_div64(ticks, 1000000000ULL, freq);
+			gs_timer_destroy(sec->timer);
+		}
+
+		if (first) {
+			ucirclebuf_push(&sec_ent->cpu, cpu);
+			if (gpu_valid)
+				ucirclebuf_push(&sec_ent->gpu, gpu);
+		} else {
+			sec_ent->cpu.array[sec_ent->cpu.idx - 1] += cpu;
+			if (gpu_valid)
+				sec_ent->gpu.array[sec_ent->gpu.idx - 1] += gpu;
+		}
+
+		sec_ent->unseen = 0;
+	}
+
+	da_clear(smp->sections);
+
+	/* Sections that have not been rendered for the whole sampled timeframe
+	 * (removed or renamed filters) are dropped by rebuilding the tree */
+	for (size_t i = 0; i < ent->sections.num; i++) {
+		struct section_entry *sec = &ent->sections.array[i];
+
+		if (sec->unseen >= profiler_samples) {
+			entry_free_sections(ent);
+			break;
+		}
+
+		if (sec->unseen) {
+			ucirclebuf_push(&sec->cpu, 0);
+			if (gpu_valid)
+				ucirclebuf_push(&sec->gpu, 0);
+		}
+	}
+}
+
 static const char *source_profiler_frame_collect_name = "source_profiler_frame_collect";
 void source_profiler_frame_collect(void)
 {
@@ -369,6 +508,9 @@ void source_profiler_frame_collect(void)
 			ucirclebuf_push(&ent->render_gpu_sum, 0);
 		}
 
+		if (smp->sections.num || ent->sections.num)
+			collect_sections(ent, smp, gpu_ready && !gpu_disjoint, freq);
+
 		const obs_source_t *src = *(const obs_source_t **)smps->hh.key;
 		if (is_async_video_source(src)) {
 			uint64_t ts = obs_source_get_last_async_ts(src);
@@ -383,6 +525,10 @@ void source_profiler_frame_collect(void)
 	if (gpu_enabled && gpu_ready)
 		gs_leave_context();
 
+	/* Everything has been rendered at this point, sections left open are
+	 * from filters that began processing but never ended it */
+	da_clear(open_sections);
+
 	/* Apply updated states for next frame */
 	if (!enable_next) {
 		enabled = gpu_enabled = false;
@@ -478,6 +624,68 @@ void source_profiler_source_render_end(obs_source_t *source, uint64_t start, gs_
 	}
 }
 
+void source_profiler_section_begin(obs_source_t *source, const char *format, ...)
+{
+	if (!enabled)
+		return;
+
+	struct open_section *open = da_push_back_new(open_sections);
+	open->source = source;
+
+	struct source_samples *smps;
+	HASH_FIND_PTR(hm_samples, &source, smps);
+	if (!smps)
+		return;
+
+	struct frame_sample *smp = smps->frames[smps->frame_idx];
+	struct section_sample *sec = da_push_back_new(smp->sections);
+	va_list args;
+
+	va_start(args, format);
+	vsnprintf(sec->name, sizeof(sec->name), format, args);
+	va_end(args);
+
+	sec->parent = SECTION_ROOT;
+	for (size_t i = open_sections.num - 1; i > 0; i--) {
+		const struct open_section *outer = &open_sections.array[i - 1];
+		if (outer->source == source && outer->frame) {
+			sec->parent = outer->idx;
+			break;
+		}
+	}
+
+	open->frame = smp;
+	open->idx = smp->sections.num - 1;
+
+	if (gpu_enabled) {
+		sec->timer = gs_timer_create();
+		gs_timer_begin(sec->timer);
+	}
+
+	sec->cpu = os_gettime_ns();
+}
+
+void source_profiler_section_end(obs_source_t *source)
+{
+	if (!enabled || !open_sections.num)
+		return;
+
+	struct open_section *open = da_end(open_sections);
+	if (open->source != source)
+		return;
+
+	if (open->frame) {
+		struct section_sample *sec = &open->frame->sections.array[open->idx];
+
+		sec->cpu = os_gettime_ns() - sec->cpu;
+		if (sec->timer)
+			gs_timer_end(sec->timer);
+		sec->done = true;
+	}
+
+	da_pop_back(open_sections);
+}
+
 static void task_delete_source(void *key)
 {
 	struct source_samples *smp;
@@ -628,3 +836,67 @@ profiler_result_t *source_profiler_get_result(obs_source_t *source)
 	}
 	return ret;
 }
+
+static inline void calculate_section(const struct section_entry *sec, struct profiler_section_result *result)
+{
+	uint64_t sum = 0;
+	size_t idx;
+
+	for (idx = 0; idx < sec->cpu.num; idx++) {
+		const uint64_t delta = sec->cpu.array[idx];
+		if (delta > result->render_max)
+			result->render_max = delta;
+
+		sum += delta;
+	}
+
+	if (idx)
+		result->render_avg = sum / idx;
+
+	if (!gpu_enabled)
+		return;
+
+	sum = 0;
+	for (idx = 0; idx < sec->gpu.num; idx++) {
+		const uint64_t delta = sec->gpu.array[idx];
+		if (delta > result->render_gpu_max)
+			result->render_gpu_max = delta;
+
+		sum += delta;
+	}
+
+	if (idx)
+		result->render_gpu_avg = sum / idx;
+}
+
+profiler_section_result_t *source_profiler_get_sections(obs_source_t *source, size_t *num)
+{
+	profiler_section_result_t *ret = NULL;
+
+	if (num)
+		*num = 0;
+	if (!enabled || !num)
+		return NULL;
+
+	pthread_rwlock_rdlock(&hm_rwlock);
+
+	struct profiler_entry *ent = NULL;
+	HASH_FIND_PTR(hm_entries, &source, ent);
+	if (ent && ent->sections.num) {
+		ret = bzalloc(sizeof(profiler_section_result_t) * ent->sections.num);
+
+		for (size_t i = 0; i < ent->sections.num; i++) {
+			const struct section_entry *sec = &ent->sections.array[i];
+
+			strcpy(ret[i].name, sec->name);
+			ret[i].parent = sec->parent;
+			calculate_section(sec, &ret[i]);
+		}
+
+		*num = ent->sections.num;
+	}
+
+	pthread_rwlock_unlock(&hm_rwlock);
+
+	return ret;
+}
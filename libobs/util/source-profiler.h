@@ -51,6 +51,21 @@ typedef struct profiler_result {
 	uint64_t async_rendered_worst;
 } profiler_result_t;
 
+#define PROFILER_SECTION_NAME_LEN 64
+
+typedef struct profiler_section_result {
+	char name[PROFILER_SECTION_NAME_LEN];
+	/* Index of the enclosing section in the same array, or SIZE_MAX for
+	 * top-level sections. Parents always come before their children. */
+	size_t parent;
+
+	/* Average and max of the sum of all occurrences in a frame, in ns */
+	uint64_t render_avg;
+	uint64_t render_max;
+	uint64_t render_gpu_avg;
+	uint64_t render_gpu_max;
+} profiler_section_result_t;
+
 /* Enable/disable profiler (applied on next frame) */
 EXPORT void source_profiler_enable(bool enable);
 /* Enable/disable GPU profiling (applied on next frame) */
@@ -60,6 +75,8 @@ EXPORT void source_profiler_gpu_enable(bool enable);
 EXPORT profiler_result_t *source_profiler_get_result(obs_source_t *source);
 /* Update existing profiler results object for source */
 EXPORT bool source_profiler_fill_result(obs_source_t *source, profiler_result_t *result);
+/* Get latest per-filter/per-pass breakdown for source (must be freed by user) */
+EXPORT profiler_section_result_t *source_profiler_get_sections(obs_source_t *source, size_t *num);
 
 #ifdef __cplusplus
 }
@@ -76,6 +76,17 @@ static void color_source_render_helper(struct color_source *context, struct vec4
 	gs_technique_end(tech);
 }
 
+static bool color_source_get_sprite(void *data, struct obs_source_sprite *sprite)
+{
+	struct color_source *context = data;
+	const struct vec4 *color = &context->color_srgb;
+
+	vec4_set(&sprite->color, color->x * color->w, color->y * color->w, color->z * color->w, color->w);
+	sprite->cx = context->width;
+	sprite->cy = context->height;
+	return true;
+}
+
 static void color_source_render(void *data, gs_effect_t *effect)
 {
 	UNUSED_PARAMETER(effect);
@@ -166,7 +177,7 @@ struct obs_source_info color_source_info_v3 = {
 	.id = "color_source",
 	.version = 3,
 	.type = OBS_SOURCE_TYPE_INPUT,
-	.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_CUSTOM_DRAW | OBS_SOURCE_SRGB,
+	.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_CUSTOM_DRAW | OBS_SOURCE_SRGB | OBS_SOURCE_STATIC_VIDEO,
 	.create = color_source_create,
 	.destroy = color_source_destroy,
 	.update = color_source_update,
@@ -177,4 +188,5 @@ struct obs_source_info color_source_info_v3 = {
 	.video_render = color_source_render,
 	.get_properties = color_source_properties,
 	.icon_type = OBS_ICON_TYPE_COLOR,
+	.video_get_sprite = color_source_get_sprite,
 };
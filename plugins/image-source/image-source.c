@@ -74,6 +74,7 @@ static void image_source_load_texture(void *data)
 
 	context->update_time_elapsed = 0;
 	os_atomic_set_bool(&context->texture_loaded, true);
+	obs_source_video_changed(context->source);
 }
 
 static void image_source_unload(void *data)
@@ -85,6 +86,8 @@ static void image_source_unload(void *data)
 	obs_enter_graphics();
 	gs_image_file_ex_free(&context->image);
 	obs_leave_graphics();
+
+	obs_source_video_changed(context->source);
 }
 
 static void image_source_load(struct image_source *context)
@@ -158,6 +161,7 @@ static void restart_gif(void *data)
 		gs_image_file_ex_update_texture(&context->image);
 		obs_leave_graphics();
 
+		obs_source_video_changed(context->source);
 		context->restart_gif = false;
 	}
 }
@@ -228,6 +232,23 @@ static void image_source_render(void *data, gs_effect_t *effect)
 	gs_enable_framebuffer_srgb(previous);
 }
 
+static bool image_source_get_sprite(void *data, struct obs_source_sprite *sprite)
+{
+	struct image_source *context = data;
+	if (!os_atomic_load_bool(&context->texture_loaded))
+		return false;
+
+	gs_image_file_ex_t *const image = &context->image;
+	if (!image->texture)
+		return false;
+
+	sprite->texture = image->texture;
+	vec4_set(&sprite->color, 1.0f, 1.0f, 1.0f, 1.0f);
+	sprite->cx = image->cx;
+	sprite->cy = image->cy;
+	return true;
+}
+
 static void image_source_tick(void *data, float seconds)
 {
 	struct image_source *context = data;
@@ -281,6 +302,8 @@ static void image_source_tick(void *data, float seconds)
 			obs_enter_graphics();
 			gs_image_file_ex_update_texture(&context->image);
 			obs_leave_graphics();
+
+			obs_source_video_changed(context->source);
 		}
 	}
 
@@ -368,7 +391,7 @@ static enum gs_color_space image_source_get_color_space(void *data, size_t count
 static struct obs_source_info image_source_info = {
 	.id = "image_source",
 	.type = OBS_SOURCE_TYPE_INPUT,
-	.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_SRGB,
+	.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_SRGB | OBS_SOURCE_STATIC_VIDEO,
 	.get_name = image_source_get_name,
 	.create = image_source_create,
 	.destroy = image_source_destroy,
@@ -385,6 +408,7 @@ static struct obs_source_info image_source_info = {
 	.icon_type = OBS_ICON_TYPE_IMAGE,
 	.activate = image_source_activate,
 	.video_get_color_space = image_source_get_color_space,
+	.video_get_sprite = image_source_get_sprite,
 };
 
 OBS_DECLARE_MODULE()
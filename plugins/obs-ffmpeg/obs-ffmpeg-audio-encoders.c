@@ -476,6 +476,7 @@ struct obs_encoder_info aac_encoder_info = {
 	.get_extra_data = enc_extra_data,
 	.get_audio_info = enc_audio_info,
 	.get_priming_samples = enc_initial_padding,
+	.caps = OBS_ENCODER_CAP_THREADED,
 };
 
 struct obs_encoder_info opus_encoder_info = {
@@ -492,6 +493,7 @@ struct obs_encoder_info opus_encoder_info = {
 	.get_extra_data = enc_extra_data,
 	.get_audio_info = enc_audio_info,
 	.get_priming_samples = enc_initial_padding,
+	.caps = OBS_ENCODER_CAP_THREADED,
 };
 
 struct obs_encoder_info pcm_encoder_info = {
@@ -507,6 +509,7 @@ struct obs_encoder_info pcm_encoder_info = {
 	.get_properties = enc_properties,
 	.get_extra_data = enc_extra_data,
 	.get_audio_info = enc_audio_info,
+	.caps = OBS_ENCODER_CAP_THREADED,
 };
 
 struct obs_encoder_info pcm24_encoder_info = {
@@ -522,6 +525,7 @@ struct obs_encoder_info pcm24_encoder_info = {
 	.get_properties = enc_properties,
 	.get_extra_data = enc_extra_data,
 	.get_audio_info = enc_audio_info,
+	.caps = OBS_ENCODER_CAP_THREADED,
 };
 
 struct obs_encoder_info pcm32_encoder_info = {
@@ -537,6 +541,7 @@ struct obs_encoder_info pcm32_encoder_info = {
 	.get_properties = enc_properties,
 	.get_extra_data = enc_extra_data,
 	.get_audio_info = enc_audio_info_float,
+	.caps = OBS_ENCODER_CAP_THREADED,
 };
 
 struct obs_encoder_info alac_encoder_info = {
@@ -552,6 +557,7 @@ struct obs_encoder_info alac_encoder_info = {
 	.get_properties = enc_properties,
 	.get_extra_data = enc_extra_data,
 	.get_audio_info = enc_audio_info,
+	.caps = OBS_ENCODER_CAP_THREADED,
 };
 
 struct obs_encoder_info flac_encoder_info = {
@@ -567,4 +573,5 @@ struct obs_encoder_info flac_encoder_info = {
 	.get_properties = enc_properties,
 	.get_extra_data = enc_extra_data,
 	.get_audio_info = enc_audio_info,
+	.caps = OBS_ENCODER_CAP_THREADED,
 };
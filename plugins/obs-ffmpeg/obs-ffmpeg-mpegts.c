@@ -1249,12 +1249,28 @@ void mpegts_write_packet(struct ffmpeg_output *stream, struct encoder_packet *en
 
 	packet = av_packet_alloc();
 
-	packet->data = av_memdup(encpacket->data, (int)encpacket->size);
+	/* Caption/metrics units are inserted here, the packet data gets copied
+	 * either way */
+	const uint8_t *prefix;
+	size_t prefix_size;
+	obs_encoder_packet_get_prefix(encpacket, &prefix, &prefix_size);
+
+	size_t size = encpacket->size + prefix_size;
+	packet->data = av_malloc(size);
 	if (packet->data == NULL) {
 		error("Couldn't allocate packet data");
 		goto fail;
 	}
-	packet->size = (int)encpacket->size;
+	if (prefix_size) {
+		size_t offset = obs_encoder_packet_prefix_offset(encpacket);
+		memcpy(packet->data, encpacket->data, offset);
+		memcpy(packet->data + offset, prefix, prefix_size);
+		memcpy(packet->data + offset + prefix_size, encpacket->data + offset,
+		       encpacket->size - offset);
+	} else {
+		memcpy(packet->data, encpacket->data, encpacket->size);
+	}
+	packet->size = (int)size;
 	packet->stream_index = avstream->id;
 	packet->pts = rescale_ts2(avstream, codec_time_base, encpacket->pts);
 	packet->dts = rescale_ts2(avstream, codec_time_base, encpacket->dts);
@@ -1377,7 +1393,8 @@ static obs_properties_t *ffmpeg_mpegts_properties(void *unused)
 
 struct obs_output_info ffmpeg_mpegts_muxer = {
 	.id = "ffmpeg_mpegts_muxer",
-	.flags = OBS_OUTPUT_AV | OBS_OUTPUT_ENCODED | OBS_OUTPUT_MULTI_TRACK | OBS_OUTPUT_SERVICE,
+	.flags = OBS_OUTPUT_AV | OBS_OUTPUT_ENCODED | OBS_OUTPUT_MULTI_TRACK | OBS_OUTPUT_SERVICE |
+		 OBS_OUTPUT_PACKET_PREFIX,
 	.protocols = "SRT;RIST",
 #ifdef ENABLE_HEVC
 	.encoded_video_codecs = "h264;hevc",
@@ -247,4 +247,5 @@ struct obs_encoder_info openh264_encoder_info = {
 	.get_properties = openh264_properties,
 	.get_extra_data = openh264_extra_data,
 	.get_video_info = openh264_video_info,
+	.caps = OBS_ENCODER_CAP_THREADED,
 };
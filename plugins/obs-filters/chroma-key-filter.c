@@ -239,7 +239,7 @@ static void *chroma_key_create_v1(obs_data_t *settings, obs_source_t *context)
 
 	obs_enter_graphics();
 
-	filter->effect = gs_effect_create_from_file(effect_path, NULL);
+	filter->effect = gs_effect_create_from_file_lazy(effect_path, NULL);
 	if (filter->effect) {
 		filter->color_param = gs_effect_get_param_by_name(filter->effect, "color");
 		filter->contrast_param = gs_effect_get_param_by_name(filter->effect, "contrast");
@@ -274,7 +274,7 @@ static void *chroma_key_create_v2(obs_data_t *settings, obs_source_t *context)
 
 	obs_enter_graphics();
 
-	filter->effect = gs_effect_create_from_file(effect_path, NULL);
+	filter->effect = gs_effect_create_from_file_lazy(effect_path, NULL);
 	if (filter->effect) {
 		filter->opacity_param = gs_effect_get_param_by_name(filter->effect, "opacity");
 		filter->contrast_param = gs_effect_get_param_by_name(filter->effect, "contrast");
@@ -489,7 +489,7 @@ static enum gs_color_space chroma_key_get_color_space(void *data, size_t count,
 struct obs_source_info chroma_key_filter = {
 	.id = "chroma_key_filter",
 	.type = OBS_SOURCE_TYPE_FILTER,
-	.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_CAP_OBSOLETE,
+	.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_CAP_OBSOLETE | OBS_SOURCE_STATIC_VIDEO,
 	.get_name = chroma_key_name,
 	.create = chroma_key_create_v1,
 	.destroy = chroma_key_destroy_v1,
@@ -503,7 +503,7 @@ struct obs_source_info chroma_key_filter_v2 = {
 	.id = "chroma_key_filter",
 	.version = 2,
 	.type = OBS_SOURCE_TYPE_FILTER,
-	.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_SRGB,
+	.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_SRGB | OBS_SOURCE_STATIC_VIDEO,
 	.get_name = chroma_key_name,
 	.create = chroma_key_create_v2,
 	.destroy = chroma_key_destroy_v2,
@@ -455,7 +455,7 @@ static void *color_correction_filter_create_v1(obs_data_t *settings, obs_source_
 	obs_enter_graphics();
 
 	/* Load the shader on the GPU. */
-	filter->effect = gs_effect_create_from_file(effect_path, NULL);
+	filter->effect = gs_effect_create_from_file_lazy(effect_path, NULL);
 
 	/* If the filter is active pass the parameters to the filter. */
 	if (filter->effect) {
@@ -513,7 +513,7 @@ static void *color_correction_filter_create_v2(obs_data_t *settings, obs_source_
 	obs_enter_graphics();
 
 	/* Load the shader on the GPU. */
-	filter->effect = gs_effect_create_from_file(effect_path, NULL);
+	filter->effect = gs_effect_create_from_file_lazy(effect_path, NULL);
 
 	/* If the filter is active pass the parameters to the filter. */
 	if (filter->effect) {
@@ -600,6 +600,44 @@ static void color_correction_filter_render_v2(void *data, gs_effect_t *effect)
 	}
 }
 
+/*
+ * Same as PSColorFilterRGBA, for drawing the filter in a single pass together
+ * with adjacent filters.  libobs takes care of the alpha (un)premultiplying.
+ */
+static const char *color_correction_fused_shader = "\
+uniform float $gamma;\n\
+uniform float4x4 $color_matrix;\n\
+\n\
+float4 $ProcessPixel(float4 rgba)\n\
+{\n\
+	rgba.rgb = pow(rgba.rgb, float3($gamma, $gamma, $gamma));\n\
+	return mul($color_matrix, rgba);\n\
+}\n";
+
+static const char *color_correction_filter_get_fused_shader(void *data)
+{
+	struct color_correction_filter_data_v2 *filter = data;
+
+	const enum gs_color_space preferred_spaces[] = {
+		GS_CS_SRGB,
+		GS_CS_SRGB_16F,
+		GS_CS_709_EXTENDED,
+	};
+
+	/* skipped for HDR, see color_correction_filter_render_v2 */
+	const enum gs_color_space source_space = obs_source_get_color_space(
+		obs_filter_get_target(filter->context), OBS_COUNTOF(preferred_spaces), preferred_spaces);
+	return (source_space == GS_CS_709_EXTENDED) ? NULL : color_correction_fused_shader;
+}
+
+static void color_correction_filter_set_fused_params(void *data, gs_effect_t *effect, const char *prefix)
+{
+	struct color_correction_filter_data_v2 *filter = data;
+
+	gs_effect_set_float(obs_filter_get_fused_param(effect, prefix, "gamma"), filter->gamma);
+	gs_effect_set_matrix4(obs_filter_get_fused_param(effect, prefix, "color_matrix"), &filter->final_matrix);
+}
+
 /*
  * This function sets the interface. the types (add_*_Slider), the type of
  * data collected (int), the internal name, user-facing name, minimum,
@@ -707,7 +745,7 @@ static enum gs_color_space color_correction_filter_get_color_space(void *data, s
 struct obs_source_info color_filter = {
 	.id = "color_filter",
 	.type = OBS_SOURCE_TYPE_FILTER,
-	.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_CAP_OBSOLETE,
+	.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_CAP_OBSOLETE | OBS_SOURCE_STATIC_VIDEO,
 	.get_name = color_correction_filter_name,
 	.create = color_correction_filter_create_v1,
 	.destroy = color_correction_filter_destroy_v1,
@@ -721,7 +759,7 @@ struct obs_source_info color_filter_v2 = {
 	.id = "color_filter",
 	.version = 2,
 	.type = OBS_SOURCE_TYPE_FILTER,
-	.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_SRGB,
+	.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_SRGB | OBS_SOURCE_STATIC_VIDEO,
 	.get_name = color_correction_filter_name,
 	.create = color_correction_filter_create_v2,
 	.destroy = color_correction_filter_destroy_v2,
@@ -730,4 +768,6 @@ struct obs_source_info color_filter_v2 = {
 	.get_properties = color_correction_filter_properties_v2,
 	.get_defaults = color_correction_filter_defaults_v2,
 	.video_get_color_space = color_correction_filter_get_color_space,
+	.video_get_fused_shader = color_correction_filter_get_fused_shader,
+	.video_set_fused_params = color_correction_filter_set_fused_params,
 };
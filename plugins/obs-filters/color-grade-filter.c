@@ -323,7 +323,7 @@ static void color_grade_filter_update(void *data, obs_data_t *settings)
 
 	char *effect_path = obs_module_file("color_grade_filter.effect");
 	gs_effect_destroy(filter->effect);
-	filter->effect = gs_effect_create_from_file(effect_path, NULL);
+	filter->effect = gs_effect_create_from_file_lazy(effect_path, NULL);
 	bfree(effect_path);
 
 	obs_leave_graphics();
@@ -496,7 +496,7 @@ static obs_missing_files_t *color_grade_filter_missing_files(void *data)
 struct obs_source_info color_grade_filter = {
 	.id = "clut_filter",
 	.type = OBS_SOURCE_TYPE_FILTER,
-	.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_SRGB,
+	.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_SRGB | OBS_SOURCE_STATIC_VIDEO,
 	.get_name = color_grade_filter_get_name,
 	.create = color_grade_filter_create,
 	.destroy = color_grade_filter_destroy,
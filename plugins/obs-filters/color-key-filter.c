@@ -212,7 +212,7 @@ static void *color_key_create_v1(obs_data_t *settings, obs_source_t *context)
 
 	obs_enter_graphics();
 
-	filter->effect = gs_effect_create_from_file(effect_path, NULL);
+	filter->effect = gs_effect_create_from_file_lazy(effect_path, NULL);
 	if (filter->effect) {
 		filter->color_param = gs_effect_get_param_by_name(filter->effect, "color");
 		filter->contrast_param = gs_effect_get_param_by_name(filter->effect, "contrast");
@@ -245,7 +245,7 @@ static void *color_key_create_v2(obs_data_t *settings, obs_source_t *context)
 
 	obs_enter_graphics();
 
-	filter->effect = gs_effect_create_from_file(effect_path, NULL);
+	filter->effect = gs_effect_create_from_file_lazy(effect_path, NULL);
 	if (filter->effect) {
 		filter->opacity_param = gs_effect_get_param_by_name(filter->effect, "opacity");
 		filter->contrast_param = gs_effect_get_param_by_name(filter->effect, "contrast");
@@ -327,6 +327,61 @@ static void color_key_render_v2(void *data, gs_effect_t *effect)
 	}
 }
 
+/* same as PSColorKeyRGBA, for drawing the filter in a single pass together
+ * with adjacent filters */
+static const char *color_key_fused_shader = "\
+uniform float $opacity;\n\
+uniform float $contrast;\n\
+uniform float $brightness;\n\
+uniform float $gamma;\n\
+uniform float4 $key_color;\n\
+uniform float $similarity;\n\
+uniform float $smoothness;\n\
+\n\
+float $GetNonlinearChannel(float u)\n\
+{\n\
+	return (u <= 0.0031308) ? (12.92 * u) : ((1.055 * pow(u, 1.0 / 2.4)) - 0.055);\n\
+}\n\
+\n\
+float4 $ProcessPixel(float4 rgba)\n\
+{\n\
+	float3 nonlinear = float3($GetNonlinearChannel(rgba.r), $GetNonlinearChannel(rgba.g),\n\
+				  $GetNonlinearChannel(rgba.b));\n\
+	float colorDist = distance($key_color.rgb, nonlinear);\n\
+	rgba.a *= $opacity;\n\
+	rgba.a *= saturate(max(colorDist - $similarity, 0.0) / $smoothness);\n\
+	return float4(pow(rgba.rgb, float3($gamma, $gamma, $gamma)) * $contrast + $brightness, rgba.a);\n\
+}\n";
+
+static const char *color_key_get_fused_shader(void *data)
+{
+	struct color_key_filter_data_v2 *filter = data;
+
+	const enum gs_color_space preferred_spaces[] = {
+		GS_CS_SRGB,
+		GS_CS_SRGB_16F,
+		GS_CS_709_EXTENDED,
+	};
+
+	/* skipped for HDR, see color_key_render_v2 */
+	const enum gs_color_space source_space = obs_source_get_color_space(
+		obs_filter_get_target(filter->context), OBS_COUNTOF(preferred_spaces), preferred_spaces);
+	return (source_space == GS_CS_709_EXTENDED) ? NULL : color_key_fused_shader;
+}
+
+static void color_key_set_fused_params(void *data, gs_effect_t *effect, const char *prefix)
+{
+	struct color_key_filter_data_v2 *filter = data;
+
+	gs_effect_set_float(obs_filter_get_fused_param(effect, prefix, "opacity"), filter->opacity);
+	gs_effect_set_float(obs_filter_get_fused_param(effect, prefix, "contrast"), filter->contrast);
+	gs_effect_set_float(obs_filter_get_fused_param(effect, prefix, "brightness"), filter->brightness);
+	gs_effect_set_float(obs_filter_get_fused_param(effect, prefix, "gamma"), filter->gamma);
+	gs_effect_set_vec4(obs_filter_get_fused_param(effect, prefix, "key_color"), &filter->key_color);
+	gs_effect_set_float(obs_filter_get_fused_param(effect, prefix, "similarity"), filter->similarity);
+	gs_effect_set_float(obs_filter_get_fused_param(effect, prefix, "smoothness"), filter->smoothness);
+}
+
 static bool key_type_changed(obs_properties_t *props, obs_property_t *p, obs_data_t *settings)
 {
 	const char *type = obs_data_get_string(settings, SETTING_COLOR_TYPE);
@@ -440,7 +495,7 @@ static enum gs_color_space color_key_get_color_space(void *data, size_t count,
 struct obs_source_info color_key_filter = {
 	.id = "color_key_filter",
 	.type = OBS_SOURCE_TYPE_FILTER,
-	.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_CAP_OBSOLETE,
+	.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_CAP_OBSOLETE | OBS_SOURCE_STATIC_VIDEO,
 	.get_name = color_key_name,
 	.create = color_key_create_v1,
 	.destroy = color_key_destroy_v1,
@@ -454,7 +509,7 @@ struct obs_source_info color_key_filter_v2 = {
 	.id = "color_key_filter",
 	.version = 2,
 	.type = OBS_SOURCE_TYPE_FILTER,
-	.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_SRGB,
+	.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_SRGB | OBS_SOURCE_STATIC_VIDEO,
 	.get_name = color_key_name,
 	.create = color_key_create_v2,
 	.destroy = color_key_destroy_v2,
@@ -463,4 +518,6 @@ struct obs_source_info color_key_filter_v2 = {
 	.get_properties = color_key_properties_v2,
 	.get_defaults = color_key_defaults_v2,
 	.video_get_color_space = color_key_get_color_space,
+	.video_get_fused_shader = color_key_get_fused_shader,
+	.video_set_fused_params = color_key_set_fused_params,
 };
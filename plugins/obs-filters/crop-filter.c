@@ -37,7 +37,7 @@ static void *crop_filter_create(obs_data_t *settings, obs_source_t *context)
 	filter->context = context;
 
 	obs_enter_graphics();
-	filter->effect = gs_effect_create_from_file(effect_path, NULL);
+	filter->effect = gs_effect_create_from_file_lazy(effect_path, NULL);
 	obs_leave_graphics();
 
 	bfree(effect_path);
@@ -285,7 +285,7 @@ static enum gs_color_space crop_filter_get_color_space(void *data, size_t count,
 struct obs_source_info crop_filter = {
 	.id = "crop_filter",
 	.type = OBS_SOURCE_TYPE_FILTER,
-	.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_SRGB,
+	.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_SRGB | OBS_SOURCE_STATIC_VIDEO,
 	.get_name = crop_filter_get_name,
 	.create = crop_filter_create,
 	.destroy = crop_filter_destroy,
@@ -1,13 +1,24 @@
 #include <obs-module.h>
 #include <util/deque.h>
+#include <util/dstr.h>
 #include <util/util_uint64.h>
 
 #define S_DELAY_MS "delay_ms"
+#define S_COMPRESS "compress"
+#define S_MEMORY_INFO "memory_info"
 #define T_DELAY_MS obs_module_text("DelayMs")
+#define T_COMPRESS obs_module_text("GPUDelay.Compress")
+#define T_MEMORY_INFO obs_module_text("GPUDelay.MemoryInfo")
 
+/* in compressed mode render holds the luma plane and render_uv the
+ * subsampled chroma plane.  8-bit SDR frames are stored as NV12, 16-bit
+ * float SDR frames as 16-bit planes with the sRGB curve applied, and HDR
+ * frames as 16-bit PQ planes */
 struct frame {
 	gs_texrender_t *render;
+	gs_texrender_t *render_uv;
 	enum gs_color_space space;
+	float sdr_white_level;
 	uint64_t ts;
 };
 
@@ -20,6 +31,12 @@ struct gpu_delay_filter_data {
 	uint32_t cy;
 	bool target_valid;
 	bool processed_frame;
+
+	bool compress;
+	bool wide; /* 16 bits per channel, any space but GS_CS_SRGB */
+	gs_effect_t *effect;
+	gs_texrender_t *scratch;
+	bool scratch_valid;
 };
 
 static const char *gpu_delay_filter_get_name(void *unused)
@@ -35,8 +52,12 @@ static void free_textures(struct gpu_delay_filter_data *f)
 		struct frame frame;
 		deque_pop_front(&f->frames, &frame, sizeof(frame));
 		gs_texrender_destroy(frame.render);
+		gs_texrender_destroy(frame.render_uv);
 	}
 	deque_free(&f->frames);
+	gs_texrender_destroy(f->scratch);
+	f->scratch = NULL;
+	f->scratch_valid = false;
 	obs_leave_graphics();
 }
 
@@ -65,6 +86,7 @@ static void update_interval(struct gpu_delay_filter_data *f, uint64_t new_interv
 		for (size_t i = prev_num; i < num; i++) {
 			struct frame *frame = deque_data(&f->frames, i * sizeof(*frame));
 			frame->render = gs_texrender_create(GS_RGBA, GS_ZS_NONE);
+			frame->render_uv = NULL;
 		}
 
 		obs_leave_graphics();
@@ -76,6 +98,7 @@ static void update_interval(struct gpu_delay_filter_data *f, uint64_t new_interv
 			struct frame frame;
 			deque_pop_front(&f->frames, &frame, sizeof(frame));
 			gs_texrender_destroy(frame.render);
+			gs_texrender_destroy(frame.render_uv);
 		}
 
 		obs_leave_graphics();
@@ -134,6 +157,7 @@ static void gpu_delay_filter_update(void *data, obs_data_t *s)
 	struct gpu_delay_filter_data *f = data;
 
 	f->delay_ns = (uint64_t)obs_data_get_int(s, S_DELAY_MS) * 1000000ULL;
+	f->compress = obs_data_get_bool(s, S_COMPRESS) && f->effect;
 
 	/* full reset */
 	f->cx = 0;
@@ -142,22 +166,58 @@ static void gpu_delay_filter_update(void *data, obs_data_t *s)
 	free_textures(f);
 }
 
+static uint64_t frame_memory_size(const struct gpu_delay_filter_data *f)
+{
+	const uint64_t cx = f->cx;
+	const uint64_t cy = f->cy;
+	const uint64_t uv_cx = (cx + 1) / 2;
+	const uint64_t uv_cy = (cy + 1) / 2;
+
+	if (f->compress)
+		return f->wide ? (cx * cy * 2 + uv_cx * uv_cy * 4) : (cx * cy + uv_cx * uv_cy * 2);
+
+	return cx * cy * (f->wide ? 8 : 4);
+}
+
 static obs_properties_t *gpu_delay_filter_properties(void *data)
 {
+	struct gpu_delay_filter_data *f = data;
 	obs_properties_t *props = obs_properties_create();
 
 	obs_property_t *p = obs_properties_add_int(props, S_DELAY_MS, T_DELAY_MS, 0, 500, 1);
 	obs_property_int_set_suffix(p, " ms");
 
-	UNUSED_PARAMETER(data);
+	obs_properties_add_bool(props, S_COMPRESS, T_COMPRESS);
+
+	if (f) {
+		/* the scratch texture of the compressed mode is about the
+		 * size of one uncompressed frame */
+		uint64_t size = frame_memory_size(f) * num_frames(&f->frames);
+		if (f->compress)
+			size += (uint64_t)f->cx * f->cy * (f->wide ? 8 : 4);
+
+		struct dstr info = {0};
+		dstr_printf(&info, T_MEMORY_INFO, (double)size / (1024.0 * 1024.0));
+		obs_properties_add_text(props, S_MEMORY_INFO, info.array, OBS_TEXT_INFO);
+		dstr_free(&info);
+	}
+
 	return props;
 }
 
 static void *gpu_delay_filter_create(obs_data_t *settings, obs_source_t *context)
 {
 	struct gpu_delay_filter_data *f = bzalloc(sizeof(*f));
+	char *effect_path = obs_module_file("gpu_delay.effect");
+
 	f->context = context;
 
+	obs_enter_graphics();
+	f->effect = gs_effect_create_from_file_lazy(effect_path, NULL);
+	obs_leave_graphics();
+
+	bfree(effect_path);
+
 	obs_source_update(context, settings);
 	return f;
 }
@@ -167,6 +227,11 @@ static void gpu_delay_filter_destroy(void *data)
 	struct gpu_delay_filter_data *f = data;
 
 	free_textures(f);
+
+	obs_enter_graphics();
+	gs_effect_destroy(f->effect);
+	obs_leave_graphics();
+
 	bfree(f);
 }
 
@@ -240,7 +305,11 @@ static void draw_frame(struct gpu_delay_filter_data *f)
 	const char *technique = get_tech_name_and_multiplier(current_space, frame.space, &multiplier);
 
 	gs_effect_t *effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
-	gs_texture_t *tex = gs_texrender_get_texture(frame.render);
+	gs_texture_t *tex = NULL;
+	if (!f->compress)
+		tex = gs_texrender_get_texture(frame.render);
+	else if (f->scratch_valid)
+		tex = gs_texrender_get_texture(f->scratch);
 	if (tex) {
 		const bool previous = gs_framebuffer_srgb_enabled();
 		gs_enable_framebuffer_srgb(true);
@@ -255,6 +324,141 @@ static void draw_frame(struct gpu_delay_filter_data *f)
 	}
 }
 
+static inline void check_format(gs_texrender_t **render, enum gs_color_format format)
+{
+	if (!*render || gs_texrender_get_format(*render) != format) {
+		gs_texrender_destroy(*render);
+		*render = gs_texrender_create(format, GS_ZS_NONE);
+	}
+
+	gs_texrender_reset(*render);
+}
+
+static bool render_target(struct gpu_delay_filter_data *f, obs_source_t *target, obs_source_t *parent,
+			  gs_texrender_t *render, enum gs_color_space space)
+{
+	if (!gs_texrender_begin_with_color_space(render, f->cx, f->cy, space))
+		return false;
+
+	uint32_t parent_flags = obs_source_get_output_flags(target);
+	bool custom_draw = (parent_flags & OBS_SOURCE_CUSTOM_DRAW) != 0;
+	bool async = (parent_flags & OBS_SOURCE_ASYNC) != 0;
+	struct vec4 clear_color;
+
+	vec4_zero(&clear_color);
+	gs_clear(GS_CLEAR_COLOR, &clear_color, 0.0f, 0);
+	gs_ortho(0.0f, (float)f->cx, 0.0f, (float)f->cy, -100.0f, 100.0f);
+
+	if (target == parent && !custom_draw && !async)
+		obs_source_default_render(target);
+	else
+		obs_source_video_render(target);
+
+	gs_texrender_end(render);
+	return true;
+}
+
+static void draw_plane(gs_effect_t *effect, const char *technique, gs_texrender_t *render, uint32_t cx, uint32_t cy)
+{
+	if (gs_texrender_begin(render, cx, cy)) {
+		gs_ortho(0.0f, (float)cx, 0.0f, (float)cy, -100.0f, 100.0f);
+
+		while (gs_effect_loop(effect, technique))
+			gs_draw_sprite(NULL, 0, cx, cy);
+
+		gs_texrender_end(render);
+	}
+}
+
+struct plane_techniques {
+	const char *convert_y;
+	const char *convert_uv;
+	const char *expand;
+	bool wide;
+};
+
+/* 8-bit targets are sampled with the sRGB curve still applied and fit into
+ * 8-bit planes.  16-bit float targets are linear, quantizing them to 8 bits
+ * would band the shadows, so they get the sRGB curve applied and 16-bit
+ * planes. */
+static const struct plane_techniques *get_plane_techniques(enum gs_color_space space)
+{
+	static const struct plane_techniques srgb = {"ConvertY", "ConvertUV", "Expand", false};
+	static const struct plane_techniques linear = {"ConvertYLinear", "ConvertUVLinear", "ExpandLinear", true};
+	static const struct plane_techniques pq = {"ConvertYPQ", "ConvertUVPQ", "ExpandPQ", true};
+
+	switch (space) {
+	case GS_CS_SRGB_16F:
+		return &linear;
+	case GS_CS_709_EXTENDED:
+		return &pq;
+	default:
+		return &srgb;
+	}
+}
+
+/* scratch holds the uncompressed target, split it into the planes of the
+ * frame */
+static bool compress_frame(struct gpu_delay_filter_data *f, struct frame *frame)
+{
+	const struct plane_techniques *techs = get_plane_techniques(frame->space);
+	gs_texture_t *tex = gs_texrender_get_texture(f->scratch);
+	if (!tex)
+		return false;
+
+	check_format(&frame->render, techs->wide ? GS_R16 : GS_R8);
+	check_format(&frame->render_uv, techs->wide ? GS_RG16 : GS_R8G8);
+
+	/* sampled as stored, the techniques deal with the transfer curve */
+	const bool previous = gs_framebuffer_srgb_enabled();
+	gs_enable_framebuffer_srgb(false);
+
+	gs_effect_set_texture(gs_effect_get_param_by_name(f->effect, "image"), tex);
+	gs_effect_set_float(gs_effect_get_param_by_name(f->effect, "pq_scale"), frame->sdr_white_level / 10000.0f);
+
+	draw_plane(f->effect, techs->convert_y, frame->render, f->cx, f->cy);
+	draw_plane(f->effect, techs->convert_uv, frame->render_uv, (f->cx + 1) / 2, (f->cy + 1) / 2);
+
+	gs_enable_framebuffer_srgb(previous);
+	return true;
+}
+
+/* expands the oldest frame into scratch, in the same format the target was
+ * captured in */
+static bool expand_frame(struct gpu_delay_filter_data *f)
+{
+	struct frame frame;
+	deque_peek_front(&f->frames, &frame, sizeof(frame));
+
+	gs_texture_t *tex_y = frame.render ? gs_texrender_get_texture(frame.render) : NULL;
+	gs_texture_t *tex_uv = frame.render_uv ? gs_texrender_get_texture(frame.render_uv) : NULL;
+	if (!tex_y || !tex_uv)
+		return false;
+
+	const struct plane_techniques *techs = get_plane_techniques(frame.space);
+	check_format(&f->scratch, gs_get_format_from_space(frame.space));
+
+	if (!gs_texrender_begin_with_color_space(f->scratch, f->cx, f->cy, frame.space))
+		return false;
+
+	const bool previous = gs_framebuffer_srgb_enabled();
+	gs_enable_framebuffer_srgb(false);
+
+	gs_ortho(0.0f, (float)f->cx, 0.0f, (float)f->cy, -100.0f, 100.0f);
+
+	gs_effect_set_texture(gs_effect_get_param_by_name(f->effect, "image"), tex_y);
+	gs_effect_set_texture(gs_effect_get_param_by_name(f->effect, "image_uv"), tex_uv);
+	gs_effect_set_float(gs_effect_get_param_by_name(f->effect, "pq_scale"), frame.sdr_white_level / 10000.0f);
+
+	while (gs_effect_loop(f->effect, techs->expand))
+		gs_draw_sprite(NULL, 0, f->cx, f->cy);
+
+	gs_enable_framebuffer_srgb(previous);
+
+	gs_texrender_end(f->scratch);
+	return true;
+}
+
 static void gpu_delay_filter_render(void *data, gs_effect_t *effect)
 {
 	struct gpu_delay_filter_data *f = data;
@@ -282,39 +486,32 @@ static void gpu_delay_filter_render(void *data, gs_effect_t *effect)
 	const enum gs_color_space space =
 		obs_source_get_color_space(target, OBS_COUNTOF(preferred_spaces), preferred_spaces);
 	const enum gs_color_format format = gs_get_format_from_space(space);
-	if (gs_texrender_get_format(frame.render) != format) {
-		gs_texrender_destroy(frame.render);
-		frame.render = gs_texrender_create(format, GS_ZS_NONE);
-	}
 
-	gs_texrender_reset(frame.render);
+	f->wide = space != GS_CS_SRGB;
 
 	gs_blend_state_push();
 	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
 
-	if (gs_texrender_begin_with_color_space(frame.render, f->cx, f->cy, space)) {
-		uint32_t parent_flags = obs_source_get_output_flags(target);
-		bool custom_draw = (parent_flags & OBS_SOURCE_CUSTOM_DRAW) != 0;
-		bool async = (parent_flags & OBS_SOURCE_ASYNC) != 0;
-		struct vec4 clear_color;
-
-		vec4_zero(&clear_color);
-		gs_clear(GS_CLEAR_COLOR, &clear_color, 0.0f, 0);
-		gs_ortho(0.0f, (float)f->cx, 0.0f, (float)f->cy, -100.0f, 100.0f);
-
-		if (target == parent && !custom_draw && !async)
-			obs_source_default_render(target);
-		else
-			obs_source_video_render(target);
+	if (f->compress) {
+		check_format(&f->scratch, format);
+		if (render_target(f, target, parent, f->scratch, space)) {
+			frame.space = space;
+			frame.sdr_white_level = obs_get_video_sdr_white_level();
+			compress_frame(f, &frame);
+		}
 
-		gs_texrender_end(frame.render);
+		deque_push_back(&f->frames, &frame, sizeof(frame));
+		f->scratch_valid = expand_frame(f);
+	} else {
+		check_format(&frame.render, format);
+		if (render_target(f, target, parent, frame.render, space))
+			frame.space = space;
 
-		frame.space = space;
+		deque_push_back(&f->frames, &frame, sizeof(frame));
 	}
 
 	gs_blend_state_pop();
 
-	deque_push_back(&f->frames, &frame, sizeof(frame));
 	draw_frame(f);
 	f->processed_frame = true;
 
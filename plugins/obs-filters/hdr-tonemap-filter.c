@@ -36,7 +36,7 @@ static void *hdr_tonemap_filter_create(obs_data_t *settings, obs_source_t *conte
 	filter->context = context;
 
 	obs_enter_graphics();
-	filter->effect = gs_effect_create_from_file(effect_path, NULL);
+	filter->effect = gs_effect_create_from_file_lazy(effect_path, NULL);
 	obs_leave_graphics();
 
 	bfree(effect_path);
@@ -75,7 +75,7 @@ static void *luma_key_create_internal(obs_data_t *settings, obs_source_t *contex
 
 	obs_enter_graphics();
 
-	filter->effect = gs_effect_create_from_file(effect_path, NULL);
+	filter->effect = gs_effect_create_from_file_lazy(effect_path, NULL);
 	if (filter->effect) {
 		filter->luma_max_param = gs_effect_get_param_by_name(filter->effect, "lumaMax");
 		filter->luma_min_param = gs_effect_get_param_by_name(filter->effect, "lumaMin");
@@ -179,6 +179,49 @@ static void luma_key_defaults(obs_data_t *settings)
 	obs_data_set_default_double(settings, SETTING_LUMA_MIN_SMOOTH, 0.0);
 }
 
+/* same as PSALumaKeyRGBA, for drawing the filter in a single pass together
+ * with adjacent filters */
+static const char *luma_key_fused_shader = "\
+uniform float $lumaMax;\n\
+uniform float $lumaMin;\n\
+uniform float $lumaMaxSmooth;\n\
+uniform float $lumaMinSmooth;\n\
+\n\
+float4 $ProcessPixel(float4 rgba)\n\
+{\n\
+	float luminance = dot(rgba.rgb, float3(0.2126, 0.7152, 0.0722));\n\
+	float clo = smoothstep($lumaMin, $lumaMin + $lumaMinSmooth, luminance);\n\
+	float chi = 1. - smoothstep($lumaMax - $lumaMaxSmooth, $lumaMax, luminance);\n\
+	rgba.a *= clo * chi;\n\
+	return rgba;\n\
+}\n";
+
+static const char *luma_key_get_fused_shader(void *data)
+{
+	struct luma_key_filter_data *filter = data;
+
+	const enum gs_color_space preferred_spaces[] = {
+		GS_CS_SRGB,
+		GS_CS_SRGB_16F,
+		GS_CS_709_EXTENDED,
+	};
+
+	/* skipped for HDR, see luma_key_render_internal */
+	const enum gs_color_space source_space = obs_source_get_color_space(
+		obs_filter_get_target(filter->context), OBS_COUNTOF(preferred_spaces), preferred_spaces);
+	return (source_space == GS_CS_709_EXTENDED) ? NULL : luma_key_fused_shader;
+}
+
+static void luma_key_set_fused_params(void *data, gs_effect_t *effect, const char *prefix)
+{
+	struct luma_key_filter_data *filter = data;
+
+	gs_effect_set_float(obs_filter_get_fused_param(effect, prefix, "lumaMax"), filter->luma_max);
+	gs_effect_set_float(obs_filter_get_fused_param(effect, prefix, "lumaMin"), filter->luma_min);
+	gs_effect_set_float(obs_filter_get_fused_param(effect, prefix, "lumaMaxSmooth"), filter->luma_max_smooth);
+	gs_effect_set_float(obs_filter_get_fused_param(effect, prefix, "lumaMinSmooth"), filter->luma_min_smooth);
+}
+
 static enum gs_color_space luma_key_get_color_space(void *data, size_t count,
 						    const enum gs_color_space *preferred_spaces)
 {
@@ -201,7 +244,7 @@ static enum gs_color_space luma_key_get_color_space(void *data, size_t count,
 struct obs_source_info luma_key_filter = {
 	.id = "luma_key_filter",
 	.type = OBS_SOURCE_TYPE_FILTER,
-	.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_CAP_OBSOLETE,
+	.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_CAP_OBSOLETE | OBS_SOURCE_STATIC_VIDEO,
 	.get_name = luma_key_name,
 	.create = luma_key_create_v1,
 	.destroy = luma_key_destroy,
@@ -215,7 +258,7 @@ struct obs_source_info luma_key_filter_v2 = {
 	.id = "luma_key_filter",
 	.version = 2,
 	.type = OBS_SOURCE_TYPE_FILTER,
-	.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_SRGB,
+	.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_SRGB | OBS_SOURCE_STATIC_VIDEO,
 	.get_name = luma_key_name,
 	.create = luma_key_create_v2,
 	.destroy = luma_key_destroy,
@@ -224,4 +267,6 @@ struct obs_source_info luma_key_filter_v2 = {
 	.get_properties = luma_key_properties,
 	.get_defaults = luma_key_defaults,
 	.video_get_color_space = luma_key_get_color_space,
+	.video_get_fused_shader = luma_key_get_fused_shader,
+	.video_set_fused_params = luma_key_set_fused_params,
 };
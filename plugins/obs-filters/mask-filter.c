@@ -111,7 +111,7 @@ static void mask_filter_update_internal(void *data, obs_data_t *settings, float
 
 	effect_path = obs_module_file(effect_file);
 	gs_effect_destroy(filter->effect);
-	filter->effect = gs_effect_create_from_file(effect_path, NULL);
+	filter->effect = gs_effect_create_from_file_lazy(effect_path, NULL);
 	bfree(effect_path);
 
 	obs_leave_graphics();
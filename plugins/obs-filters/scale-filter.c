@@ -48,6 +48,9 @@ struct scale_filter_data {
 	int cy_out;
 	enum obs_scale_type sampling;
 	gs_samplerstate_t *point_sampler;
+	gs_texrender_t *source_texrender;
+	gs_texrender_t *scale_texrender;
+	bool separable;
 	bool aspect_ratio_only;
 	bool target_valid;
 	bool valid;
@@ -121,6 +124,8 @@ static void scale_filter_destroy(void *data)
 
 	obs_enter_graphics();
 	gs_samplerstate_destroy(filter->point_sampler);
+	gs_texrender_destroy(filter->source_texrender);
+	gs_texrender_destroy(filter->scale_texrender);
 	obs_leave_graphics();
 	bfree(data);
 }
@@ -241,6 +246,11 @@ static void scale_filter_tick(void *data, float seconds)
 
 	filter->undistort_factor = filter->undistort ? (new_aspect / old_aspect) : 1.0;
 
+	/* bicubic/lanczos downscales use a kernel widened to the scale ratio
+	 * in two passes instead of falling back to bilinear beyond 2x */
+	filter->separable = !filter->undistort &&
+			    obs_use_separable_scale(filter->sampling, cx, cy, filter->cx_out, filter->cy_out);
+
 	filter->effect = obs_get_base_effect(type);
 	filter->image_param = gs_effect_get_param_by_name(filter->effect, "image");
 
@@ -394,6 +404,67 @@ static const char *get_tech_name_and_multiplier(const struct scale_filter_data *
 	return tech_name;
 }
 
+static void scale_filter_render_separable(struct scale_filter_data *filter, enum gs_color_space source_space,
+					  const char *technique, float multiplier)
+{
+	obs_source_t *target = obs_filter_get_target(filter->context);
+	obs_source_t *parent = obs_filter_get_parent(filter->context);
+	const enum gs_color_format format = gs_get_format_from_space(source_space);
+	const uint32_t cx = (uint32_t)filter->dimension.x;
+	const uint32_t cy = (uint32_t)filter->dimension.y;
+
+	if (!target || !parent) {
+		obs_source_skip_video_filter(filter->context);
+		return;
+	}
+
+	if (filter->source_texrender && gs_texrender_get_format(filter->source_texrender) != format) {
+		gs_texrender_destroy(filter->source_texrender);
+		filter->source_texrender = NULL;
+	}
+	if (!filter->source_texrender)
+		filter->source_texrender = gs_texrender_create(format, GS_ZS_NONE);
+
+	gs_texrender_reset(filter->source_texrender);
+
+	if (gs_texrender_begin_with_color_space(filter->source_texrender, cx, cy, source_space)) {
+		uint32_t parent_flags = obs_source_get_output_flags(target);
+		bool custom_draw = (parent_flags & OBS_SOURCE_CUSTOM_DRAW) != 0;
+		bool async = (parent_flags & OBS_SOURCE_ASYNC) != 0;
+		struct vec4 clear_color;
+
+		gs_blend_state_push();
+		gs_blend_function_separate(GS_BLEND_SRCALPHA, GS_BLEND_INVSRCALPHA, GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+
+		vec4_zero(&clear_color);
+		gs_clear(GS_CLEAR_COLOR, &clear_color, 0.0f, 0);
+		gs_ortho(0.0f, (float)cx, 0.0f, (float)cy, -100.0f, 100.0f);
+
+		if (target == parent && !custom_draw && !async)
+			obs_source_default_render(target);
+		else
+			obs_source_video_render(target);
+
+		gs_blend_state_pop();
+		gs_texrender_end(filter->source_texrender);
+	}
+
+	gs_texture_t *tex = gs_texrender_get_texture(filter->source_texrender);
+	if (!tex)
+		return;
+
+	const bool previous = gs_framebuffer_srgb_enabled();
+	gs_enable_framebuffer_srgb(true);
+	gs_blend_state_push();
+	gs_blend_function(GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+
+	obs_draw_separable_scale(&filter->scale_texrender, tex, filter->sampling, filter->cx_out, filter->cy_out,
+				 technique, multiplier);
+
+	gs_blend_state_pop();
+	gs_enable_framebuffer_srgb(previous);
+}
+
 static void scale_filter_render(void *data, gs_effect_t *effect)
 {
 	UNUSED_PARAMETER(effect);
@@ -415,6 +486,12 @@ static void scale_filter_render(void *data, gs_effect_t *effect)
 		obs_filter_get_target(filter->context), OBS_COUNTOF(preferred_spaces), preferred_spaces);
 	float multiplier;
 	const char *technique = get_tech_name_and_multiplier(filter, gs_get_color_space(), source_space, &multiplier);
+
+	if (filter->separable) {
+		scale_filter_render_separable(filter, source_space, technique, multiplier);
+		return;
+	}
+
 	const enum gs_color_format format = gs_get_format_from_space(source_space);
 	if (obs_source_process_filter_begin_with_color_space(filter->context, format, source_space,
 							     OBS_NO_DIRECT_RENDERING)) {
@@ -576,7 +653,7 @@ static enum gs_color_space scale_filter_get_color_space(void *data, size_t count
 struct obs_source_info scale_filter = {
 	.id = "scale_filter",
 	.type = OBS_SOURCE_TYPE_FILTER,
-	.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_SRGB,
+	.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_SRGB | OBS_SOURCE_STATIC_VIDEO,
 	.get_name = scale_filter_name,
 	.create = scale_filter_create,
 	.destroy = scale_filter_destroy,
@@ -32,7 +32,7 @@ static void *sdr_on_hdr_filter_create(obs_data_t *settings, obs_source_t *contex
 	filter->context = context;
 
 	obs_enter_graphics();
-	filter->effect = gs_effect_create_from_file(effect_path, NULL);
+	filter->effect = gs_effect_create_from_file_lazy(effect_path, NULL);
 	obs_leave_graphics();
 
 	bfree(effect_path);
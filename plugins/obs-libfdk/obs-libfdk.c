@@ -315,6 +315,7 @@ struct obs_encoder_info obs_libfdk_encoder = {
 	.get_extra_data = libfdk_extra_data,
 	.get_audio_info = libfdk_audio_info,
 	.get_priming_samples = libfdk_encoder_delay,
+	.caps = OBS_ENCODER_CAP_THREADED,
 };
 
 bool obs_module_load(void)
@@ -0,0 +1,692 @@
+/******************************************************************************
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "mp4-mux.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include <obs-module.h>
+#include <util/array-serializer.h>
+#include <util/darray.h>
+#include <util/deque.h>
+#include <util/dstr.h>
+#include <util/platform.h>
+#include <util/threading.h>
+#include <util/util_uint64.h>
+
+/*
+ * Low-Latency HLS output writing CMAF segments and partial segments
+ * (RFC 8216bis) directly to a local directory, which can be served as-is
+ * by any HTTP server.
+ *
+ * Muxing happens in the packet callback, file writes, deletes and playlist
+ * updates are queued for a writer thread so that slow disks never hold up
+ * packet interleaving for other outputs.
+ */
+
+#define do_log(level, format, ...) \
+	blog(level, "[hls output: '%s'] " format, obs_output_get_name(out->output), ##__VA_ARGS__)
+
+#define warn(format, ...) do_log(LOG_WARNING, format, ##__VA_ARGS__)
+#define info(format, ...) do_log(LOG_INFO, format, ##__VA_ARGS__)
+
+#define INIT_SEGMENT_NAME "init.mp4"
+#define SEGMENT_PREFIX "segment"
+
+/* Number of segments at the end of the playlist that list their parts */
+#define PART_SEGMENTS 3
+
+struct hls_part {
+	int64_t duration_usec;
+	bool independent;
+};
+
+struct hls_segment {
+	uint64_t sequence;
+	int64_t duration_usec;
+	DARRAY(struct hls_part) parts;
+};
+
+enum hls_job_type {
+	HLS_JOB_WRITE,
+	HLS_JOB_DELETE,
+	HLS_JOB_STOP,
+};
+
+/* File operation for the writer thread, path and data are owned by the job */
+struct hls_job {
+	enum hls_job_type type;
+	char *path;
+	void *data;
+	size_t size;
+	const char *desc;
+
+	/* Parts are timed from being queued until they are on disk */
+	bool part;
+	uint64_t queued_ns;
+};
+
+struct hls_output {
+	obs_output_t *output;
+
+	struct dstr directory;
+	struct dstr playlist_path;
+
+	int64_t segment_duration_usec;
+	int64_t part_duration_usec;
+	int playlist_size;
+	int target_duration;
+
+	struct serializer serializer;
+	struct array_output_data buffer;
+	struct mp4_mux *muxer;
+
+	volatile bool active;
+	volatile bool stopping;
+	uint64_t stop_ts;
+
+	pthread_mutex_t mutex;
+
+	/* Segments in playlist window, last one is still being written */
+	DARRAY(struct hls_segment) segments;
+	DARRAY(uint8_t) segment_data;
+	bool segment_open;
+	uint64_t next_sequence;
+
+	/* Writer thread, jobs are executed in order */
+	pthread_t writer_thread;
+	bool writer_active;
+	pthread_mutex_t jobs_mutex;
+	os_sem_t *jobs_sem;
+	struct deque jobs;
+
+	/* Write latency instrumentation, guarded by jobs_mutex */
+	uint64_t parts_written;
+	uint64_t write_ns_total;
+	uint64_t write_ns_max;
+
+	uint64_t total_bytes;
+};
+
+static inline bool stopping(struct hls_output *out)
+{
+	return os_atomic_load_bool(&out->stopping);
+}
+
+static inline bool active(struct hls_output *out)
+{
+	return os_atomic_load_bool(&out->active);
+}
+
+static const char *hls_output_name(void *unused)
+{
+	UNUSED_PARAMETER(unused);
+	return obs_module_text("HLSOutput");
+}
+
+static inline void segment_path(struct hls_output *out, struct dstr *dst, uint64_t sequence)
+{
+	dstr_printf(dst, "%s/" SEGMENT_PREFIX "%" PRIu64 ".m4s", out->directory.array, sequence);
+}
+
+static inline void part_path(struct hls_output *out, struct dstr *dst, uint64_t sequence, size_t part)
+{
+	dstr_printf(dst, "%s/" SEGMENT_PREFIX "%" PRIu64 ".%zu.m4s", out->directory.array, sequence, part);
+}
+
+/* Write to a temporary file first so that clients never see partial data */
+static bool write_file(const char *path, const void *data, size_t size)
+{
+	struct dstr temp_path = {0};
+	bool success = false;
+
+	dstr_printf(&temp_path, "%s.tmp", path);
+
+	FILE *f = os_fopen(temp_path.array, "wb");
+	if (!f)
+		goto cleanup;
+
+	success = fwrite(data, 1, size, f) == size;
+	fclose(f);
+
+	if (success)
+		success = os_rename(temp_path.array, path) == 0;
+
+cleanup:
+	dstr_free(&temp_path);
+	return success;
+}
+
+static void free_segments(struct hls_output *out)
+{
+	for (size_t i = 0; i < out->segments.num; i++)
+		da_free(out->segments.array[i].parts);
+	da_free(out->segments);
+}
+
+static void free_job(struct hls_job *job)
+{
+	bfree(job->path);
+	bfree(job->data);
+}
+
+static void run_job(struct hls_output *out, struct hls_job *job)
+{
+	if (job->type == HLS_JOB_DELETE) {
+		os_unlink(job->path);
+		return;
+	}
+
+	if (!write_file(job->path, job->data, job->size))
+		warn("Failed to write %s '%s'", job->desc, job->path);
+
+	if (job->part) {
+		uint64_t write_ns = os_gettime_ns() - job->queued_ns;
+
+		pthread_mutex_lock(&out->jobs_mutex);
+		out->parts_written++;
+		out->write_ns_total += write_ns;
+		if (write_ns > out->write_ns_max)
+			out->write_ns_max = write_ns;
+		pthread_mutex_unlock(&out->jobs_mutex);
+	}
+}
+
+static void *writer_thread(void *data)
+{
+	struct hls_output *out = data;
+
+	os_set_thread_name("hls-output: writer");
+
+	while (os_sem_wait(out->jobs_sem) == 0) {
+		struct hls_job job;
+
+		pthread_mutex_lock(&out->jobs_mutex);
+		deque_pop_front(&out->jobs, &job, sizeof(job));
+		pthread_mutex_unlock(&out->jobs_mutex);
+
+		if (job.type == HLS_JOB_STOP)
+			break;
+
+		run_job(out, &job);
+		free_job(&job);
+	}
+
+	return NULL;
+}
+
+static void push_job(struct hls_output *out, struct hls_job *job)
+{
+	pthread_mutex_lock(&out->jobs_mutex);
+	deque_push_back(&out->jobs, job, sizeof(*job));
+	pthread_mutex_unlock(&out->jobs_mutex);
+
+	os_sem_post(out->jobs_sem);
+}
+
+/* Takes ownership of data */
+static void queue_write(struct hls_output *out, struct dstr *path, void *data, size_t size, const char *desc,
+			bool part)
+{
+	struct hls_job job = {
+		.type = HLS_JOB_WRITE,
+		.path = path->array,
+		.data = data,
+		.size = size,
+		.desc = desc,
+		.part = part,
+		.queued_ns = os_gettime_ns(),
+	};
+
+	dstr_init(path);
+	push_job(out, &job);
+}
+
+static void queue_delete(struct hls_output *out, struct dstr *path)
+{
+	struct hls_job job = {.type = HLS_JOB_DELETE, .path = path->array};
+
+	dstr_init(path);
+	push_job(out, &job);
+}
+
+static bool start_writer(struct hls_output *out)
+{
+	if (os_sem_init(&out->jobs_sem, 0) != 0)
+		return false;
+
+	if (pthread_create(&out->writer_thread, NULL, writer_thread, out) != 0) {
+		os_sem_destroy(out->jobs_sem);
+		out->jobs_sem = NULL;
+		return false;
+	}
+
+	out->writer_active = true;
+	return true;
+}
+
+/* Waits for every queued job to be done */
+static void stop_writer(struct hls_output *out)
+{
+	struct hls_job job = {.type = HLS_JOB_STOP};
+
+	if (!out->writer_active)
+		return;
+
+	push_job(out, &job);
+	pthread_join(out->writer_thread, NULL);
+
+	os_sem_destroy(out->jobs_sem);
+	out->jobs_sem = NULL;
+	out->writer_active = false;
+}
+
+static void delete_segment_files(struct hls_output *out, struct hls_segment *seg)
+{
+	struct dstr path = {0};
+
+	segment_path(out, &path, seg->sequence);
+	queue_delete(out, &path);
+
+	for (size_t i = 0; i < seg->parts.num; i++) {
+		part_path(out, &path, seg->sequence, i);
+		queue_delete(out, &path);
+	}
+}
+
+static void write_playlist(struct hls_output *out, bool final)
+{
+	struct dstr playlist = {0};
+	struct dstr path = {0};
+	const double part_target = (double)out->part_duration_usec / 1000000.0;
+
+	if (!out->segments.num)
+		return;
+
+	dstr_cat(&playlist, "#EXTM3U\n");
+	dstr_cat(&playlist, "#EXT-X-VERSION:9\n");
+	dstr_catf(&playlist, "#EXT-X-TARGETDURATION:%d\n", out->target_duration);
+	dstr_catf(&playlist, "#EXT-X-PART-INF:PART-TARGET=%.3f\n", part_target);
+	dstr_catf(&playlist, "#EXT-X-SERVER-CONTROL:PART-HOLD-BACK=%.3f\n", part_target * 3.0);
+	dstr_catf(&playlist, "#EXT-X-MEDIA-SEQUENCE:%" PRIu64 "\n", out->segments.array[0].sequence);
+	dstr_cat(&playlist, "#EXT-X-MAP:URI=\"" INIT_SEGMENT_NAME "\"\n");
+
+	size_t first_part_segment = out->segments.num > PART_SEGMENTS ? out->segments.num - PART_SEGMENTS : 0;
+
+	for (size_t i = 0; i < out->segments.num; i++) {
+		struct hls_segment *seg = &out->segments.array[i];
+		bool complete = final || i + 1 < out->segments.num || !out->segment_open;
+
+		if (i >= first_part_segment) {
+			for (size_t j = 0; j < seg->parts.num; j++) {
+				struct hls_part *part = &seg->parts.array[j];
+				dstr_catf(&playlist,
+					  "#EXT-X-PART:DURATION=%.5f,URI=\"" SEGMENT_PREFIX "%" PRIu64 ".%zu.m4s\"%s\n",
+					  (double)part->duration_usec / 1000000.0, seg->sequence, j,
+					  part->independent ? ",INDEPENDENT=YES" : "");
+			}
+		}
+
+		if (complete) {
+			dstr_catf(&playlist, "#EXTINF:%.5f,\n", (double)seg->duration_usec / 1000000.0);
+			dstr_catf(&playlist, SEGMENT_PREFIX "%" PRIu64 ".m4s\n", seg->sequence);
+		}
+	}
+
+	if (final) {
+		dstr_cat(&playlist, "#EXT-X-ENDLIST\n");
+	} else {
+		/* Announce the part that will be published next */
+		struct hls_segment *last = da_end(out->segments);
+		uint64_t sequence = out->segment_open ? last->sequence : out->next_sequence;
+		size_t part = out->segment_open ? last->parts.num : 0;
+
+		dstr_catf(&playlist, "#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"" SEGMENT_PREFIX "%" PRIu64 ".%zu.m4s\"\n",
+			  sequence, part);
+	}
+
+	dstr_copy_dstr(&path, &out->playlist_path);
+	queue_write(out, &path, playlist.array, playlist.len, "playlist", false);
+}
+
+static void close_segment(struct hls_output *out)
+{
+	struct hls_segment *seg = da_end(out->segments);
+	struct dstr path = {0};
+
+	if (!out->segment_open || !seg)
+		return;
+
+	/* The writer thread takes over the segment data */
+	segment_path(out, &path, seg->sequence);
+	queue_write(out, &path, out->segment_data.array, out->segment_data.num, "segment", false);
+	da_init(out->segment_data);
+
+	if (seg->duration_usec > (int64_t)out->target_duration * 1000000)
+		warn("Segment %" PRIu64 " (%.3f s) exceeds target duration, check keyframe interval", seg->sequence,
+		     (double)seg->duration_usec / 1000000.0);
+
+	out->segment_open = false;
+
+	/* Slide playlist window */
+	while (out->playlist_size > 0 && out->segments.num > (size_t)out->playlist_size) {
+		delete_segment_files(out, out->segments.array);
+		da_free(out->segments.array[0].parts);
+		da_erase(out->segments, 0);
+	}
+}
+
+static void open_segment(struct hls_output *out)
+{
+	struct hls_segment *seg = da_push_back_new(out->segments);
+	seg->sequence = out->next_sequence++;
+	out->segment_open = true;
+}
+
+static void write_part(struct hls_output *out, const struct mp4_fragment_info *frag)
+{
+	struct hls_segment *seg = da_end(out->segments);
+
+	/* New segments have to start with a keyframe */
+	if (!out->segment_open ||
+	    (frag->independent && seg->duration_usec + frag->duration_usec / 2 >= out->segment_duration_usec)) {
+		close_segment(out);
+		open_segment(out);
+		seg = da_end(out->segments);
+	}
+
+	struct dstr path = {0};
+	part_path(out, &path, seg->sequence, seg->parts.num);
+	queue_write(out, &path, bmemdup(out->buffer.bytes.array, out->buffer.bytes.num), out->buffer.bytes.num,
+		    "part", true);
+
+	da_push_back_array(out->segment_data, out->buffer.bytes.array, out->buffer.bytes.num);
+
+	struct hls_part *part = da_push_back_new(seg->parts);
+	part->duration_usec = frag->duration_usec;
+	part->independent = frag->independent;
+	seg->duration_usec += frag->duration_usec;
+}
+
+static void hls_fragment_callback(void *param, const struct mp4_fragment_info *frag)
+{
+	struct hls_output *out = param;
+
+	if (frag->type == MP4_FRAGMENT_INIT) {
+		struct dstr path = {0};
+		dstr_printf(&path, "%s/" INIT_SEGMENT_NAME, out->directory.array);
+		queue_write(out, &path, bmemdup(out->buffer.bytes.array, out->buffer.bytes.num),
+			    out->buffer.bytes.num, "initialization segment", false);
+	} else {
+		write_part(out, frag);
+		write_playlist(out, false);
+	}
+
+	array_output_serializer_reset(&out->buffer);
+}
+
+static void get_segment_stats_proc(void *data, calldata_t *cd)
+{
+	struct hls_output *out = data;
+
+	pthread_mutex_lock(&out->jobs_mutex);
+	double average_ms = out->parts_written ? (double)out->write_ns_total / (double)out->parts_written / 1000000.0
+					       : 0.0;
+	calldata_set_int(cd, "parts_written", (long long)out->parts_written);
+	calldata_set_float(cd, "average_write_ms", average_ms);
+	calldata_set_float(cd, "max_write_ms", (double)out->write_ns_max / 1000000.0);
+	pthread_mutex_unlock(&out->jobs_mutex);
+}
+
+/* Flushes the remaining samples as a final part, publishes the last segment
+ * and waits for the writer thread to put everything on disk */
+static void finish_output(struct hls_output *out)
+{
+	if (!out->muxer)
+		return;
+
+	mp4_mux_finalise(out->muxer);
+	close_segment(out);
+	write_playlist(out, true);
+	stop_writer(out);
+
+	mp4_mux_destroy(out->muxer);
+	out->muxer = NULL;
+	array_output_serializer_free(&out->buffer);
+}
+
+static void hls_output_destroy(void *data)
+{
+	struct hls_output *out = data;
+
+	/* Destroyed without a packet that triggered the stop */
+	finish_output(out);
+
+	pthread_mutex_destroy(&out->mutex);
+	pthread_mutex_destroy(&out->jobs_mutex);
+	deque_free(&out->jobs);
+	free_segments(out);
+	da_free(out->segment_data);
+	dstr_free(&out->directory);
+	dstr_free(&out->playlist_path);
+	bfree(out);
+}
+
+static void *hls_output_create(obs_data_t *settings, obs_output_t *output)
+{
+	struct hls_output *out = bzalloc(sizeof(struct hls_output));
+	out->output = output;
+	pthread_mutex_init(&out->mutex, NULL);
+	pthread_mutex_init(&out->jobs_mutex, NULL);
+
+	proc_handler_t *ph = obs_output_get_proc_handler(output);
+	proc_handler_add(ph,
+			 "void get_segment_stats(out int parts_written, out float average_write_ms, "
+			 "out float max_write_ms)",
+			 get_segment_stats_proc, out);
+
+	UNUSED_PARAMETER(settings);
+	return out;
+}
+
+/* Round part duration up to whole frames so that every part matches the
+ * advertised part target exactly. */
+static int64_t get_part_duration(struct hls_output *out, int64_t duration_usec)
+{
+	video_t *video = obs_output_video(out->output);
+	const struct video_output_info *voi = video_output_get_info(video);
+	int64_t frame_usec = (int64_t)util_mul_div64(voi->fps_den, 1000000, voi->fps_num);
+
+	if (frame_usec <= 0)
+		return duration_usec;
+
+	int64_t frames = (duration_usec + frame_usec - 1) / frame_usec;
+	return (frames ? frames : 1) * frame_usec;
+}
+
+static bool hls_output_start(void *data)
+{
+	struct hls_output *out = data;
+
+	if (!obs_output_can_begin_data_capture(out->output, 0))
+		return false;
+	if (!obs_output_initialize_encoders(out->output, 0))
+		return false;
+
+	/* A force stopped output never received the packet that finishes it */
+	os_atomic_set_bool(&out->active, false);
+	finish_output(out);
+
+	obs_data_t *settings = obs_output_get_settings(out->output);
+	const char *directory = obs_data_get_string(settings, "path");
+	const char *playlist = obs_data_get_string(settings, "playlist_name");
+	int64_t segment_ms = obs_data_get_int(settings, "segment_duration_ms");
+	int64_t part_ms = obs_data_get_int(settings, "part_duration_ms");
+	out->playlist_size = (int)obs_data_get_int(settings, "playlist_size");
+
+	dstr_copy(&out->directory, directory);
+	dstr_replace(&out->directory, "\\", "/");
+	if (dstr_end(&out->directory) == '/')
+		dstr_resize(&out->directory, out->directory.len - 1);
+	dstr_printf(&out->playlist_path, "%s/%s", out->directory.array, playlist);
+
+	obs_data_release(settings);
+
+	if (dstr_is_empty(&out->directory)) {
+		warn("Output directory not specified");
+		return false;
+	}
+
+	if (os_mkdirs(out->directory.array) == MKDIR_ERROR) {
+		warn("Unable to create directory '%s'", out->directory.array);
+		return false;
+	}
+
+	out->part_duration_usec = get_part_duration(out, part_ms * 1000);
+	out->segment_duration_usec = segment_ms * 1000;
+	if (out->segment_duration_usec < out->part_duration_usec)
+		out->segment_duration_usec = out->part_duration_usec;
+	out->target_duration = (int)((out->segment_duration_usec + 999999) / 1000000);
+
+	out->next_sequence = 0;
+	out->segment_open = false;
+	out->parts_written = 0;
+	out->write_ns_total = 0;
+	out->write_ns_max = 0;
+	out->total_bytes = 0;
+	free_segments(out);
+	da_resize(out->segment_data, 0);
+
+	if (!start_writer(out)) {
+		warn("Failed to create writer thread");
+		return false;
+	}
+
+	os_atomic_set_bool(&out->stopping, false);
+
+	array_output_serializer_init(&out->serializer, &out->buffer);
+
+	out->muxer = mp4_mux_create(out->output, &out->serializer, MP4_USE_NEGATIVE_CTS, FLAVOR_CMAF);
+	/* Allow for timestamp rounding when converting to microseconds */
+	mp4_mux_set_fragment_duration(out->muxer, out->part_duration_usec - 1000);
+	mp4_mux_set_fragment_callback(out->muxer, hls_fragment_callback, out);
+
+	os_atomic_set_bool(&out->active, true);
+	obs_output_begin_data_capture(out->output, 0);
+
+	info("Writing LL-HLS playlist '%s' (part target: %" PRId64 " ms, segment target: %" PRId64 " ms)",
+	     out->playlist_path.array, out->part_duration_usec / 1000, out->segment_duration_usec / 1000);
+	return true;
+}
+
+static void hls_output_stop(void *data, uint64_t ts)
+{
+	struct hls_output *out = data;
+	out->stop_ts = ts / 1000;
+	os_atomic_set_bool(&out->stopping, true);
+}
+
+static void hls_output_actual_stop(struct hls_output *out, int code)
+{
+	os_atomic_set_bool(&out->active, false);
+
+	info("Waiting for file writer to finish...");
+	finish_output(out);
+
+	if (code) {
+		obs_output_signal_stop(out->output, code);
+	} else {
+		obs_output_end_data_capture(out->output);
+	}
+
+	if (out->parts_written) {
+		info("Wrote %" PRIu64 " parts, average write latency: %.3f ms, maximum: %.3f ms", out->parts_written,
+		     (double)out->write_ns_total / (double)out->parts_written / 1000000.0,
+		     (double)out->write_ns_max / 1000000.0);
+	}
+}
+
+static void hls_output_packet(void *data, struct encoder_packet *packet)
+{
+	struct hls_output *out = data;
+
+	pthread_mutex_lock(&out->mutex);
+
+	if (!active(out))
+		goto unlock;
+
+	if (!packet) {
+		hls_output_actual_stop(out, OBS_OUTPUT_ENCODE_ERROR);
+		goto unlock;
+	}
+
+	if (stopping(out) && packet->sys_dts_usec >= (int64_t)out->stop_ts) {
+		hls_output_actual_stop(out, 0);
+		goto unlock;
+	}
+
+	out->total_bytes += packet->size;
+	mp4_mux_submit_packet(out->muxer, packet);
+
+unlock:
+	pthread_mutex_unlock(&out->mutex);
+}
+
+static void hls_output_defaults(obs_data_t *settings)
+{
+	obs_data_set_default_string(settings, "playlist_name", "stream.m3u8");
+	obs_data_set_default_int(settings, "segment_duration_ms", 2000);
+	obs_data_set_default_int(settings, "part_duration_ms", 334);
+	obs_data_set_default_int(settings, "playlist_size", 6);
+}
+
+static obs_properties_t *hls_output_properties(void *unused)
+{
+	UNUSED_PARAMETER(unused);
+
+	obs_properties_t *props = obs_properties_create();
+
+	obs_properties_add_path(props, "path", obs_module_text("HLSOutput.Directory"), OBS_PATH_DIRECTORY, NULL,
+				NULL);
+	obs_properties_add_text(props, "playlist_name", obs_module_text("HLSOutput.PlaylistName"), OBS_TEXT_DEFAULT);
+	obs_properties_add_int(props, "segment_duration_ms", obs_module_text("HLSOutput.SegmentDuration"), 500,
+			       10000, 100);
+	obs_properties_add_int(props, "part_duration_ms", obs_module_text("HLSOutput.PartDuration"), 50, 2000, 1);
+	obs_properties_add_int(props, "playlist_size", obs_module_text("HLSOutput.PlaylistSize"), 0, 1000, 1);
+	return props;
+}
+
+static uint64_t hls_output_total_bytes(void *data)
+{
+	struct hls_output *out = data;
+	return out->total_bytes;
+}
+
+struct obs_output_info hls_output_info = {
+	.id = "hls_output",
+	.flags = OBS_OUTPUT_AV | OBS_OUTPUT_ENCODED | OBS_OUTPUT_PACKET_PREFIX,
+	.encoded_video_codecs = "h264;hevc;av1",
+	.encoded_audio_codecs = "aac;opus",
+	.get_name = hls_output_name,
+	.create = hls_output_create,
+	.destroy = hls_output_destroy,
+	.start = hls_output_start,
+	.stop = hls_output_stop,
+	.encoded_packet = hls_output_packet,
+	.get_defaults = hls_output_defaults,
+	.get_properties = hls_output_properties,
+	.get_total_bytes = hls_output_total_bytes,
+};
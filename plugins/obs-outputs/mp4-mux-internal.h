@@ -135,6 +135,14 @@ struct mp4_mux {
 	uint32_t fragments_written;
 	/* PTS where next fragmentation should take place */
 	int64_t next_frag_pts;
+	/* PTS of the last fragmentation point that was scheduled */
+	int64_t last_frag_pts;
+	/* Maximum fragment duration (0 = fragment on keyframes only) */
+	int64_t fragment_duration_usec;
+
+	/* Notification for segmented (CMAF) output */
+	mp4_mux_fragment_cb fragment_cb;
+	void *fragment_cb_param;
 
 	/* Creation time (seconds since Jan 1 1904) */
 	uint64_t creation_time;
@@ -87,7 +87,15 @@ static size_t mp4_write_ftyp(struct mp4_mux *mux, bool fragmented)
 
 	write_box(s, 0, "ftyp");
 
-	if (mux->flavor == FLAVOR_MOV) {
+	if (mux->flavor == FLAVOR_CMAF) {
+		/* CMAF headers are always fragmented and never rewritten. */
+		s_write(s, "iso6", 4); // major brand
+		s_wb32(s, 0);          // minor version
+		s_write(s, "iso6", 4); // minor brands
+		s_write(s, "cmfc", 4);
+		s_write(s, "isom", 4);
+		s_write(s, "mp41", 4);
+	} else if (mux->flavor == FLAVOR_MOV) {
 		/* For MOV, the brand is just "qt" followed by two spaces. */
 		s_write(s, "qt  ", 4); // major brand
 		s_wb32(s, 0x20140200); // minor version (BCD YYYYMM00 per QTFF spec)
@@ -2441,6 +2449,7 @@ static void mp4_create_chapter_pkt(struct encoder_packet *pkt, int64_t dts_usec,
 {
 	int64_t dts = dts_usec / 1000; // chapter track uses a ms timebase
 
+	memset(pkt, 0, sizeof(*pkt));
 	pkt->pts = dts;
 	pkt->dts = dts;
 	pkt->dts_usec = dts_usec;
@@ -2623,16 +2632,25 @@ static void write_packets(struct mp4_mux *mux, struct mp4_track *track)
 	da_clear(track->fragment_samples);
 }
 
+static inline void emit_fragment(struct mp4_mux *mux, const struct mp4_fragment_info *info)
+{
+	if (mux->fragment_cb)
+		mux->fragment_cb(mux->fragment_cb_param, info);
+}
+
 static void mp4_flush_fragment(struct mp4_mux *mux)
 {
 	struct serializer *s = mux->serializer;
+	const bool segmented = mux->flavor == FLAVOR_CMAF;
 
 	// Write file header if not already done
 	if (!mux->fragments_written) {
 		mp4_write_ftyp(mux, true);
 		/* Placeholder to write mdat header during soft-remux */
-		mux->placeholder_offset = serializer_get_pos(s);
-		mp4_write_free(mux);
+		if (!segmented) {
+			mux->placeholder_offset = serializer_get_pos(s);
+			mp4_write_free(mux);
+		}
 	}
 
 	// Array output as temporary buffer to avoid sending seeks to disk
@@ -2646,6 +2664,11 @@ static void mp4_flush_fragment(struct mp4_mux *mux)
 		mp4_write_moov(mux, true);
 		s_write(s, aod.bytes.array, aod.bytes.num);
 		array_output_serializer_reset(&aod);
+
+		if (segmented) {
+			struct mp4_fragment_info init = {.type = MP4_FRAGMENT_INIT};
+			emit_fragment(mux, &init);
+		}
 	}
 
 	mux->fragments_written++;
@@ -2655,6 +2678,14 @@ static void mp4_flush_fragment(struct mp4_mux *mux)
 
 	uint64_t mdat_size = 8;
 
+	/* The first track (video if present) determines fragment timing */
+	struct mp4_track *primary = mux->tracks.num ? mux->tracks.array : NULL;
+	uint64_t primary_start = primary ? primary->duration : 0;
+	bool independent = true;
+
+	if (primary && primary->type == TRACK_VIDEO && primary->packets.size)
+		independent = get_pkt_at(&primary->packets, 0)->keyframe;
+
 	for (size_t idx = 0; idx < mux->tracks.num; idx++) {
 		struct mp4_track *track = &mux->tracks.array[idx];
 		process_packets(mux, track, &mdat_size);
@@ -2706,6 +2737,17 @@ static void mp4_flush_fragment(struct mp4_mux *mux)
 		write_packets(mux, mux->chapter_track);
 
 	mux->next_frag_pts = 0;
+
+	if (segmented && primary && mdat_size > 8) {
+		struct mp4_fragment_info info = {
+			.type = MP4_FRAGMENT_MEDIA,
+			.start_usec = (int64_t)util_mul_div64(primary_start, 1000000, primary->timebase_den),
+			.duration_usec =
+				(int64_t)util_mul_div64(primary->duration - primary_start, 1000000, primary->timebase_den),
+			.independent = independent,
+		};
+		emit_fragment(mux, &info);
+	}
 }
 
 /* ========================================================================== */
@@ -2932,9 +2974,18 @@ bool mp4_mux_submit_packet(struct mp4_mux *mux, struct encoder_packet *pkt)
 		else if (track->codec == CODEC_PRORES)
 			obs_encoder_packet_ref(&parsed_packet, pkt);
 
+		int64_t pts_usec = packet_pts_usec(&parsed_packet);
+
 		/* Set fragmentation PTS if packet is keyframe and PTS > 0 */
 		if (parsed_packet.keyframe && parsed_packet.pts > 0) {
-			mux->next_frag_pts = packet_pts_usec(&parsed_packet);
+			mux->next_frag_pts = pts_usec;
+			mux->last_frag_pts = pts_usec;
+		} else if (mux->fragment_duration_usec && !mux->next_frag_pts && track == mux->tracks.array &&
+			   pts_usec - mux->last_frag_pts >= mux->fragment_duration_usec) {
+			/* Fragment within GOP once the maximum duration is reached,
+			 * unless a fragment is already pending. */
+			mux->next_frag_pts = pts_usec;
+			mux->last_frag_pts = pts_usec;
 		}
 	}
 
@@ -2945,7 +2996,7 @@ bool mp4_mux_submit_packet(struct mp4_mux *mux, struct encoder_packet *pkt)
 
 bool mp4_mux_add_chapter(struct mp4_mux *mux, int64_t dts_usec, const char *name)
 {
-	if (dts_usec < 0)
+	if (dts_usec < 0 || mux->flavor == FLAVOR_CMAF)
 		return false;
 	if (!mux->chapter_track)
 		add_chapter_track(mux);
@@ -2978,6 +3029,10 @@ bool mp4_mux_finalise(struct mp4_mux *mux)
 
 	info("Number of fragments: %u", mux->fragments_written);
 
+	/* Segmented output has no file header to rewrite. */
+	if (mux->flavor == FLAVOR_CMAF)
+		return true;
+
 	if (mux->flags & MP4_SKIP_FINALISATION) {
 		warn("Skipping finalization!");
 		return true;
@@ -3026,3 +3081,14 @@ bool mp4_mux_finalise(struct mp4_mux *mux)
 	info("Final mdat size: %zu KiB", data_size / 1024);
 	return true;
 }
+
+void mp4_mux_set_fragment_duration(struct mp4_mux *mux, int64_t duration_usec)
+{
+	mux->fragment_duration_usec = duration_usec > 0 ? duration_usec : 0;
+}
+
+void mp4_mux_set_fragment_callback(struct mp4_mux *mux, mp4_mux_fragment_cb callback, void *param)
+{
+	mux->fragment_cb = callback;
+	mux->fragment_cb_param = param;
+}
@@ -26,7 +26,7 @@ struct mp4_mux;
 enum mp4_flavor {
 	FLAVOR_MP4,  /* ISO/IEC 14496-12 */
 	FLAVOR_MOV,  /* Apple QuickTime */
-	FLAVOR_CMAF, /* ISO/IEC 23000-19 (not yet implemented) */
+	FLAVOR_CMAF, /* ISO/IEC 23000-19 (segmented output only) */
 };
 
 enum mp4_mux_flags {
@@ -40,9 +40,31 @@ enum mp4_mux_flags {
 	MP4_USE_NEGATIVE_CTS = 1 << 3,
 };
 
+enum mp4_fragment_type {
+	MP4_FRAGMENT_INIT = 1,  /* ftyp + moov (CMAF header) */
+	MP4_FRAGMENT_MEDIA = 2, /* moof + mdat (CMAF chunk) */
+};
+
+struct mp4_fragment_info {
+	enum mp4_fragment_type type;
+	/* Decode time and duration of the primary track's samples */
+	int64_t start_usec;
+	int64_t duration_usec;
+	/* Fragment starts with a sync sample */
+	bool independent;
+};
+
+/* Called after a complete fragment has been written to the serializer */
+typedef void (*mp4_mux_fragment_cb)(void *param, const struct mp4_fragment_info *info);
+
 struct mp4_mux *mp4_mux_create(obs_output_t *output, struct serializer *serializer, enum mp4_mux_flags flags,
 			       enum mp4_flavor flavor);
 void mp4_mux_destroy(struct mp4_mux *mux);
 bool mp4_mux_submit_packet(struct mp4_mux *mux, struct encoder_packet *pkt);
 bool mp4_mux_add_chapter(struct mp4_mux *mux, int64_t dts_usec, const char *name);
 bool mp4_mux_finalise(struct mp4_mux *mux);
+
+/* Fragment at least every duration_usec in addition to every keyframe,
+ * fragments will not necessarily start with a sync sample. */
+void mp4_mux_set_fragment_duration(struct mp4_mux *mux, int64_t duration_usec);
+void mp4_mux_set_fragment_callback(struct mp4_mux *mux, mp4_mux_fragment_cb callback, void *param);
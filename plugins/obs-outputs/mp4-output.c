@@ -503,6 +503,10 @@ static void mp4_output_actual_stop(struct mp4_output *out, int code)
 static void push_back_packet(struct mp4_output *out, struct encoder_packet *packet)
 {
 	struct encoder_packet pkt;
+
+	/* Prefix units are only available while the packet is being
+	 * delivered, buffered packets carry them in their data */
+	obs_encoder_packet_merge_prefix(packet);
 	obs_encoder_packet_ref(&pkt, packet);
 	da_push_back(out->split_buffer, &pkt);
 }
@@ -607,7 +611,8 @@ uint64_t mp4_output_total_bytes(void *data)
 
 struct obs_output_info mp4_output_info = {
 	.id = "mp4_output",
-	.flags = OBS_OUTPUT_AV | OBS_OUTPUT_ENCODED | OBS_OUTPUT_MULTI_TRACK_AV | OBS_OUTPUT_CAN_PAUSE,
+	.flags = OBS_OUTPUT_AV | OBS_OUTPUT_ENCODED | OBS_OUTPUT_MULTI_TRACK_AV | OBS_OUTPUT_CAN_PAUSE |
+		 OBS_OUTPUT_PACKET_PREFIX,
 	.encoded_video_codecs = "h264;hevc;av1",
 	.encoded_audio_codecs = "aac;alac;flac;opus",
 	.get_name = mp4_output_name,
@@ -622,7 +627,8 @@ struct obs_output_info mp4_output_info = {
 
 struct obs_output_info mov_output_info = {
 	.id = "mov_output",
-	.flags = OBS_OUTPUT_AV | OBS_OUTPUT_ENCODED | OBS_OUTPUT_MULTI_TRACK_AV | OBS_OUTPUT_CAN_PAUSE,
+	.flags = OBS_OUTPUT_AV | OBS_OUTPUT_ENCODED | OBS_OUTPUT_MULTI_TRACK_AV | OBS_OUTPUT_CAN_PAUSE |
+		 OBS_OUTPUT_PACKET_PREFIX,
 	.encoded_video_codecs = "h264;hevc;prores",
 	.encoded_audio_codecs = "aac;alac",
 	.get_name = mov_output_name,
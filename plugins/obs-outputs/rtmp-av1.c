@@ -19,6 +19,7 @@
 #include "utils.h"
 
 #include <obs.h>
+#include <obs-av1.h>
 #include <util/array-serializer.h>
 
 /* Adapted from FFmpeg's libavformat/av1.c for our FLV muxer. */
@@ -595,7 +596,19 @@ void obs_parse_av1_packet(struct encoder_packet *av1_packet, const struct encode
 	serialize(&s, &ref, sizeof(ref));
 
 	*av1_packet = *src;
-	serialize_av1_data(&s, src->data, src->size, &av1_packet->keyframe, &av1_packet->priority);
+
+	/* Metadata OBUs go after the sequence header, before the first frame */
+	const uint8_t *prefix;
+	size_t prefix_size;
+	obs_encoder_packet_get_prefix(src, &prefix, &prefix_size);
+
+	size_t frame = prefix_size ? obs_av1_first_frame_offset(src->data, src->size) : src->size;
+	serialize_av1_data(&s, src->data, frame, &av1_packet->keyframe, &av1_packet->priority);
+	if (prefix_size) {
+		s_write(&s, prefix, prefix_size);
+		serialize_av1_data(&s, src->data + frame, src->size - frame, &av1_packet->keyframe,
+				   &av1_packet->priority);
+	}
 
 	av1_packet->data = output.bytes.array + sizeof(ref);
 	av1_packet->size = output.bytes.num - sizeof(ref);
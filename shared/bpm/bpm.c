@@ -311,18 +311,16 @@ static size_t extract_buffer_from_sei(sei_t *sei, uint8_t **data_out)
 }
 static const uint8_t nal_start[4] = {0, 0, 0, 1};
 
-/* process_metrics() will update and insert unregistered
- * SEI (AVC/HEVC) or OBU (AV1) messages into the encoded
- * video bitstream.
+/* process_metrics() will update and attach unregistered
+ * SEI (AVC/HEVC) or OBU (AV1) messages to the encoded
+ * video packet as prefix units.
 */
 static bool process_metrics(obs_output_t *output, struct encoder_packet *out, struct encoder_packet_time *ept,
 			    struct metrics_data *m_track)
 {
-	struct encoder_packet backup = *out;
 	sei_t sei;
 	uint8_t *data = NULL;
 	size_t size;
-	long ref = 1;
 	bool avc = false;
 	bool hevc = false;
 	bool av1 = false;
@@ -373,14 +371,11 @@ static bool process_metrics(obs_output_t *output, struct encoder_packet *out, st
 		hevc_nal_header[1] = out->data[nal_header_index_start + 1];
 	}
 #endif
-	// Create array for the original packet data + the SEI appended data
+	// Collect the SEI NAL units/OBUs, these are attached to the packet
+	// as prefix units so the packet data itself is not copied
 	DARRAY(uint8_t) out_data;
 	da_init(out_data);
 
-	// Copy the original packet
-	da_push_back_array(out_data, (uint8_t *)&ref, sizeof(ref));
-	da_push_back_array(out_data, out->data, out->size);
-
 	// Build the SEI metrics message payload
 	bpm_ts_sei_render(m_track);
 	bpm_sm_sei_render(m_track);
@@ -415,8 +410,6 @@ static bool process_metrics(obs_output_t *output, struct encoder_packet *out, st
 				 * A slightly modified SEI for HEVC and a metadata OBU for AV1.
 				 */
 				if (avc) {
-					/* TODO: SEI should come after AUD/SPS/PPS,
-					 * but before any VCL */
 					da_push_back_array(out_data, nal_start, 4);
 					da_push_back_array(out_data, data, size);
 #ifdef ENABLE_HEVC
@@ -431,11 +424,15 @@ static bool process_metrics(obs_output_t *output, struct encoder_packet *out, st
 					 * nuh_temporal_id_plus1    u(3)
 					 * }
 					 */
-					const uint8_t suffix_sei_nal_type = 40;
+					/* The units are inserted in front of the first slice
+					 * of the access unit, where only prefix SEIs (39) are
+					 * allowed; suffix SEIs (40) have to follow a VCL NAL
+					 * unit (H.265 7.4.2.4.4). */
+					const uint8_t prefix_sei_nal_type = 39;
 					/* The first bit is always 0, so we just need to
 					 * save the last bit off the original header and
 					 * add the SEI NAL type. */
-					uint8_t first_byte = (suffix_sei_nal_type << 1) | (0x01 & hevc_nal_header[0]);
+					uint8_t first_byte = (prefix_sei_nal_type << 1) | (0x01 & hevc_nal_header[0]);
 					hevc_nal_header[0] = first_byte;
 					/* The HEVC NAL unit header is 2 byte instead of
 					 * one, otherwise everything else is the
@@ -461,11 +458,8 @@ static bool process_metrics(obs_output_t *output, struct encoder_packet *out, st
 			sei_free(&sei);
 		}
 	}
-	obs_encoder_packet_release(out);
-
-	*out = backup;
-	out->data = (uint8_t *)out_data.array + sizeof(ref);
-	out->size = out_data.num - sizeof(ref);
+	obs_encoder_packet_add_prefix(out, out_data.array, out_data.num);
+	da_free(out_data);
 
 	if (avc || hevc || av1) {
 		return true;
@@ -0,0 +1,741 @@
+/*
+ * Headless encoder benchmark.
+ *
+ * Feeds synthetic frames into any registered encoder through a standalone
+ * video_t/audio_t (no graphics subsystem or UI needed) and reports encode
+ * speed, per-frame latency, output bitrate and CPU usage.
+ *
+ *   encoder-bench [options] <encoder id>
+ *   encoder-bench --list
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+
+#include <util/base.h>
+#include <util/bmem.h>
+#include <util/darray.h>
+#include <util/dstr.h>
+#include <util/platform.h>
+#include <util/threading.h>
+#include <media-io/video-frame.h>
+#include <obs.h>
+
+#define TWO_PI 6.28318530717958647692
+#define NUM_PATTERNS 8
+#define CACHE_SIZE 16
+#define STOP_TIMEOUT_MS 10000
+
+struct bench_options {
+	const char *encoder_id;
+	const char *settings_json;
+	enum video_format format;
+	uint32_t width;
+	uint32_t height;
+	uint32_t fps_num;
+	uint32_t fps_den;
+	uint32_t frames;
+	uint32_t sample_rate;
+	enum speaker_layout speakers;
+	bool realtime;
+	bool json;
+	bool verbose;
+};
+
+struct bench_stats {
+	pthread_mutex_t mutex;
+
+	uint64_t *submit_ns;
+	size_t num_submitted;
+
+	DARRAY(uint64_t) latencies;
+	uint64_t total_bytes;
+	uint32_t packets;
+	uint32_t keyframes;
+};
+
+static struct bench_stats stats;
+static bool verbose_log = false;
+
+/* ------------------------------------------------------------------------- */
+/* logging */
+
+static void do_log(int log_level, const char *msg, va_list args, void *param)
+{
+	if (log_level > LOG_WARNING && !verbose_log)
+		return;
+
+	vfprintf(stderr, msg, args);
+	fputc('\n', stderr);
+
+	UNUSED_PARAMETER(param);
+}
+
+/* ------------------------------------------------------------------------- */
+/* output that only collects packet statistics */
+
+static const char *bench_output_getname(void *unused)
+{
+	UNUSED_PARAMETER(unused);
+	return "Encoder Benchmark Output";
+}
+
+static void *bench_output_create(obs_data_t *settings, obs_output_t *output)
+{
+	UNUSED_PARAMETER(settings);
+	return output;
+}
+
+static void bench_output_destroy(void *data)
+{
+	UNUSED_PARAMETER(data);
+}
+
+static bool bench_output_start(void *data)
+{
+	obs_output_t *output = data;
+
+	if (!obs_output_can_begin_data_capture(output, 0))
+		return false;
+	if (!obs_output_initialize_encoders(output, 0))
+		return false;
+
+	return obs_output_begin_data_capture(output, 0);
+}
+
+static void bench_output_stop(void *data, uint64_t ts)
+{
+	obs_output_end_data_capture(data);
+	UNUSED_PARAMETER(ts);
+}
+
+static void bench_output_packet(void *data, struct encoder_packet *packet)
+{
+	uint64_t now = os_gettime_ns();
+
+	pthread_mutex_lock(&stats.mutex);
+
+	stats.total_bytes += packet->size;
+	stats.packets++;
+	if (packet->keyframe)
+		stats.keyframes++;
+
+	/* Video input pts are frame index * timebase_num, so the packet pts
+	 * maps back to the submission time of its source frame */
+	if (packet->type == OBS_ENCODER_VIDEO && packet->timebase_num) {
+		int64_t idx = packet->pts / packet->timebase_num;
+		if (idx >= 0 && (size_t)idx < stats.num_submitted) {
+			uint64_t latency = now - stats.submit_ns[idx];
+			da_push_back(stats.latencies, &latency);
+		}
+	}
+
+	pthread_mutex_unlock(&stats.mutex);
+
+	UNUSED_PARAMETER(data);
+}
+
+static struct obs_output_info bench_video_output_info = {
+	.id = "encoder_bench_video_output",
+	.flags = OBS_OUTPUT_VIDEO | OBS_OUTPUT_ENCODED,
+	.get_name = bench_output_getname,
+	.create = bench_output_create,
+	.destroy = bench_output_destroy,
+	.start = bench_output_start,
+	.stop = bench_output_stop,
+	.encoded_packet = bench_output_packet,
+};
+
+static struct obs_output_info bench_audio_output_info = {
+	.id = "encoder_bench_audio_output",
+	.flags = OBS_OUTPUT_AUDIO | OBS_OUTPUT_ENCODED,
+	.get_name = bench_output_getname,
+	.create = bench_output_create,
+	.destroy = bench_output_destroy,
+	.start = bench_output_start,
+	.stop = bench_output_stop,
+	.encoded_packet = bench_output_packet,
+};
+
+/* ------------------------------------------------------------------------- */
+/* synthetic frames */
+
+static inline uint32_t lcg_rand(uint32_t *seed)
+{
+	*seed = *seed * 1664525 + 1013904223;
+	return *seed >> 24;
+}
+
+/* Moving gradient with a noisy band so frames are neither trivially
+ * compressible nor pure noise */
+static inline uint32_t pattern_value(uint32_t x, uint32_t y, uint32_t t, uint32_t *seed)
+{
+	uint32_t v = (x + y + t * 8) & 0xFF;
+	if (((y + t * 4) & 0xFF) < 32)
+		v = lcg_rand(seed);
+	return v;
+}
+
+static void fill_plane8(uint8_t *data, uint32_t linesize, uint32_t cx, uint32_t cy, uint32_t step, uint32_t offset,
+			uint32_t t, uint32_t *seed)
+{
+	for (uint32_t y = 0; y < cy; y++) {
+		uint8_t *line = data + (size_t)linesize * y;
+		for (uint32_t x = 0; x < cx; x++)
+			line[x * step] = (uint8_t)(pattern_value(x + offset, y + offset, t, seed));
+	}
+}
+
+static void fill_plane16(uint8_t *data, uint32_t linesize, uint32_t cx, uint32_t cy, uint32_t step, uint32_t offset,
+			 uint32_t t, uint32_t *seed)
+{
+	for (uint32_t y = 0; y < cy; y++) {
+		uint16_t *line = (uint16_t *)(data + (size_t)linesize * y);
+		for (uint32_t x = 0; x < cx; x++)
+			line[x * step] = (uint16_t)(pattern_value(x + offset, y + offset, t, seed) << 8);
+	}
+}
+
+static void fill_frame(struct video_frame *frame, const struct bench_options *opts, uint32_t t)
+{
+	uint32_t cx = opts->width;
+	uint32_t cy = opts->height;
+	uint32_t seed = t + 1;
+
+	switch (opts->format) {
+	case VIDEO_FORMAT_NV12:
+		fill_plane8(frame->data[0], frame->linesize[0], cx, cy, 1, 0, t, &seed);
+		fill_plane8(frame->data[1], frame->linesize[1], cx / 2, cy / 2, 2, 64, t, &seed);
+		fill_plane8(frame->data[1] + 1, frame->linesize[1], cx / 2, cy / 2, 2, 128, t, &seed);
+		break;
+	case VIDEO_FORMAT_I444:
+		fill_plane8(frame->data[0], frame->linesize[0], cx, cy, 1, 0, t, &seed);
+		fill_plane8(frame->data[1], frame->linesize[1], cx, cy, 1, 64, t, &seed);
+		fill_plane8(frame->data[2], frame->linesize[2], cx, cy, 1, 128, t, &seed);
+		break;
+	case VIDEO_FORMAT_P010:
+		fill_plane16(frame->data[0], frame->linesize[0], cx, cy, 1, 0, t, &seed);
+		fill_plane16(frame->data[1], frame->linesize[1], cx / 2, cy / 2, 2, 64, t, &seed);
+		fill_plane16(frame->data[1] + 2, frame->linesize[1], cx / 2, cy / 2, 2, 128, t, &seed);
+		break;
+	default:
+		break;
+	}
+}
+
+static bool audio_input(void *param, uint64_t start_ts, uint64_t end_ts, uint64_t *new_ts, uint32_t active_mixers,
+			struct audio_output_data *mixes)
+{
+	const struct bench_options *opts = param;
+	static uint64_t sample_pos = 0;
+	size_t channels = get_audio_channels(opts->speakers);
+
+	for (size_t i = 0; i < AUDIO_OUTPUT_FRAMES; i++) {
+		double t = (double)(sample_pos + i) / (double)opts->sample_rate;
+		float val = (float)(sin(t * 440.0 * TWO_PI) * 0.5);
+
+		for (size_t ch = 0; ch < channels; ch++)
+			mixes[0].data[ch][i] = val;
+	}
+
+	sample_pos += AUDIO_OUTPUT_FRAMES;
+	*new_ts = start_ts;
+
+	UNUSED_PARAMETER(end_ts);
+	UNUSED_PARAMETER(active_mixers);
+	return true;
+}
+
+/* ------------------------------------------------------------------------- */
+/* results */
+
+static int cmp_uint64(const void *a, const void *b)
+{
+	uint64_t va = *(const uint64_t *)a;
+	uint64_t vb = *(const uint64_t *)b;
+	return va < vb ? -1 : (va > vb ? 1 : 0);
+}
+
+static double percentile_ms(uint64_t *sorted, size_t num, double pct)
+{
+	if (!num)
+		return 0.0;
+
+	size_t idx = (size_t)((double)(num - 1) * pct / 100.0 + 0.5);
+	return (double)sorted[idx] / 1000000.0;
+}
+
+static void report(const struct bench_options *opts, obs_encoder_t *encoder, uint32_t frames, uint64_t wall_ns,
+		   double cpu_percent)
+{
+	bool video = obs_encoder_get_type(encoder) == OBS_ENCODER_VIDEO;
+	double wall_sec = (double)wall_ns / 1000000000.0;
+	double cpu_sec = cpu_percent / 100.0 * (double)os_get_logical_cores() * wall_sec;
+	double enc_ms = (double)obs_encoder_get_average_encode_time_ns(encoder) / 1000000.0;
+	double media_sec;
+
+	if (video)
+		media_sec = (double)frames * (double)opts->fps_den / (double)opts->fps_num;
+	else
+		media_sec = (double)frames * (double)obs_encoder_get_frame_size(encoder) / (double)opts->sample_rate;
+
+	double kbps = media_sec > 0.0 ? (double)stats.total_bytes * 8.0 / media_sec / 1000.0 : 0.0;
+	double fps = wall_sec > 0.0 ? (double)frames / wall_sec : 0.0;
+
+	qsort(stats.latencies.array, stats.latencies.num, sizeof(uint64_t), cmp_uint64);
+	double p50 = percentile_ms(stats.latencies.array, stats.latencies.num, 50.0);
+	double p90 = percentile_ms(stats.latencies.array, stats.latencies.num, 90.0);
+	double p99 = percentile_ms(stats.latencies.array, stats.latencies.num, 99.0);
+	double pmax = percentile_ms(stats.latencies.array, stats.latencies.num, 100.0);
+
+	if (opts->json) {
+		obs_data_t *data = obs_data_create();
+		obs_data_set_string(data, "encoder", opts->encoder_id);
+		obs_data_set_string(data, "type", video ? "video" : "audio");
+		if (video) {
+			obs_data_set_string(data, "format", get_video_format_name(opts->format));
+			obs_data_set_int(data, "width", opts->width);
+			obs_data_set_int(data, "height", opts->height);
+			obs_data_set_double(data, "encode_fps", fps);
+			obs_data_set_double(data, "latency_p50_ms", p50);
+			obs_data_set_double(data, "latency_p90_ms", p90);
+			obs_data_set_double(data, "latency_p99_ms", p99);
+			obs_data_set_double(data, "latency_max_ms", pmax);
+		}
+		obs_data_set_int(data, "frames", frames);
+		obs_data_set_int(data, "packets", stats.packets);
+		obs_data_set_int(data, "keyframes", stats.keyframes);
+		obs_data_set_double(data, "avg_encode_ms", enc_ms);
+		obs_data_set_double(data, "bitrate_kbps", kbps);
+		obs_data_set_double(data, "wall_sec", wall_sec);
+		obs_data_set_double(data, "cpu_sec", cpu_sec);
+		obs_data_set_double(data, "cpu_percent", cpu_percent);
+		printf("%s\n", obs_data_get_json_pretty(data));
+		obs_data_release(data);
+		return;
+	}
+
+	printf("encoder:          %s\n", opts->encoder_id);
+	if (video) {
+		printf("input:            %" PRIu32 "x%" PRIu32 " %s @ %" PRIu32 "/%" PRIu32 "%s\n", opts->width,
+		       opts->height, get_video_format_name(opts->format), opts->fps_num, opts->fps_den,
+		       opts->realtime ? " (realtime)" : "");
+		printf("frames:           %" PRIu32 " in, %" PRIu32 " packets out (%" PRIu32 " keyframes)\n", frames,
+		       stats.packets, stats.keyframes);
+		printf("encode speed:     %.2f fps\n", fps);
+		printf("latency (ms):     p50 %.2f  p90 %.2f  p99 %.2f  max %.2f\n", p50, p90, p99, pmax);
+	} else {
+		printf("input:            %" PRIu32 " Hz, %d channels\n", opts->sample_rate,
+		       (int)get_audio_channels(opts->speakers));
+		printf("packets:          %" PRIu32 "\n", stats.packets);
+		printf("realtime factor:  %.1fx\n", enc_ms > 0.0 ? media_sec * 1000.0 / frames / enc_ms : 0.0);
+	}
+	printf("avg encode call:  %.3f ms\n", enc_ms);
+	printf("bitrate:          %.1f kbps\n", kbps);
+	printf("cpu time:         %.2f s (%.1f%% of all cores over %.2f s)\n", cpu_sec, cpu_percent, wall_sec);
+}
+
+/* ------------------------------------------------------------------------- */
+/* benchmark runs */
+
+static bool wait_for_stop(obs_output_t *output)
+{
+	obs_output_stop(output);
+
+	for (int i = 0; i < STOP_TIMEOUT_MS && obs_output_active(output); i++)
+		os_sleep_ms(1);
+
+	return !obs_output_active(output);
+}
+
+static bool run_video(const struct bench_options *opts, obs_encoder_t *encoder)
+{
+	struct video_output_info voi = {
+		.name = "encoder-bench",
+		.format = opts->format,
+		.fps_num = opts->fps_num,
+		.fps_den = opts->fps_den,
+		.width = opts->width,
+		.height = opts->height,
+		.range = VIDEO_RANGE_PARTIAL,
+		.colorspace = opts->format == VIDEO_FORMAT_P010 ? VIDEO_CS_2100_PQ : VIDEO_CS_709,
+		.cache_size = CACHE_SIZE,
+	};
+	struct video_frame patterns[NUM_PATTERNS];
+	video_t *video = NULL;
+	obs_output_t *output = NULL;
+	bool success = false;
+
+	if (video_output_open(&video, &voi) != VIDEO_OUTPUT_SUCCESS) {
+		fprintf(stderr, "Failed to open video output\n");
+		return false;
+	}
+
+	for (uint32_t i = 0; i < NUM_PATTERNS; i++) {
+		video_frame_init(&patterns[i], opts->format, opts->width, opts->height);
+		fill_frame(&patterns[i], opts, i);
+	}
+
+	/* Encode synchronously on the video-io thread so the submit loop below
+	 * can apply back-pressure without any frames being dropped */
+	obs_encoder_set_threaded(encoder, false);
+	obs_encoder_set_video(encoder, video);
+
+	output = obs_output_create(bench_video_output_info.id, "encoder-bench", NULL, NULL);
+	obs_output_set_video_encoder(output, encoder);
+
+	stats.submit_ns = bzalloc(sizeof(uint64_t) * opts->frames);
+
+	if (!obs_output_start(output)) {
+		const char *err = obs_output_get_last_error(output);
+		fprintf(stderr, "Failed to start encoder%s%s\n", err ? ": " : "", err ? err : "");
+		goto fail;
+	}
+
+	uint64_t frame_time = video_output_get_frame_time(video);
+	os_cpu_usage_info_t *cpu = os_cpu_usage_info_start();
+	uint64_t start = os_gettime_ns();
+
+	for (uint32_t i = 0; i < opts->frames; i++) {
+		struct video_frame frame;
+		uint64_t ts = start + frame_time * i;
+
+		if (opts->realtime) {
+			os_sleepto_ns(ts);
+		} else {
+			while (i - video_output_get_total_frames(video) >= CACHE_SIZE - 1)
+				os_sleep_ms(1);
+		}
+
+		pthread_mutex_lock(&stats.mutex);
+		stats.submit_ns[i] = os_gettime_ns();
+		stats.num_submitted = i + 1;
+		pthread_mutex_unlock(&stats.mutex);
+
+		if (!video_output_lock_frame(video, &frame, 1, ts))
+			continue;
+
+		video_frame_copy(&frame, &patterns[i % NUM_PATTERNS], opts->format, opts->height);
+		video_output_unlock_frame(video);
+	}
+
+	while (video_output_get_total_frames(video) < opts->frames)
+		os_sleep_ms(1);
+
+	uint64_t wall_ns = os_gettime_ns() - start;
+	double cpu_percent = os_cpu_usage_info_query(cpu);
+	os_cpu_usage_info_destroy(cpu);
+
+	if (!wait_for_stop(output))
+		fprintf(stderr, "Timed out waiting for the encoder to stop\n");
+
+	uint32_t skipped = video_output_get_skipped_frames(video);
+	if (skipped)
+		fprintf(stderr, "Warning: %" PRIu32 " frames were skipped\n", skipped);
+
+	report(opts, encoder, opts->frames - skipped, wall_ns, cpu_percent);
+	success = true;
+
+fail:
+	obs_output_release(output);
+	obs_encoder_release(encoder);
+	video_output_close(video);
+
+	for (uint32_t i = 0; i < NUM_PATTERNS; i++)
+		video_frame_free(&patterns[i]);
+
+	return success;
+}
+
+static bool run_audio(const struct bench_options *opts, obs_encoder_t *encoder)
+{
+	struct audio_output_info aoi = {
+		.name = "encoder-bench",
+		.samples_per_sec = opts->sample_rate,
+		.format = AUDIO_FORMAT_FLOAT_PLANAR,
+		.speakers = opts->speakers,
+		.input_callback = audio_input,
+		.input_param = (void *)opts,
+	};
+	audio_t *audio = NULL;
+	obs_output_t *output = NULL;
+	bool success = false;
+
+	if (audio_output_open(&audio, &aoi) != AUDIO_OUTPUT_SUCCESS) {
+		fprintf(stderr, "Failed to open audio output\n");
+		return false;
+	}
+
+	obs_encoder_set_audio(encoder, audio);
+
+	output = obs_output_create(bench_audio_output_info.id, "encoder-bench", NULL, NULL);
+	obs_output_set_audio_encoder(output, encoder, 0);
+
+	if (!obs_output_start(output)) {
+		const char *err = obs_output_get_last_error(output);
+		fprintf(stderr, "Failed to start encoder%s%s\n", err ? ": " : "", err ? err : "");
+		goto fail;
+	}
+
+	/* audio-io is clock driven, so audio always runs in real time; the
+	 * interesting numbers are encode time per packet and CPU time */
+	os_cpu_usage_info_t *cpu = os_cpu_usage_info_start();
+	uint64_t start = os_gettime_ns();
+	uint32_t packets;
+
+	do {
+		os_sleep_ms(10);
+		pthread_mutex_lock(&stats.mutex);
+		packets = stats.packets;
+		pthread_mutex_unlock(&stats.mutex);
+	} while (packets < opts->frames);
+
+	uint64_t wall_ns = os_gettime_ns() - start;
+	double cpu_percent = os_cpu_usage_info_query(cpu);
+	os_cpu_usage_info_destroy(cpu);
+
+	if (!wait_for_stop(output))
+		fprintf(stderr, "Timed out waiting for the encoder to stop\n");
+
+	report(opts, encoder, packets, wall_ns, cpu_percent);
+	success = true;
+
+fail:
+	obs_output_release(output);
+	obs_encoder_release(encoder);
+	audio_output_close(audio);
+	return success;
+}
+
+/* ------------------------------------------------------------------------- */
+/* command line */
+
+static void print_usage(const char *exe)
+{
+	fprintf(stderr,
+		"Usage: %s [options] <encoder id>\n"
+		"       %s --list\n\n"
+		"Options:\n"
+		"  --format <nv12|i444|p010>  Video input format (default: nv12)\n"
+		"  --size <WxH>               Video resolution (default: 1920x1080)\n"
+		"  --fps <N[/D]>              Video frame rate (default: 60)\n"
+		"  --frames <count>           Video frames, or audio packets, to encode (default: 600)\n"
+		"  --sample-rate <hz>         Audio sample rate (default: 48000)\n"
+		"  --channels <count>         Audio channel count: 1, 2, 3, 4, 5, 6 or 8 (default: 2)\n"
+		"  --settings <json>          Encoder settings, e.g. '{\"preset\":\"veryfast\"}'\n"
+		"  --realtime                 Submit video frames at the frame rate instead of\n"
+		"                             as fast as the encoder accepts them\n"
+		"  --plugin-path <bin> <data> Additional module path to load encoders from\n"
+		"  --json                     Print results as JSON\n"
+		"  --verbose                  Show libobs log output\n",
+		exe, exe);
+}
+
+static bool parse_format(const char *str, enum video_format *format)
+{
+	if (astrcmpi(str, "nv12") == 0)
+		*format = VIDEO_FORMAT_NV12;
+	else if (astrcmpi(str, "i444") == 0)
+		*format = VIDEO_FORMAT_I444;
+	else if (astrcmpi(str, "p010") == 0)
+		*format = VIDEO_FORMAT_P010;
+	else
+		return false;
+	return true;
+}
+
+static bool parse_channels(const char *str, enum speaker_layout *speakers)
+{
+	switch (strtoul(str, NULL, 10)) {
+	case 1:
+		*speakers = SPEAKERS_MONO;
+		break;
+	case 2:
+		*speakers = SPEAKERS_STEREO;
+		break;
+	case 3:
+		*speakers = SPEAKERS_2POINT1;
+		break;
+	case 4:
+		*speakers = SPEAKERS_4POINT0;
+		break;
+	case 5:
+		*speakers = SPEAKERS_4POINT1;
+		break;
+	case 6:
+		*speakers = SPEAKERS_5POINT1;
+		break;
+	case 8:
+		*speakers = SPEAKERS_7POINT1;
+		break;
+	default:
+		return false;
+	}
+	return true;
+}
+
+static bool parse_args(int argc, char *argv[], struct bench_options *opts, bool *list)
+{
+	for (int i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+		const char *val = i + 1 < argc ? argv[i + 1] : NULL;
+
+		if (strcmp(arg, "--list") == 0) {
+			*list = true;
+		} else if (strcmp(arg, "--realtime") == 0) {
+			opts->realtime = true;
+		} else if (strcmp(arg, "--json") == 0) {
+			opts->json = true;
+		} else if (strcmp(arg, "--verbose") == 0) {
+			opts->verbose = true;
+		} else if (strcmp(arg, "--plugin-path") == 0 && i + 2 < argc) {
+			obs_add_module_path(argv[i + 1], argv[i + 2]);
+			i += 2;
+		} else if (arg[0] == '-' && arg[1] == '-' && !val) {
+			return false;
+		} else if (strcmp(arg, "--format") == 0) {
+			if (!parse_format(val, &opts->format))
+				return false;
+			i++;
+		} else if (strcmp(arg, "--size") == 0) {
+			if (sscanf(val, "%" SCNu32 "x%" SCNu32, &opts->width, &opts->height) != 2)
+				return false;
+			i++;
+		} else if (strcmp(arg, "--fps") == 0) {
+			opts->fps_den = 1;
+			if (sscanf(val, "%" SCNu32 "/%" SCNu32, &opts->fps_num, &opts->fps_den) < 1)
+				return false;
+			i++;
+		} else if (strcmp(arg, "--frames") == 0) {
+			opts->frames = (uint32_t)strtoul(val, NULL, 10);
+			i++;
+		} else if (strcmp(arg, "--sample-rate") == 0) {
+			opts->sample_rate = (uint32_t)strtoul(val, NULL, 10);
+			i++;
+		} else if (strcmp(arg, "--channels") == 0) {
+			if (!parse_channels(val, &opts->speakers))
+				return false;
+			i++;
+		} else if (strcmp(arg, "--settings") == 0) {
+			opts->settings_json = val;
+			i++;
+		} else if (arg[0] == '-') {
+			return false;
+		} else {
+			opts->encoder_id = arg;
+		}
+	}
+
+	if (*list)
+		return true;
+
+	/* Subsampled formats need even dimensions */
+	if (!opts->encoder_id || !opts->frames || !opts->fps_num || !opts->fps_den || !opts->width || !opts->height ||
+	    (opts->format != VIDEO_FORMAT_I444 && (opts->width & 1 || opts->height & 1)))
+		return false;
+
+	return opts->sample_rate != 0;
+}
+
+static void list_encoders(void)
+{
+	const char *id;
+
+	for (size_t i = 0; obs_enum_encoder_types(i, &id); i++) {
+		enum obs_encoder_type type = obs_get_encoder_type(id);
+		const char *name = obs_encoder_get_display_name(id);
+
+		printf("%-32s %s  %s\n", id, type == OBS_ENCODER_VIDEO ? "video" : "audio", name ? name : "");
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	struct bench_options opts = {
+		.format = VIDEO_FORMAT_NV12,
+		.width = 1920,
+		.height = 1080,
+		.fps_num = 60,
+		.fps_den = 1,
+		.frames = 600,
+		.sample_rate = 48000,
+		.speakers = SPEAKERS_STEREO,
+	};
+	obs_data_t *settings = NULL;
+	obs_encoder_t *encoder = NULL;
+	bool list = false;
+	int ret = 1;
+
+	base_set_log_handler(do_log, NULL);
+
+	if (!obs_startup("en-US", NULL, NULL)) {
+		fprintf(stderr, "Couldn't start libobs\n");
+		return 1;
+	}
+
+	if (!parse_args(argc, argv, &opts, &list)) {
+		print_usage(argv[0]);
+		goto out;
+	}
+
+	verbose_log = opts.verbose;
+
+	obs_register_output(&bench_video_output_info);
+	obs_register_output(&bench_audio_output_info);
+	obs_load_all_modules();
+	obs_post_load_modules();
+
+	if (list) {
+		list_encoders();
+		ret = 0;
+		goto out;
+	}
+
+	if (opts.settings_json) {
+		settings = obs_data_create_from_json(opts.settings_json);
+		if (!settings) {
+			fprintf(stderr, "Invalid settings JSON\n");
+			goto out;
+		}
+	}
+
+	if (!obs_encoder_get_display_name(opts.encoder_id)) {
+		fprintf(stderr, "Encoder '%s' not found (see --list)\n", opts.encoder_id);
+		goto out;
+	}
+
+	switch (obs_get_encoder_type(opts.encoder_id)) {
+	case OBS_ENCODER_VIDEO:
+		encoder = obs_video_encoder_create(opts.encoder_id, "encoder-bench", settings, NULL);
+		break;
+	case OBS_ENCODER_AUDIO:
+		encoder = obs_audio_encoder_create(opts.encoder_id, "encoder-bench", settings, 0, NULL);
+		break;
+	}
+
+	if (!encoder) {
+		fprintf(stderr, "Failed to create encoder '%s'\n", opts.encoder_id);
+		goto out;
+	}
+
+	pthread_mutex_init(&stats.mutex, NULL);
+	da_init(stats.latencies);
+
+	/* Takes ownership of the encoder, it has to be destroyed before the
+	 * video_t/audio_t it encodes from */
+	bool success = obs_encoder_get_type(encoder) == OBS_ENCODER_VIDEO ? run_video(&opts, encoder)
+									 : run_audio(&opts, encoder);
+	ret = success ? 0 : 1;
+
+	da_free(stats.latencies);
+	bfree(stats.submit_ns);
+	pthread_mutex_destroy(&stats.mutex);
+
+out:
+	obs_data_release(settings);
+	obs_shutdown();
+	return ret;
+}